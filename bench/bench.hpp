@@ -0,0 +1,38 @@
+#pragma once
+#include <chrono>
+
+#include "common.hpp"
+
+// Runs `setup` (untimed) and then `body` (timed) until `body` has taken at
+// least `min_seconds` in total, and returns the mean time of one `body` run in
+// nanoseconds. Slow bodies run exactly once.
+template<typename Setup, typename Body>
+f64 measure_ns(Setup&& setup, Body&& body, f64 min_seconds = 0.25) {
+    using clock = std::chrono::steady_clock;
+
+    clock::duration total {};
+    u64 runs = 0;
+
+    do {
+        setup();
+
+        auto start = clock::now();
+        body();
+        total += clock::now() - start;
+
+        ++runs;
+    } while (std::chrono::duration<f64>(total).count() < min_seconds);
+
+    return std::chrono::duration<f64, std::nano>(total).count() / f64(runs);
+}
+
+// Keeps the compiler from optimizing away a result nobody reads.
+template<typename T>
+void do_not_optimize(const T& value) {
+#ifdef _MSC_VER
+    static const void* volatile sink;
+    sink = &value;
+#else
+    asm volatile("" : : "r,m"(value) : "memory");
+#endif
+}
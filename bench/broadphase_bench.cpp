@@ -0,0 +1,89 @@
+#include <iostream>
+#include <random>
+#include <cmath>
+
+#include "common.hpp"
+#include "game.hpp"
+#include "bench.hpp"
+
+// Cost of one `destroy_asteroids` pass with the spatial grid against the
+// nested loop over every pair. Half of the entities are asteroids, half are
+// bullets, scattered over a field that grows with their count so the density
+// stays close to a busy game screen.
+
+namespace {
+    constexpr f32 SCREEN_WIDTH = 1166;
+    constexpr f32 SCREEN_HEIGHT = 568;
+    constexpr f32 ENTITIES_PER_SCREEN = 200;
+
+    struct Scene {
+        EntityPool asteroids;
+        EntityPool bullets;
+    };
+
+    Scene make_scene(u32 entities, u32 seed) {
+        const f32 screens = std::max(1.f, f32(entities) / ENTITIES_PER_SCREEN);
+        const f32 scale = std::sqrt(screens);
+
+        std::mt19937 gen(seed);
+        std::uniform_real_distribution<f32> unif_x(0.f, SCREEN_WIDTH * scale);
+        std::uniform_real_distribution<f32> unif_y(1.f, SCREEN_HEIGHT * scale);
+
+        Scene scene;
+
+        for (u32 i = 0; i < entities / 2; ++i) {
+            scene.asteroids.push(Vector(unif_x(gen), unif_y(gen)), 1.f);
+        }
+
+        for (u32 i = 0; i < entities - entities / 2; ++i) {
+            scene.bullets.push(Vector(unif_x(gen), unif_y(gen)), -3.f);
+        }
+
+        return scene;
+    }
+
+    f64 measure_destroy(Game& game, const Scene& scene, Game::BroadphaseKind kind) {
+        game.broadphase = kind;
+
+        return measure_ns(
+            [&] {
+                game.asteroids = scene.asteroids;
+                game.bullets = scene.bullets;
+                game.score = 0;
+            },
+            [&] {
+                game.destroy_asteroids();
+            });
+    }
+}
+
+int main() {
+    Game game;
+
+    if (!game.Init(SizeF { SCREEN_WIDTH, SCREEN_HEIGHT }, 1)) {
+        std::wcout << L"Cannot initialize the game\n";
+        return -1;
+    }
+
+    std::wcout << L"entities,nested_ns,grid_ns,speedup,hits\n";
+
+    for (u32 entities : { 1'000u, 10'000u, 100'000u }) {
+        const Scene scene = make_scene(entities, entities);
+
+        const f64 nested = measure_destroy(game, scene, Game::BROADPHASE_NESTED);
+        const u64 nested_checksum = game.checksum();
+        const i32 hits = game.score / 5;
+
+        const f64 grid = measure_destroy(game, scene, Game::BROADPHASE_GRID);
+
+        if (game.checksum() != nested_checksum) {
+            std::wcout << L"Grid and nested loop disagree at " << entities << L" entities\n";
+            return -1;
+        }
+
+        std::wcout << entities << L',' << nested << L',' << grid << L','
+                   << nested / grid << L',' << hits << L'\n';
+    }
+
+    return 0;
+}
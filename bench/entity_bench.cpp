@@ -0,0 +1,131 @@
+#include <iostream>
+#include <random>
+#include <deque>
+
+#include "common.hpp"
+#include "math.hpp"
+#include "entity_pool.hpp"
+#include "bench.hpp"
+
+// Movement and culling passes over the structure-of-arrays `EntityPool`
+// against the `std::deque` of structs the game used to keep. Movement is the
+// per-tick `y += shift * speed` (remembering the previous position); culling
+// counts the entities that are still on screen and not shrunk away, the test
+// `collect_garbage` and the painting code apply to every entity.
+
+namespace {
+    constexpr f32 SCREEN_HEIGHT = 568;
+    constexpr f32 HALF_HEIGHT = 43.85f;
+    constexpr f32 SHIFT = 1.f;
+
+    struct Asteroid {
+        Vector pos;
+        Vector prev_pos;
+        f32 speed;
+        bool destroyed;
+        f32 size;
+    };
+
+    bool visible(f32 y, f32 size) {
+        return (y <= SCREEN_HEIGHT + HALF_HEIGHT) & (size >= 0.1f);
+    }
+
+    void fill(u32 entities, std::deque<Asteroid>& deque, EntityPool& pool) {
+        std::mt19937 gen(entities);
+        std::uniform_real_distribution<f32> unif_x(0.f, 1166.f);
+        std::uniform_real_distribution<f32> unif_y(-300.f, 2 * SCREEN_HEIGHT);
+        std::uniform_real_distribution<f32> unif_speed(1.f, 1.5f);
+        std::bernoulli_distribution destroyed(0.1);
+
+        deque.clear();
+        pool.clear();
+
+        for (u32 i = 0; i < entities; ++i) {
+            const Vector pos(unif_x(gen), unif_y(gen));
+            const f32 speed = unif_speed(gen);
+            const bool is_destroyed = destroyed(gen);
+            const f32 size = is_destroyed ? 0.05f : 1.f;
+
+            deque.push_back(Asteroid {
+                .pos = pos,
+                .prev_pos = pos,
+                .speed = speed,
+                .destroyed = is_destroyed,
+                .size = size,
+            });
+
+            pool.push(pos, speed);
+            pool.size.back() = size;
+
+            if (is_destroyed)
+                pool.destroy(pool.count() - 1);
+        }
+    }
+}
+
+int main() {
+    std::wcout << L"entities,pass,deque_ns_per_entity,pool_ns_per_entity,speedup,visible\n";
+
+    std::deque<Asteroid> deque;
+    EntityPool pool;
+
+    for (u32 entities : { 10'000u, 100'000u, 1'000'000u }) {
+        fill(entities, deque, pool);
+
+        const f64 move_deque = measure_ns([] {}, [&] {
+            for (auto& a : deque) {
+                a.prev_pos = a.pos;
+                a.pos.y += SHIFT * a.speed;
+            }
+
+            do_not_optimize(deque.front());
+        });
+
+        const f64 move_pool = measure_ns([] {}, [&] {
+            pool.move(SHIFT);
+            do_not_optimize(pool.y[0]);
+        });
+
+        std::wcout << entities << L",move," << move_deque / entities << L','
+                   << move_pool / entities << L','
+                   << move_deque / move_pool << L",\n";
+
+        // Both moved a different number of times; start the culling from
+        // the same positions.
+        fill(entities, deque, pool);
+
+        u32 visible_deque = 0, visible_pool = 0;
+
+        const f64 cull_deque = measure_ns([] {}, [&] {
+            visible_deque = 0;
+
+            for (const auto& a : deque)
+                visible_deque += visible(a.pos.y, a.size);
+
+            do_not_optimize(visible_deque);
+        });
+
+        const f64 cull_pool = measure_ns([] {}, [&] {
+            const f32* y = pool.y.data();
+            const f32* size = pool.size.data();
+
+            visible_pool = 0;
+
+            for (size_t i = 0; i < pool.count(); ++i)
+                visible_pool += visible(y[i], size[i]);
+
+            do_not_optimize(visible_pool);
+        });
+
+        if (visible_deque != visible_pool) {
+            std::wcout << L"Deque and pool disagree at " << entities << L" entities\n";
+            return -1;
+        }
+
+        std::wcout << entities << L",cull," << cull_deque / entities << L','
+                   << cull_pool / entities << L','
+                   << cull_deque / cull_pool << L',' << visible_pool << L'\n';
+    }
+
+    return 0;
+}
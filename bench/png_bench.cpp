@@ -0,0 +1,305 @@
+#include <iostream>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+
+#include "common.hpp"
+#include "png.hpp"
+#include "png_kernel.hpp"
+#include "job_system.hpp"
+#include "bench.hpp"
+
+// Cost of decoding PNGs into premultiplied BGRA sprites, from memory:
+//
+//  - filters: a synthetic 1024x1024 RGBA image stored (not compressed) with
+//    every row filtered the same way, one case per PNG filter, so that the
+//    unfiltering and premultiplying dominate;
+//  - assets: the sprites under assets/, once and 16 times over, as a game
+//    with more sprites would load them.
+//
+// `naive` is the decoder as it was: the scalar kernel, then a second pass
+// premultiplying the RGBA image. Then every kernel the CPU supports decodes
+// straight into the sprite, and the assets with the best one on several
+// threads, one image per task. All must produce the very same pixels.
+//
+// Usage: png_bench [--root DIR] [--min-time SECONDS]
+//
+// `--root` is the directory holding assets/. Prints CSV.
+
+namespace {
+    constexpr u32 SYNTHETIC_SIZE = 1024;
+    constexpr u32 ASSET_COPIES[] = { 1, 16 };
+    constexpr u32 THREAD_COUNTS[] = { 2, 4, 8 };
+
+    constexpr const char* ASSETS[] = {
+        "assets/rocket.png",
+        "assets/asteroid_small.png",
+        "assets/bullet.png",
+    };
+
+    constexpr const char* FILTER_NAMES[] = { "none", "sub", "up", "average", "paeth" };
+
+    struct Options {
+        std::filesystem::path root = ".";
+        f64 min_time = 0.25;
+    };
+
+    using Png = std::vector<u8>;
+
+    u32 div255(u32 x) {
+        x += 128;
+        return (x + (x >> 8)) >> 8;
+    }
+
+    bool decode_naive(const Png& png, Sprite& sprite) {
+        Image image;
+
+        if (!decode_png(png.data(), png.size(), image))
+            return false;
+
+        sprite.width = image.width;
+        sprite.height = image.height;
+        sprite.pixels.resize(size_t(image.width) * image.height);
+
+        for (size_t i = 0; i < sprite.pixels.size(); ++i) {
+            const u8* p = image.pixels.data() + i * 4;
+            const u32 a = p[3];
+
+            sprite.pixels[i] = div255(p[2] * a) | div255(p[1] * a) << 8 |
+                               div255(p[0] * a) << 16 | a << 24;
+        }
+
+        return true;
+    }
+
+    // Smooth gradients with some noise and a ragged alpha edge, roughly what
+    // a sprite looks like to the filters.
+    Image synthetic_image() {
+        Image image;
+        image.width = SYNTHETIC_SIZE;
+        image.height = SYNTHETIC_SIZE;
+        image.pixels.resize(size_t(SYNTHETIC_SIZE) * SYNTHETIC_SIZE * 4);
+
+        std::mt19937 gen(SYNTHETIC_SIZE);
+        std::uniform_int_distribution<u32> noise(0, 15);
+
+        for (u32 y = 0; y < SYNTHETIC_SIZE; ++y) {
+            for (u32 x = 0; x < SYNTHETIC_SIZE; ++x) {
+                u8* p = image.pixels.data() + (size_t(y) * SYNTHETIC_SIZE + x) * 4;
+                const u32 edge = (x * 7 + y * 3) % 512;
+
+                p[0] = u8(x / 4 + noise(gen));
+                p[1] = u8(y / 4 + noise(gen));
+                p[2] = u8((x + y) / 8 + noise(gen));
+                p[3] = u8(edge < 256 ? 255 : std::min(255u, (511 - edge) * 2 + noise(gen)));
+            }
+        }
+
+        return image;
+    }
+
+    bool read_file(const std::filesystem::path& path, Png& png) {
+        std::ifstream file(path, std::ios::binary);
+
+        if (!file) {
+            std::wcout << L"Cannot read " << path.wstring() << L'\n';
+            return false;
+        }
+
+        png.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        return true;
+    }
+
+    size_t pixel_count(const std::vector<Sprite>& sprites) {
+        size_t pixels = 0;
+
+        for (const Sprite& sprite : sprites)
+            pixels += size_t(sprite.width) * sprite.height;
+
+        return pixels;
+    }
+
+    // Decodes `pngs` with the naive decoder, then with every kernel and, if
+    // `threaded`, with the best one on several threads; prints the time of
+    // decoding all of them.
+    bool bench_pngs(const char* sweep, const std::string& name, const std::vector<Png>& pngs,
+                    bool threaded, f64 min_time) {
+        std::vector<Sprite> reference(pngs.size());
+        std::vector<Sprite> sprites(pngs.size());
+
+        select_png_kernel("scalar");
+
+        for (size_t i = 0; i < pngs.size(); ++i) {
+            if (!decode_naive(pngs[i], reference[i])) {
+                std::wcout << L"Cannot decode " << sweep << L' ' << name.c_str() << L'\n';
+                return false;
+            }
+        }
+
+        const size_t pixels = pixel_count(reference);
+
+        auto print = [&](const char* kernel, u32 threads, f64 ns) {
+            std::wcout << sweep << L',' << name.c_str() << L',' << kernel << L',' << threads
+                       << L',' << pixels << L',' << ns / 1e6 << L'\n';
+        };
+
+        print("naive", 1, measure_ns([] {}, [&] {
+            for (size_t i = 0; i < pngs.size(); ++i)
+                decode_naive(pngs[i], sprites[i]);
+        }, min_time));
+
+        auto run = [&](const char* kernel, u32 threads, JobSystem* jobs) {
+            auto decode = [&] {
+                if (!jobs) {
+                    for (size_t i = 0; i < pngs.size(); ++i)
+                        decode_png(pngs[i].data(), pngs[i].size(), sprites[i]);
+
+                    return;
+                }
+
+                TaskGraph graph;
+                graph.add_chunks(u32(pngs.size()), [&](u32 i) {
+                    decode_png(pngs[i].data(), pngs[i].size(), sprites[i]);
+                });
+                jobs->run(graph);
+            };
+
+            for (Sprite& sprite : sprites)
+                sprite = {};
+
+            decode();
+
+            for (size_t i = 0; i < pngs.size(); ++i) {
+                if (sprites[i].pixels != reference[i].pixels) {
+                    std::wcout << L"The " << kernel << L" PNG kernel on " << threads
+                               << L" threads disagrees with the naive decoder\n";
+                    return false;
+                }
+            }
+
+            print(kernel, threads, measure_ns([] {}, decode, min_time));
+            return true;
+        };
+
+        const char* best = "scalar";
+
+        for (const char* kernel : { "scalar", "sse2", "avx2" }) {
+            if (!select_png_kernel(kernel))
+                continue;
+
+            if (!run(kernel, 1, nullptr))
+                return false;
+
+            best = kernel;
+        }
+
+        select_png_kernel(best);
+
+        if (!threaded)
+            return true;
+
+        for (u32 threads : THREAD_COUNTS) {
+            JobSystem jobs;
+
+            if (!jobs.Init(threads)) {
+                std::wcout << L"Cannot start the worker threads\n";
+                return false;
+            }
+
+            if (!run(best, threads, &jobs))
+                return false;
+        }
+
+        return true;
+    }
+
+    bool bench_filters(f64 min_time) {
+        const Image image = synthetic_image();
+
+        for (u8 filter = FILTER_NONE; filter <= FILTER_PAETH; ++filter) {
+            std::vector<Png> pngs(1);
+
+            if (!encode_png(image, pngs[0], filter)) {
+                std::wcout << L"Cannot encode the synthetic image\n";
+                return false;
+            }
+
+            if (!bench_pngs("filters", FILTER_NAMES[filter], pngs, false, min_time))
+                return false;
+        }
+
+        return true;
+    }
+
+    bool bench_assets(const Options& options) {
+        std::vector<Png> assets;
+
+        for (const char* asset : ASSETS) {
+            if (!read_file(options.root / asset, assets.emplace_back()))
+                return false;
+        }
+
+        for (u32 copies : ASSET_COPIES) {
+            std::vector<Png> pngs;
+
+            for (u32 i = 0; i < copies; ++i)
+                pngs.insert(pngs.end(), assets.begin(), assets.end());
+
+            if (!bench_pngs("assets", std::to_string(pngs.size()), pngs, true, options.min_time))
+                return false;
+        }
+
+        return true;
+    }
+
+    void usage() {
+        std::wcout << L"Usage: png_bench [--root DIR] [--min-time SECONDS]\n";
+    }
+
+    bool parse_options(int argc, char** argv, Options& options) {
+        for (int i = 1; i < argc; ++i) {
+            if (i + 1 >= argc) {
+                usage();
+                return false;
+            }
+
+            const char* name = argv[i];
+            const char* value = argv[++i];
+
+            if (!strcmp(name, "--root"))
+                options.root = value;
+            else if (!strcmp(name, "--min-time"))
+                options.min_time = std::strtod(value, nullptr);
+            else {
+                usage();
+                return false;
+            }
+        }
+
+        if (options.min_time <= 0) {
+            usage();
+            return false;
+        }
+
+        return true;
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+
+    if (!parse_options(argc, argv, options))
+        return -1;
+
+    std::wcout << L"sweep,case,kernel,threads,pixels,ms\n";
+
+    if (!bench_filters(options.min_time) || !bench_assets(options))
+        return -1;
+
+    return 0;
+}
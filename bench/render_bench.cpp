@@ -0,0 +1,310 @@
+#include <iostream>
+#include <random>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+
+#include "common.hpp"
+#include "game.hpp"
+#include "autopilot.hpp"
+#include "renderer.hpp"
+#include "soft_renderer.hpp"
+#include "blend_kernel.hpp"
+#include "job_system.hpp"
+#include "bench.hpp"
+
+// Cost of one frame painted by the software renderer, with every blend
+// kernel the CPU supports and then with the best one on several threads:
+//
+//  - difficulty: states of real games at every level, at the size of the
+//    windowed game, played by the headless autopilot;
+//  - sprites: synthetic screens of growing size with growing numbers of
+//    asteroids and bullets.
+//
+// Every kernel and thread count must paint the very same bytes as the scalar
+// kernel on one thread.
+//
+// Then the cost of submitting the draws of a frame alone (the scene painted
+// into the renderer, nothing composited) with tens of thousands of sprites,
+// one batch per sprite against one call per instance; the `kernel` column
+// tells which. Both must paint the same frame.
+//
+// Usage: render_bench [--root DIR] [--min-time SECONDS]
+//
+// `--root` is the directory holding assets/. Prints CSV.
+
+namespace {
+    constexpr SizeF GAME_SIZE { 1166, 568 };
+
+    constexpr SizeF SCREEN_SIZES[] = {
+        GAME_SIZE,
+        { 1920, 1080 },
+        { 3840, 2160 },
+    };
+
+    constexpr u32 THREAD_COUNTS[] = { 2, 4, 8 };
+
+    constexpr u32 WARMUP_TICKS = 4'000;
+    constexpr u32 SAMPLE_EVERY = 40;
+    constexpr u32 SAMPLED_STATES = 32;
+
+    constexpr u32 SUBMITTED_SPRITES[] = { 10'000, 50'000, 100'000 };
+
+    struct Options {
+        std::filesystem::path root = ".";
+        f64 min_time = 0.25;
+    };
+
+    void paint(SoftRenderer& renderer, const Game& game) {
+        ScenePainter painter;
+
+        renderer.begin_frame();
+        painter.paint(renderer, game, 0.5f);
+        renderer.end_frame();
+    }
+
+    // Paints every state once per run; prints the mean time of a frame.
+    bool bench_states(const char* sweep, const std::string& name, const std::vector<Game>& states,
+                      SoftRenderer& renderer, f64 min_time) {
+        std::vector<std::vector<u32>> reference;
+        f64 draws = 0;
+
+        select_blend_kernel("scalar");
+        renderer.jobs = nullptr;
+
+        for (const Game& game : states) {
+            paint(renderer, game);
+            reference.push_back(renderer.get_framebuffer().pixels);
+            draws += f64(renderer.get_commands().size());
+        }
+
+        draws /= f64(states.size());
+
+        const SizeF size = renderer.frame_size();
+
+        auto run = [&](const char* kernel, u32 threads) {
+            for (size_t i = 0; i < states.size(); ++i) {
+                paint(renderer, states[i]);
+
+                if (renderer.get_framebuffer().pixels != reference[i]) {
+                    std::wcout << L"The " << kernel << L" blend kernel on " << threads
+                               << L" threads disagrees with the scalar one\n";
+                    return false;
+                }
+            }
+
+            const f64 ns = measure_ns([] {}, [&] {
+                for (const Game& game : states)
+                    paint(renderer, game);
+            }, min_time) / f64(states.size());
+
+            std::wcout << sweep << L',' << name.c_str() << L',' << size.width << L'x'
+                       << size.height << L',' << kernel << L',' << threads << L',' << draws
+                       << L',' << ns / 1e6 << L'\n';
+
+            return true;
+        };
+
+        const char* best = "scalar";
+
+        for (const char* kernel : { "scalar", "sse2", "avx2" }) {
+            if (!select_blend_kernel(kernel))
+                continue;
+
+            if (!run(kernel, 1))
+                return false;
+
+            best = kernel;
+        }
+
+        select_blend_kernel(best);
+
+        for (u32 threads : THREAD_COUNTS) {
+            JobSystem jobs;
+
+            if (!jobs.Init(threads)) {
+                std::wcout << L"Cannot start the worker threads\n";
+                return false;
+            }
+
+            renderer.jobs = &jobs;
+            const bool ok = run(best, threads);
+            renderer.jobs = nullptr;
+
+            if (!ok)
+                return false;
+        }
+
+        return true;
+    }
+
+    bool bench_difficulty(u32 difficulty, SoftRenderer& renderer, f64 min_time) {
+        Game game;
+        Autopilot autopilot(difficulty);
+
+        if (!game.Init(GAME_SIZE, difficulty) || !game.start_level(i32(difficulty))) {
+            std::wcout << L"Cannot initialize the game\n";
+            return false;
+        }
+
+        std::vector<Game> states;
+
+        for (u32 tick = 1; states.size() < SAMPLED_STATES; ++tick) {
+            if (!game.update_scene(autopilot.next(game, i32(difficulty))))
+                return false;
+
+            if (tick >= WARMUP_TICKS && tick % SAMPLE_EVERY == 0)
+                states.push_back(game);
+        }
+
+        return bench_states("difficulty", std::to_string(difficulty), states, renderer, min_time);
+    }
+
+    // Half asteroids, half bullets, strewn over the screen.
+    bool synthetic_game(const SizeF& size, u32 sprites, Game& game) {
+        if (!game.Init(size, sprites)) {
+            std::wcout << L"Cannot initialize the game\n";
+            return false;
+        }
+
+        std::mt19937 gen(sprites);
+        std::uniform_real_distribution<f32> unif_x(0.f, size.width);
+        std::uniform_real_distribution<f32> unif_y(0.f, size.height);
+
+        for (u32 i = 0; i < sprites / 2; ++i)
+            game.asteroids.push(Vector(unif_x(gen), unif_y(gen)), 1.f);
+
+        for (u32 i = 0; i < sprites - sprites / 2; ++i)
+            game.bullets.push(Vector(unif_x(gen), unif_y(gen)), -3.f);
+
+        game.penalty = 0.5f;
+        return true;
+    }
+
+    bool bench_sprites(const SizeF& size, u32 sprites, const Options& options) {
+        SoftRenderer renderer;
+
+        if (!renderer.Init(options.root, u32(size.width), u32(size.height))) {
+            std::wcout << L"Cannot initialize the software renderer\n";
+            return false;
+        }
+
+        std::vector<Game> states(1);
+
+        if (!synthetic_game(size, sprites, states[0]))
+            return false;
+
+        return bench_states("sprites", std::to_string(sprites), states, renderer,
+                            options.min_time);
+    }
+
+    bool bench_submission(u32 sprites, SoftRenderer& renderer, f64 min_time) {
+        Game game;
+
+        if (!synthetic_game(GAME_SIZE, sprites, game))
+            return false;
+
+        const SizeF size = renderer.frame_size();
+        std::vector<u32> reference;
+
+        for (auto submission : { ScenePainter::SUBMISSION_BATCHED,
+                                 ScenePainter::SUBMISSION_PER_SPRITE }) {
+            const char* name = submission == ScenePainter::SUBMISSION_BATCHED ? "batched"
+                                                                               : "per_sprite";
+            ScenePainter painter;
+            painter.submission = submission;
+
+            renderer.begin_frame();
+            painter.paint(renderer, game, 0.5f);
+            renderer.end_frame();
+
+            if (reference.empty()) {
+                reference = renderer.get_framebuffer().pixels;
+            } else if (renderer.get_framebuffer().pixels != reference) {
+                std::wcout << L"Submitting " << name << L" paints another frame\n";
+                return false;
+            }
+
+            const f64 draws = f64(renderer.get_commands().size());
+
+            const f64 ns = measure_ns([] {}, [&] {
+                renderer.begin_frame();
+                painter.paint(renderer, game, 0.5f);
+            }, min_time);
+
+            std::wcout << L"submission," << sprites << L',' << size.width << L'x'
+                       << size.height << L',' << name << L",1," << draws << L','
+                       << ns / 1e6 << L'\n';
+        }
+
+        return true;
+    }
+
+    void usage() {
+        std::wcout << L"Usage: render_bench [--root DIR] [--min-time SECONDS]\n";
+    }
+
+    bool parse_options(int argc, char** argv, Options& options) {
+        for (int i = 1; i < argc; ++i) {
+            if (i + 1 >= argc) {
+                usage();
+                return false;
+            }
+
+            const char* name = argv[i];
+            const char* value = argv[++i];
+
+            if (!strcmp(name, "--root"))
+                options.root = value;
+            else if (!strcmp(name, "--min-time"))
+                options.min_time = std::strtod(value, nullptr);
+            else {
+                usage();
+                return false;
+            }
+        }
+
+        if (options.min_time <= 0) {
+            usage();
+            return false;
+        }
+
+        return true;
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+
+    if (!parse_options(argc, argv, options))
+        return -1;
+
+    SoftRenderer renderer;
+
+    if (!renderer.Init(options.root, u32(GAME_SIZE.width), u32(GAME_SIZE.height))) {
+        std::wcout << L"Cannot initialize the software renderer\n";
+        return -1;
+    }
+
+    std::wcout << L"sweep,case,screen,kernel,threads,draws,ms\n";
+
+    for (u32 difficulty = 1; difficulty <= 6; ++difficulty) {
+        if (!bench_difficulty(difficulty, renderer, options.min_time))
+            return -1;
+    }
+
+    for (const SizeF& size : SCREEN_SIZES) {
+        for (u32 sprites : { 1'000u, 10'000u }) {
+            if (!bench_sprites(size, sprites, options))
+                return -1;
+        }
+    }
+
+    for (u32 sprites : SUBMITTED_SPRITES) {
+        if (!bench_submission(sprites, renderer, options.min_time))
+            return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,571 @@
+#include <iostream>
+#include <fstream>
+#include <random>
+#include <vector>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+
+#include "common.hpp"
+#include "game.hpp"
+#include "autopilot.hpp"
+#include "segment_kernel.hpp"
+#include "job_system.hpp"
+#include "perf_counters.hpp"
+#include "bench.hpp"
+
+// The simulation hot paths in one run, with machine-readable output to track
+// regressions from run to run:
+//
+//  - pairs: every narrowphase test per pair of sprites, on offsets where the
+//    outer rectangles overlap;
+//  - entities: `destroy_asteroids`, `is_there_collision`, `collect_garbage`
+//    and a whole `update_scene` tick on synthetic scenes of growing size, at
+//    the density of a busy screen, the tick also on several threads;
+//  - difficulty: the same phases on states of real games at every level,
+//    played by the headless autopilot.
+//
+// With JSON output, where the hardware counters can be read (Linux), the
+// serial ticks of both sweeps are run once more with them on, and the JSON
+// gets the cycles, instructions, cache and branch misses of every phase of
+// the tick, per tick.
+//
+// Usage: simulation_bench [--json FILE] [--csv FILE] [--min-time SECONDS]
+//
+// Without any file, the CSV goes to the standard output.
+
+namespace {
+    constexpr f32 SCREEN_WIDTH = 1166;
+    constexpr f32 SCREEN_HEIGHT = 568;
+    constexpr f32 ENTITIES_PER_SCREEN = 200;
+
+    constexpr u32 PAIR_SAMPLES = 1 << 14;
+
+    // Closing distance of a bullet and an asteroid over a 50 ms tick.
+    const Vector SWEPT_MOTION(0.f, -42.5f);
+
+    // Ticks played before the first sampled state, and between two of them.
+    constexpr u32 WARMUP_TICKS = 4'000;
+    constexpr u32 SAMPLE_EVERY = 8;
+    constexpr u32 SAMPLED_STATES = 256;
+
+    constexpr u32 TICKS_PER_RUN = 1'000;
+
+    struct Options {
+        std::filesystem::path json_path;
+        std::filesystem::path csv_path;
+        f64 min_time = 0.25;
+    };
+
+    // Whole ticks of the entities sweep run on each of these numbers of
+    // threads (the game goes parallel from PARALLEL_MIN_ENTITIES on).
+    constexpr u32 THREAD_COUNTS[] = { 1, 2, 4, 8 };
+
+    // One measurement. `asteroids` and `bullets` are the (mean) number of
+    // live entities the phase ran on; zero for the sprite pairs.
+    struct Result {
+        const char* sweep;
+        const char* benchmark;
+        std::string variant;
+        u32 difficulty;
+        f64 asteroids;
+        f64 bullets;
+        f64 ns;
+        u32 threads = 1;
+    };
+
+    // The hardware counters of one phase of the serial tick, per tick.
+    struct CounterResult {
+        const char* sweep;
+        u32 difficulty;
+        f64 asteroids;
+        f64 bullets;
+        FramePhase phase;
+        std::array<f64, PERF_EVENT_COUNT> per_tick;
+    };
+
+    const char* narrowphase_name(Game::NarrowphaseKind kind) {
+        switch (kind) {
+            case Game::NARROWPHASE_SWEPT: return "swept";
+            case Game::NARROWPHASE_SAT: return "sat";
+            case Game::NARROWPHASE_EDGES: return "edges";
+            case Game::NARROWPHASE_MASK: return "mask";
+        }
+
+        return "";
+    }
+
+    //
+    // pairs
+    //
+
+    template<typename Lhs, typename Rhs>
+    void bench_pair(const char* name, const Lhs& lhs, const Rhs& rhs, f64 min_time,
+                    std::vector<Result>& results) {
+        const Vector reach = lhs.contour.half_of_sides + rhs.contour.half_of_sides;
+
+        std::mt19937 gen(1);
+        std::uniform_real_distribution<f32> unif_x(-reach.x, reach.x);
+        std::uniform_real_distribution<f32> unif_y(-reach.y, reach.y);
+
+        std::vector<Vector> offsets(PAIR_SAMPLES);
+
+        for (auto& offset : offsets)
+            offset = Vector(unif_x(gen), unif_y(gen));
+
+        auto run = [&](const char* method, auto&& test) {
+            const Vector origin;
+
+            const f64 ns = measure_ns([] {}, [&] {
+                u32 hits = 0;
+
+                for (const auto& offset : offsets)
+                    hits += test(origin, offset);
+
+                do_not_optimize(hits);
+            }, min_time);
+
+            results.push_back({ "pairs", "intersect", std::string(name) + ":" + method,
+                                0, 0, 0, ns / f64(offsets.size()) });
+        };
+
+        run("sat", [&](const Vector& a, const Vector& b) {
+            return intersect(lhs.contour, rhs.contour, a, b);
+        });
+
+        run("swept", [&](const Vector& a, const Vector& b) {
+            f32 toi;
+            return sweep(lhs.contour, rhs.contour, a, b, SWEPT_MOTION, toi);
+        });
+
+        run("edges", [&](const Vector& a, const Vector& b) {
+            return intersect_edges_batched(lhs.contour, rhs.contour, a, b);
+        });
+
+        run("mask", [&](const Vector& a, const Vector& b) {
+            return intersect(lhs.mask, rhs.mask, a, b);
+        });
+    }
+
+    //
+    // entities and difficulty
+    //
+
+    // What the timed phases read of a sampled state. They run on games set
+    // up like the one the states come from, holding nothing else of it.
+    struct Snapshot {
+        EntityPool asteroids;
+        EntityPool bullets;
+        Vector controller_pos;
+        Vector prev_controller_pos;
+    };
+
+    Snapshot snapshot_of(const Game& game) {
+        return { game.asteroids, game.bullets, game.controller_pos, game.prev_controller_pos };
+    }
+
+    // Times `phase` on `games`, put in the sampled states before every run,
+    // and returns the mean time of one call.
+    template<typename Phase>
+    f64 measure_phase(std::vector<Game>& games, const std::vector<Snapshot>& states,
+                      Phase&& phase, f64 min_time) {
+        const f64 ns = measure_ns(
+            [&] {
+                for (size_t i = 0; i < games.size(); ++i) {
+                    games[i].asteroids = states[i].asteroids;
+                    games[i].bullets = states[i].bullets;
+                    games[i].controller_pos = states[i].controller_pos;
+                    games[i].prev_controller_pos = states[i].prev_controller_pos;
+                }
+            },
+            [&] {
+                for (auto& game : games)
+                    phase(game);
+            },
+            min_time);
+
+        return ns / f64(states.size());
+    }
+
+    // The phases in each of `states`, on games set up like `source`.
+    bool bench_phases(const char* sweep, const Game& source, const std::vector<Snapshot>& states,
+                      f64 min_time, std::vector<Result>& results) {
+        std::vector<Game> games(states.size());
+
+        for (auto& game : games) {
+            if (!game.Init(source.size, 0, source.tick_rate)) {
+                std::wcout << L"Cannot initialize the game\n";
+                return false;
+            }
+
+            game.broadphase = source.broadphase;
+            game.narrowphase = source.narrowphase;
+        }
+
+        f64 asteroids = 0, bullets = 0;
+
+        for (const auto& state : states) {
+            asteroids += f64(state.asteroids.count());
+            bullets += f64(state.bullets.count());
+        }
+
+        asteroids /= f64(states.size());
+        bullets /= f64(states.size());
+
+        auto report = [&](const char* benchmark, f64 ns) {
+            results.push_back({ sweep, benchmark, narrowphase_name(source.narrowphase),
+                                source.difficulty, asteroids, bullets, ns });
+        };
+
+        report("destroy_asteroids", measure_phase(games, states, [](Game& game) {
+            game.destroy_asteroids();
+        }, min_time));
+
+        report("is_there_collision", measure_phase(games, states, [](Game& game) {
+            do_not_optimize(game.is_there_collision());
+        }, min_time));
+
+        report("collect_garbage", measure_phase(games, states, [](Game& game) {
+            game.collect_garbage();
+        }, min_time));
+
+        return true;
+    }
+
+    // Runs `setup` and `run` (`ticks` serial ticks of `game`) for `min_time`
+    // again, counting, and reports the counts of every phase of the tick.
+    template<typename Setup, typename Run>
+    void count_phases(const char* sweep, Game& game, f64 asteroids, f64 bullets, u32 ticks,
+                      Setup&& setup, Run&& run, f64 min_time, PerfCounters& counters,
+                      std::vector<CounterResult>& results) {
+        u64 counted = 0;
+
+        counters.clear();
+        game.counters = &counters;
+
+        measure_ns(setup, [&] {
+            run();
+            counted += ticks;
+        }, min_time);
+
+        game.counters = nullptr;
+
+        for (u32 phase = PHASE_MOTION; phase <= PHASE_GC; ++phase) {
+            CounterResult result { sweep, game.difficulty, asteroids, bullets,
+                                   FramePhase(phase), {} };
+
+            for (u32 event = 0; event < PERF_EVENT_COUNT; ++event)
+                result.per_tick[event] = f64(counters.phases[phase][event]) / f64(counted);
+
+            results.push_back(result);
+        }
+    }
+
+    // A field that grows with the entity count, so the density stays close
+    // to a busy game screen, with the rocket at the bottom in the middle.
+    bool scene_game(u32 entities, Game& game) {
+        const f32 scale = std::sqrt(std::max(1.f, f32(entities) / ENTITIES_PER_SCREEN));
+        const SizeF size { SCREEN_WIDTH * scale, SCREEN_HEIGHT * scale };
+
+        if (!game.Init(size, entities))
+            return false;
+
+        std::mt19937 gen(entities);
+        std::uniform_real_distribution<f32> unif_x(0.f, size.width);
+        std::uniform_real_distribution<f32> unif_y(1.f, size.height);
+        std::uniform_real_distribution<f32> unif_speed(1.f, 1.5f);
+
+        for (u32 i = 0; i < entities / 2; ++i)
+            game.asteroids.push(Vector(unif_x(gen), unif_y(gen)), unif_speed(gen));
+
+        for (u32 i = 0; i < entities - entities / 2; ++i)
+            game.bullets.push(Vector(unif_x(gen), unif_y(gen)), -3.f);
+
+        return true;
+    }
+
+    bool bench_entities(u32 entities, f64 min_time, std::vector<Result>& results,
+                        PerfCounters* counters, std::vector<CounterResult>& counted) {
+        Game scene;
+
+        if (!scene_game(entities, scene)) {
+            std::wcout << L"Cannot initialize the game\n";
+            return false;
+        }
+
+        if (!bench_phases("entities", scene, { snapshot_of(scene) }, min_time, results))
+            return false;
+
+        // A whole tick, from the same scene every time, on every number of
+        // threads. The first tick from the scene must come out the same.
+        u64 serial_checksum = 0;
+
+        for (u32 threads : THREAD_COUNTS) {
+            JobSystem jobs;
+            Game game;
+
+            if (!game.Init(scene.size, entities) || !jobs.Init(threads)) {
+                std::wcout << L"Cannot initialize the game\n";
+                return false;
+            }
+
+            game.jobs = threads > 1 ? &jobs : nullptr;
+
+            auto restore = [&] {
+                game.State = Game::GAME_PLAY;
+                game.asteroids = scene.asteroids;
+                game.bullets = scene.bullets;
+                game.reset_controller_pos();
+            };
+
+            restore();
+            game.update_scene(Input {});
+
+            if (threads == 1)
+                serial_checksum = game.checksum();
+            else if (game.checksum() != serial_checksum) {
+                std::wcout << L"The tick on " << threads
+                           << L" threads differs from the serial one\n";
+                return false;
+            }
+
+            const f64 ns = measure_ns(restore, [&] {
+                do_not_optimize(game.update_scene(Input {}));
+            }, min_time);
+
+            results.push_back({ "entities", "update_scene", narrowphase_name(game.narrowphase),
+                                game.difficulty, f64(scene.asteroids.count()),
+                                f64(scene.bullets.count()), ns, threads });
+
+            if (threads == 1 && counters) {
+                count_phases("entities", game, f64(scene.asteroids.count()),
+                             f64(scene.bullets.count()), 1, restore, [&] {
+                    do_not_optimize(game.update_scene(Input {}));
+                }, min_time, *counters, counted);
+            }
+        }
+
+        return true;
+    }
+
+    bool bench_difficulty(u32 difficulty, f64 min_time, std::vector<Result>& results,
+                          PerfCounters* counters, std::vector<CounterResult>& counted) {
+        Game game;
+        Autopilot autopilot(difficulty);
+
+        if (!game.Init(SizeF { SCREEN_WIDTH, SCREEN_HEIGHT }, difficulty) ||
+            !game.start_level(i32(difficulty))) {
+            std::wcout << L"Cannot initialize the game\n";
+            return false;
+        }
+
+        auto tick = [&] {
+            return game.update_scene(autopilot.next(game, i32(difficulty)));
+        };
+
+        for (u32 i = 0; i < WARMUP_TICKS; ++i) {
+            if (!tick())
+                return false;
+        }
+
+        std::vector<Snapshot> states;
+
+        while (states.size() < SAMPLED_STATES) {
+            for (u32 i = 0; i < SAMPLE_EVERY; ++i) {
+                if (!tick())
+                    return false;
+            }
+
+            states.push_back(snapshot_of(game));
+        }
+
+        if (!bench_phases("difficulty", game, states, min_time, results))
+            return false;
+
+        // Whole ticks, with the game going on from run to run.
+        u64 asteroids = 0, bullets = 0, ticks = 0;
+        bool ok = true;
+
+        const f64 ns = measure_ns([] {}, [&] {
+            for (u32 i = 0; i < TICKS_PER_RUN; ++i) {
+                ok &= tick();
+                asteroids += game.asteroids.count();
+                bullets += game.bullets.count();
+            }
+
+            ticks += TICKS_PER_RUN;
+        }, min_time);
+
+        results.push_back({ "difficulty", "update_scene", narrowphase_name(game.narrowphase),
+                            difficulty, f64(asteroids) / f64(ticks), f64(bullets) / f64(ticks),
+                            ns / TICKS_PER_RUN });
+
+        if (counters) {
+            count_phases("difficulty", game, f64(asteroids) / f64(ticks),
+                         f64(bullets) / f64(ticks), TICKS_PER_RUN, [] {}, [&] {
+                for (u32 i = 0; i < TICKS_PER_RUN; ++i)
+                    ok &= tick();
+            }, min_time, *counters, counted);
+        }
+
+        return ok;
+    }
+
+    //
+    // Output
+    //
+
+    template<typename Stream>
+    void write_csv(Stream& out, const std::vector<Result>& results) {
+        out << "sweep,benchmark,variant,difficulty,asteroids,bullets,threads,ns\n";
+
+        for (const auto& r : results) {
+            out << r.sweep << ',' << r.benchmark << ',' << r.variant.c_str() << ','
+                << r.difficulty << ',' << r.asteroids << ',' << r.bullets << ',' << r.threads
+                << ',' << r.ns << '\n';
+        }
+    }
+
+    void write_json(std::ostream& out, const std::vector<Result>& results,
+                    const std::vector<CounterResult>& counted, const PerfCounters* counters,
+                    f64 min_time) {
+        out << "{\n"
+            << "  \"suite\": \"simulation\",\n"
+            << "  \"segment_kernel\": \"" << segment_kernel_name() << "\",\n"
+            << "  \"min_time_s\": " << min_time << ",\n"
+            << "  \"results\": [\n";
+
+        for (size_t i = 0; i < results.size(); ++i) {
+            const auto& r = results[i];
+
+            out << "    { \"sweep\": \"" << r.sweep << "\", \"benchmark\": \"" << r.benchmark
+                << "\", \"variant\": \"" << r.variant << "\", \"difficulty\": " << r.difficulty
+                << ", \"asteroids\": " << r.asteroids << ", \"bullets\": " << r.bullets
+                << ", \"threads\": " << r.threads << ", \"ns\": " << r.ns << " }"
+                << (i + 1 < results.size() ? "," : "") << '\n';
+        }
+
+        out << "  ],\n"
+            << "  \"counters\": [\n";
+
+        // Counts per tick; null for the events the CPU could not count.
+        for (size_t i = 0; i < counted.size(); ++i) {
+            const auto& r = counted[i];
+
+            out << "    { \"sweep\": \"" << r.sweep << "\", \"difficulty\": " << r.difficulty
+                << ", \"asteroids\": " << r.asteroids << ", \"bullets\": " << r.bullets
+                << ", \"phase\": \"" << phase_name(r.phase) << '"';
+
+            for (u32 event = 0; event < PERF_EVENT_COUNT; ++event) {
+                out << ", \"" << perf_event_name(PerfEvent(event)) << "\": ";
+
+                if (counters->has(PerfEvent(event)))
+                    out << r.per_tick[event];
+                else
+                    out << "null";
+            }
+
+            out << " }" << (i + 1 < counted.size() ? "," : "") << '\n';
+        }
+
+        out << "  ]\n"
+            << "}\n";
+    }
+
+    void usage() {
+        std::wcout << L"Usage: simulation_bench [--json FILE] [--csv FILE] [--min-time SECONDS]\n";
+    }
+
+    bool parse_options(int argc, char** argv, Options& options) {
+        for (int i = 1; i < argc; ++i) {
+            if (i + 1 >= argc) {
+                usage();
+                return false;
+            }
+
+            const char* name = argv[i];
+            const char* value = argv[++i];
+
+            if (!strcmp(name, "--json"))
+                options.json_path = value;
+            else if (!strcmp(name, "--csv"))
+                options.csv_path = value;
+            else if (!strcmp(name, "--min-time"))
+                options.min_time = std::strtod(value, nullptr);
+            else {
+                usage();
+                return false;
+            }
+        }
+
+        if (options.min_time <= 0) {
+            usage();
+            return false;
+        }
+
+        return true;
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+
+    if (!parse_options(argc, argv, options))
+        return -1;
+
+    std::vector<Result> results;
+    std::vector<CounterResult> counted;
+    const Spirits spirits;
+
+    // Only the JSON has room for the counts.
+    PerfCounters perf_counters;
+    PerfCounters* counters = nullptr;
+
+    if (!options.json_path.empty()) {
+        if (perf_counters.Init())
+            counters = &perf_counters;
+        else
+            std::wcout << L"No hardware counters, the JSON goes without them\n";
+    }
+
+    bench_pair("asteroid-bullet", spirits.asteroid, spirits.bullet, options.min_time, results);
+    bench_pair("asteroid-rocket", spirits.asteroid, spirits.controller, options.min_time, results);
+    bench_pair("rocket-bullet", spirits.controller, spirits.bullet, options.min_time, results);
+
+    for (u32 entities : { 100u, 1'000u, 10'000u, 100'000u }) {
+        if (!bench_entities(entities, options.min_time, results, counters, counted))
+            return -1;
+    }
+
+    for (u32 difficulty = 1; difficulty <= 6; ++difficulty) {
+        if (!bench_difficulty(difficulty, options.min_time, results, counters, counted))
+            return -1;
+    }
+
+    if (options.json_path.empty() && options.csv_path.empty())
+        write_csv(std::wcout, results);
+
+    if (!options.json_path.empty()) {
+        std::ofstream file(options.json_path);
+        write_json(file, results, counted, counters, options.min_time);
+
+        if (!file) {
+            std::wcout << L"Cannot write " << options.json_path.wstring() << L'\n';
+            return -1;
+        }
+    }
+
+    if (!options.csv_path.empty()) {
+        std::ofstream file(options.csv_path);
+        write_csv(file, results);
+
+        if (!file) {
+            std::wcout << L"Cannot write " << options.csv_path.wstring() << L'\n';
+            return -1;
+        }
+    }
+
+    return 0;
+}
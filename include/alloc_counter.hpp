@@ -0,0 +1,8 @@
+#pragma once
+#include "common.hpp"
+
+// Bytes requested from the global operator new since the start, on any
+// thread. They are counted by replacing operator new and delete, which only
+// the executables built with src/alloc_counter.cpp do (asteroids_headless);
+// the function is not there for the others.
+u64 allocated_bytes();
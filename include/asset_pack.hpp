@@ -0,0 +1,91 @@
+#pragma once
+#include <filesystem>
+
+#include "common.hpp"
+#include "mapped_file.hpp"
+#include "sprite_atlas.hpp"
+
+// Where the build writes the pack, relative to the directory holding assets/.
+constexpr const wchar_t* ASSET_PACK_PATH = L"assets/sprites.pack";
+
+// The display scales the packer prepares an atlas for: those Windows offers.
+// Any other falls back to decoding the PNGs.
+constexpr f32 PACKED_PIXELS_PER_DIP[] = { 1.f, 1.25f, 1.5f, 1.75f, 2.f };
+
+// An asset pack is the sprite atlas (see `SpriteAtlas`) at every scale of
+// PACKED_PIXELS_PER_DIP, written by `asset_packer` at build time so that the
+// game starts without decoding, premultiplying or resampling anything:
+//
+//   PackHeader
+//   PackAtlas[atlas_count]
+//   the pixels of every atlas, each starting on a PACK_ALIGNMENT boundary
+//
+// Little-endian, every field at its natural alignment and no implicit
+// padding, so the file is used in place once mapped. The pixels are
+// premultiplied BGRA, rows without padding, ready to be drawn or uploaded.
+// The collision contours need no place here: they are compiled in.
+constexpr u32 PACK_ALIGNMENT = 64;
+
+struct PackHeader {
+    char magic[4];
+    u32 version;
+    u32 atlas_count;
+
+    // SpiritSprites::COUNT and SpiritSprites::MIP_LEVELS.
+    u32 sprite_count;
+    u32 level_count;
+
+    // `Spirits` scales the sprites were packed at; the pack is out of date
+    // when they change.
+    f32 scales[SpiritSprites::COUNT];
+
+    u64 file_size;
+};
+
+struct PackSprite {
+    // Painted size in DIPs.
+    f32 width;
+    f32 height;
+
+    u32 level_count;
+    AtlasRegion levels[SpriteAtlas::MAX_LEVELS];
+};
+
+struct PackAtlas {
+    // Of the pixels, from the start of the file.
+    u64 offset;
+
+    f32 pixels_per_dip;
+    u32 width;
+    u32 height;
+
+    PackSprite sprites[SpiritSprites::COUNT];
+};
+
+static_assert(sizeof(PackHeader) == 40);
+static_assert(sizeof(PackSprite) == 76);
+static_assert(sizeof(PackAtlas) == 248);
+
+// A pack mapped into memory. Atlases taken from it point into the mapping,
+// so it must outlive them.
+struct AssetPack {
+    // False, and nothing mapped, if the pack is missing, damaged or out of
+    // date; all but the first are reported.
+    bool Init(const std::filesystem::path& path);
+
+    // Points `atlas` at the pixels packed for `pixels_per_dip`; false if
+    // the pack has no atlas at that scale.
+    bool load_atlas(f32 pixels_per_dip, SpriteAtlas& atlas, SpiritSprites& sprites) const;
+
+private:
+    bool validate(const std::filesystem::path& path) const;
+
+    MappedFile file;
+    const PackHeader* header = nullptr;
+    const PackAtlas* atlases = nullptr;
+};
+
+// Decodes the sprites under `root`, on `jobs` when given, and writes the
+// pack to `path`.
+bool write_asset_pack(const std::filesystem::path& root, const std::filesystem::path& path,
+                      JobSystem* jobs = nullptr);
@@ -0,0 +1,42 @@
+#pragma once
+#include <random>
+
+#include "common.hpp"
+#include "game.hpp"
+
+// Scripted player of the headless driver and the benchmarks. Holds a
+// direction for a random number of frames, steers back when it gets penalized
+// and keeps the trigger pressed most of the time.
+struct Autopilot {
+    Autopilot(u32 seed) : gen(seed) {}
+
+    Input next(const Game& game, i32 level) {
+        Input input;
+
+        if (game.State == Game::CHOOSE_NEW_LEVEL) {
+            input.level = level;
+            return input;
+        }
+
+        if (hold_frames == 0) {
+            direction = i32(gen() % 3) - 1;
+            hold_frames = 1 + gen() % 60;
+        }
+
+        --hold_frames;
+
+        if (game.penalty > 0.f)
+            direction = game.controller_pos.x < game.size.width / 2 ? 1 : -1;
+
+        input.left = direction < 0;
+        input.right = direction > 0;
+        input.space = gen() % 4 != 0;
+
+        return input;
+    }
+
+private:
+    std::mt19937 gen;
+    i32 direction = 0;
+    u32 hold_frames = 0;
+};
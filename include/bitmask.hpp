@@ -0,0 +1,80 @@
+#pragma once
+#include <array>
+#include <cmath>
+
+#include "common.hpp"
+#include "math.hpp"
+
+// One bit per pixel of a sprite drawn at its `SpiritData::scale`, set where
+// the sprite is (mostly) opaque. Rows are packed into 64-bit words, column c
+// of a row being bit c % 64 of word c / 64; bits past `Width` are zero.
+// Generated by `contour_gen` from the alpha channel of the asset.
+template<u32 Width, u32 Height>
+struct BitMask {
+    static constexpr u32 WIDTH = Width;
+    static constexpr u32 HEIGHT = Height;
+    static constexpr u32 WORDS_PER_ROW = (Width + 63) / 64;
+
+    // Half of the size of the painted bitmap; the mask is centered on the
+    // position of the object, like the bitmap.
+    Vector half_of_sides;
+
+    std::array<u64, size_t(Height) * WORDS_PER_ROW> rows;
+
+    const u64* row(u32 y) const { return rows.data() + size_t(y) * WORDS_PER_ROW; }
+};
+
+// Bits [start, start + 64) of a mask row, zero outside of it.
+inline u64 bits_at(const u64* row, u32 words, i32 start) {
+    const i32 word = start >= 0 ? start / 64 : -((63 - start) / 64);
+    const u32 bit = u32(start - word * 64);
+
+    const u64 lo = word >= 0 && u32(word) < words ? row[word] : 0;
+
+    if (!bit)
+        return lo;
+
+    const u64 hi = word + 1 >= 0 && u32(word + 1) < words ? row[word + 1] : 0;
+
+    return lo >> bit | hi << (64 - bit);
+}
+
+// Pixel-exact overlap test: `rhs` is snapped to the pixel grid of `lhs`, and
+// every row of the intersection of the two rectangles is ANDed a word at a
+// time with the matching bits of `rhs`. Pairs whose rectangles do not meet
+// are added to `bbox_rejects`.
+template<u32 W, u32 H, u32 X, u32 Y>
+inline bool intersect(const BitMask<W, H>& lhs, const BitMask<X, Y>& rhs,
+                      const Vector& lhs_center, const Vector& rhs_center,
+                      u64* bbox_rejects = nullptr) {
+    const Vector corner = rhs_center - rhs.half_of_sides - (lhs_center - lhs.half_of_sides);
+
+    const i32 dx = i32(std::lround(corner.x));
+    const i32 dy = i32(std::lround(corner.y));
+
+    const i32 x0 = dx > 0 ? dx : 0;
+    const i32 x1 = dx + i32(X) < i32(W) ? dx + i32(X) : i32(W);
+    const i32 y0 = dy > 0 ? dy : 0;
+    const i32 y1 = dy + i32(Y) < i32(H) ? dy + i32(Y) : i32(H);
+
+    if (x0 >= x1 || y0 >= y1) {
+        if (bbox_rejects)
+            ++*bbox_rejects;
+
+        return false;
+    }
+
+    const i32 first_word = x0 / 64, last_word = (x1 - 1) / 64;
+
+    for (i32 y = y0; y < y1; ++y) {
+        const u64* lhs_row = lhs.row(u32(y));
+        const u64* rhs_row = rhs.row(u32(y - dy));
+
+        for (i32 word = first_word; word <= last_word; ++word) {
+            if (lhs_row[word] & bits_at(rhs_row, rhs.WORDS_PER_ROW, word * 64 - dx))
+                return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+
+#include "common.hpp"
+
+// Source-over compositing of premultiplied BGRA pixels (one `u32` each, blue
+// in the lowest byte), the format Direct2D blends its bitmaps in:
+//
+//   src' = src * modulate / 256           (per channel)
+//   dst  = src' + dst * (255 - src'.a) / 255
+//
+// with the division by 255 rounded to nearest. The implementation (AVX2, SSE2
+// or scalar) is picked at startup from what the CPU supports; all of them
+// produce the same bytes.
+
+// Per-channel factors applied to the source, 256 meaning 1: the opacity of a
+// sprite in all four, or a text color times the opacity.
+struct Modulate {
+    u16 b, g, r, a;
+
+    static Modulate opacity(f32 opacity);
+    static Modulate tint(f32 r, f32 g, f32 b, f32 opacity);
+
+    bool is_identity() const { return b == 256 && g == 256 && r == 256 && a == 256; }
+};
+
+// Blends `count` source pixels over as many destination pixels.
+void blend_row(u32* dst, const u32* src, size_t count, const Modulate& modulate);
+
+// Name of the implementation in use ("avx2", "sse2" or "scalar").
+const char* blend_kernel_name();
+
+// Forces one of the implementations, e.g. to compare them. Fails if the CPU
+// does not support it.
+bool select_blend_kernel(const char* name);
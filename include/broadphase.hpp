@@ -0,0 +1,100 @@
+#pragma once
+#include <vector>
+#include <cmath>
+
+#include "common.hpp"
+#include "math.hpp"
+
+// Spatial hash over a uniform grid of square cells. It is rebuilt from scratch
+// every tick: items are counting-sorted by hash bucket into one flat array, so
+// a rebuild is two linear passes and allocates nothing once the buffers have
+// grown. Cells are hashed rather than laid out in a fixed rectangle, so the
+// grid is unbounded (asteroids spawn above the screen).
+struct SpatialGrid {
+    // `position_of(i)` gives the position of item `i`, for i in [0, count).
+    template<typename PositionOf>
+    void build(f32 cell_size, u32 count, PositionOf&& position_of) {
+        inv_cell_size = 1.f / cell_size;
+
+        u32 buckets = 16;
+
+        while (buckets < 2 * count)
+            buckets *= 2;
+
+        mask = buckets - 1;
+
+        bucket_start.assign(buckets + 1, 0);
+        items.resize(count);
+        item_cells.resize(count);
+        scratch_cells.resize(count);
+
+        for (u32 i = 0; i < count; ++i) {
+            const Vector pos = position_of(i);
+            const Cell cell { cell_of(pos.x), cell_of(pos.y) };
+
+            scratch_cells[i] = cell;
+            ++bucket_start[bucket_of(cell) + 1];
+        }
+
+        for (u32 b = 0; b < buckets; ++b)
+            bucket_start[b + 1] += bucket_start[b];
+
+        // Reuse the prefix sums as insertion cursors, shifted back afterwards.
+        for (u32 i = 0; i < count; ++i) {
+            const u32 slot = bucket_start[bucket_of(scratch_cells[i])]++;
+
+            items[slot] = i;
+            item_cells[slot] = scratch_cells[i];
+        }
+
+        for (u32 b = buckets; b > 0; --b)
+            bucket_start[b] = bucket_start[b - 1];
+
+        bucket_start[0] = 0;
+    }
+
+    // Calls `visit(i)` once for every item positioned inside the cells that
+    // overlap the [min, max] rectangle, in increasing order of `i` within a cell.
+    template<typename Visit>
+    void query(const Vector& min, const Vector& max, Visit&& visit) const {
+        const i32 x0 = cell_of(min.x), x1 = cell_of(max.x);
+        const i32 y0 = cell_of(min.y), y1 = cell_of(max.y);
+
+        for (i32 cy = y0; cy <= y1; ++cy) {
+            for (i32 cx = x0; cx <= x1; ++cx) {
+                const Cell cell { cx, cy };
+                const u32 bucket = bucket_of(cell);
+
+                for (u32 slot = bucket_start[bucket]; slot < bucket_start[bucket + 1]; ++slot) {
+                    // Different cells may share a bucket.
+                    if (item_cells[slot] == cell)
+                        visit(items[slot]);
+                }
+            }
+        }
+    }
+
+private:
+    struct Cell {
+        i32 x, y;
+
+        bool operator==(const Cell&) const = default;
+    };
+
+    i32 cell_of(f32 coord) const {
+        return i32(std::floor(coord * inv_cell_size));
+    }
+
+    u32 bucket_of(const Cell& cell) const {
+        u32 hash = u32(cell.x) * 0x9e3779b1u ^ u32(cell.y) * 0x85ebca77u;
+        return (hash ^ hash >> 15) & mask;
+    }
+
+    f32 inv_cell_size = 1.f;
+    u32 mask = 0;
+
+    std::vector<u32> bucket_start;
+    std::vector<u32> items;
+    std::vector<Cell> item_cells;
+    std::vector<Cell> scratch_cells;
+};
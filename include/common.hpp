@@ -1,12 +1,15 @@
 #pragma once
 #include <cstdint>
 #include <cmath>
+
+#ifdef _WIN32
 #include <windows.h>
 #include <wrl.h>
 #include <wrl/client.h>
 
 template<typename T>
 using ComPtr = Microsoft::WRL::ComPtr<T>;
+#endif // _WIN32
 
 using u64 = uint64_t;
 using i64 = int64_t;
@@ -25,6 +28,8 @@ using f64 = double;
 
 // #define PAINT_CONTOUR_DBG
 
+#ifdef _WIN32
 inline bool key_up(int vkey) {
     return !!(GetAsyncKeyState(vkey) & 0x8000);
 }
+#endif // _WIN32
@@ -0,0 +1,33 @@
+#pragma once
+#include <atomic>
+#include <filesystem>
+#include <thread>
+
+#include "common.hpp"
+#include "live_counters.hpp"
+
+// Serves `LiveCounters::snapshot` on a Unix domain socket, for watching a
+// long run while it goes: every connection gets one snapshot and is closed,
+// so polling is connecting again (tools/counters_poll.cpp, or
+// `socat - UNIX-CONNECT:<path>`). A thread of its own answers; the game never
+// waits for it. Not on Windows.
+struct CounterServer {
+    // Listens at `path`, replacing a socket left there by an earlier run that
+    // is gone; fails when another run still answers there, or when something
+    // other than a socket is in the way.
+    bool Init(const std::filesystem::path& path_, const LiveCounters& counters_);
+
+    // Stops answering and removes the socket, if `Init` made one.
+    ~CounterServer();
+
+private:
+    void serve();
+
+    std::filesystem::path path;
+    const LiveCounters* counters = nullptr;
+
+    int listener = -1;
+    bool bound = false;
+    std::atomic<bool> stopping = false;
+    std::thread thread;
+};
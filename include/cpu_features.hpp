@@ -0,0 +1,96 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+
+// What the SIMD kernels (segment_kernel.cpp, blend_kernel.cpp,
+// png_kernel.cpp) need to pick an implementation at startup: intrinsics on
+// x86, whether the CPU and the OS support AVX2, and the table to pick from.
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define CPU_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(CPU_X86) && !defined(_MSC_VER)
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_AVX2
+#endif
+
+#ifdef CPU_X86
+inline bool cpu_has_avx2() {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+
+    if (info[0] < 7)
+        return false;
+
+    __cpuid(info, 1);
+
+    // The OS must save the YMM registers on context switches.
+    const bool osxsave = info[2] & (1 << 27);
+
+    if (!osxsave || (_xgetbv(0) & 0x6) != 0x6)
+        return false;
+
+    __cpuidex(info, 7, 0);
+    return info[1] & (1 << 5);
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif // CPU_X86
+
+// The implementations of one kernel (avx2, sse2, scalar), `Kernels` being
+// what each of them provides: a function pointer, or a struct of them. The
+// best one the CPU supports is used until another is selected by name.
+template<typename Kernels>
+struct KernelDispatch {
+    static constexpr size_t MAX_IMPLEMENTATIONS = 3;
+
+    struct Implementation {
+        const char* name;
+        Kernels kernels;
+        bool supported;
+    };
+
+    // From the best to the portable one, which every CPU supports.
+    KernelDispatch(std::initializer_list<Implementation> list_) {
+        for (const Implementation& impl : list_)
+            list[count++] = impl;
+
+        selected = list.data();
+
+        while (!selected->supported)
+            ++selected;
+    }
+
+    KernelDispatch(const KernelDispatch&) = delete;
+    KernelDispatch& operator=(const KernelDispatch&) = delete;
+
+    const Kernels& kernels() const { return selected->kernels; }
+    const char* name() const { return selected->name; }
+
+    // Fails if there is no such implementation or the CPU does not support it.
+    bool select(const char* name_) {
+        for (size_t i = 0; i < count; ++i) {
+            if (!strcmp(list[i].name, name_) && list[i].supported) {
+                selected = &list[i];
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+private:
+    std::array<Implementation, MAX_IMPLEMENTATIONS> list {};
+    size_t count = 0;
+    const Implementation* selected = nullptr;
+};
@@ -0,0 +1,165 @@
+#pragma once
+#include <vector>
+#include <new>
+#include <cstddef>
+
+#include "common.hpp"
+#include "math.hpp"
+
+// Allocator handing out cache-line aligned blocks, so every column of an
+// `EntityPool` starts on a boundary suitable for any SIMD width.
+template<typename T, size_t Alignment = 64>
+struct AlignedAllocator {
+    using value_type = T;
+
+    template<typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() = default;
+
+    template<typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+    }
+
+    void deallocate(T* p, size_t) {
+        ::operator delete(p, std::align_val_t(Alignment));
+    }
+
+    template<typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const { return true; }
+};
+
+template<typename T>
+using Column = std::vector<T, AlignedAllocator<T>>;
+
+// Asteroids or bullets, stored as structure of arrays: one contiguous column
+// per field, so every pass touches only the fields it needs and the simple
+// ones (moving, shrinking) compile to vector code.
+//
+// Entities only ever move vertically, so x is constant and the previous tick
+// needs just `prev_y`. Entities are kept in spawn order, the oldest first;
+// `remove_if` compacts the columns in place, so dead entities never stay
+// behind live ones and every pass costs only as much as the live count.
+struct EntityPool {
+    Column<f32> x;
+    Column<f32> y;
+    Column<f32> prev_y;
+    Column<f32> speed;  // vertical, per 5 ms motion step
+    Column<f32> size;   // 1 when alive, shrinking to 0 once destroyed
+    Column<u8> destroyed;   // set by `destroy` only
+
+    // Entities ever pushed and removed, for the live counters.
+    u64 spawned = 0;
+    u64 reclaimed = 0;
+
+    // Destroyed entities not removed yet, still shrinking.
+    u64 dead = 0;
+
+    size_t count() const { return x.size(); }
+    bool empty() const { return x.empty(); }
+
+    Vector pos(size_t i) const { return Vector(x[i], y[i]); }
+
+    void destroy(size_t i) {
+        destroyed[i] = 1;
+        ++dead;
+    }
+
+    // Distance covered during the last `move`.
+    Vector motion(size_t i) const { return Vector(0.f, y[i] - prev_y[i]); }
+
+    Vector interpolated_pos(size_t i, f32 alpha) const {
+        return Vector(x[i], prev_y[i] + (y[i] - prev_y[i]) * alpha);
+    }
+
+    void push(const Vector& pos, f32 entity_speed) {
+        x.push_back(pos.x);
+        y.push_back(pos.y);
+        prev_y.push_back(pos.y);
+        speed.push_back(entity_speed);
+        size.push_back(1.f);
+        destroyed.push_back(0);
+
+        ++spawned;
+    }
+
+    void clear() {
+        reclaimed += count();
+        dead = 0;
+
+        for_each_column([](auto& column) { column.clear(); });
+    }
+
+    // Removes every entity `i` for which `expired(i)` holds, keeping the
+    // order of the others. `expired` may read the columns at `i`.
+    template<typename Expired>
+    void remove_if(Expired&& expired) {
+        const size_t n = count();
+        size_t kept = 0;
+
+        // Nothing moves until the first removal.
+        while (kept < n && !expired(kept))
+            ++kept;
+
+        for (size_t i = kept; i < n; ++i) {
+            if (expired(i)) {
+                dead -= destroyed[i];
+                ++reclaimed;
+                continue;
+            }
+
+            for_each_column([i, kept](auto& column) { column[kept] = column[i]; });
+            ++kept;
+        }
+
+        for_each_column([kept](auto& column) { column.resize(kept); });
+    }
+
+    void reserve(size_t n) {
+        for_each_column([n](auto& column) { column.reserve(n); });
+    }
+
+    // prev_y = y; y += shift * speed
+    void move(f32 shift) {
+        move(shift, 0, count());
+    }
+
+    // The same for entities [begin, end) only, so disjoint ranges can move on
+    // different threads.
+    void move(f32 shift, size_t begin, size_t end) {
+        f32* __restrict py = y.data();
+        f32* __restrict pprev = prev_y.data();
+        const f32* __restrict pspeed = speed.data();
+
+        for (size_t i = begin; i < end; ++i) {
+            pprev[i] = py[i];
+            py[i] += shift * pspeed[i];
+        }
+    }
+
+    // Destroyed entities lose `step` of their size every tick, down to zero.
+    void shrink_destroyed(f32 step) {
+        const size_t n = count();
+        f32* __restrict psize = size.data();
+        const u8* __restrict pdestroyed = destroyed.data();
+
+        for (size_t i = 0; i < n; ++i)
+            psize[i] -= pdestroyed[i] && psize[i] > 0 ? step : 0.f;
+    }
+
+private:
+    template<typename F>
+    void for_each_column(F&& f) {
+        f(x);
+        f(y);
+        f(prev_y);
+        f(speed);
+        f(size);
+        f(destroyed);
+    }
+};
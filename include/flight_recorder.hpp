@@ -0,0 +1,89 @@
+#pragma once
+#include <filesystem>
+#include <vector>
+
+#include "common.hpp"
+#include "frame_profiler.hpp"
+
+struct Game;
+struct Input;
+
+// The last few hundred frames, always recorded, written to a file when a
+// frame takes longer than a budget: what the game was doing around a hitch
+// that nobody was tracing for. Recording a tick or a frame copies a few
+// numbers into a ring that is allocated once. The timings are those of the
+// `PhaseTimes` of the tick and the frame: whoever drives the frames times
+// them, while the phases of a tick are timed (and left at 0 otherwise) only
+// for a `Game::profiler`, which would double the cost of a small tick.
+//
+// A dump is written FRAMES_AFTER frames after the hitch, so that it shows
+// what followed it too, to `dump_dir / hitch_<frame>.json`. At most
+// MAX_DUMPS are written in a run; further hitches are only counted.
+
+// PHASE_MOTION to PHASE_GC; the others are timed per frame.
+constexpr u32 TICK_PHASES = PHASE_PAINT;
+
+struct FlightTick {
+    u64 tick;
+    u64 frame;
+    u64 phases[TICK_PHASES];
+    u32 asteroids;
+    u32 bullets;
+    i32 score;
+    u8 state;
+
+    // As packed by `pack_input`.
+    u8 input;
+};
+
+struct FlightFrame {
+    u64 frame;
+    u64 phases[PHASE_COUNT - TICK_PHASES];
+};
+
+struct FlightRecorder {
+    static constexpr u32 FRAMES = 512;
+    static constexpr u32 TICKS = 4'096;
+    static constexpr u32 FRAMES_AFTER = 64;
+    static constexpr u32 MAX_DUMPS = 16;
+
+    // What the windowed game takes for a hitch unless told otherwise.
+    static constexpr u64 DEFAULT_BUDGET_US = 100'000;
+
+    // Frames over `budget_us` (PHASE_FRAME) are dumped, none when it is 0.
+    bool Init(u64 budget_us, std::filesystem::path dump_dir_);
+
+    // The tick that `game` just took, with `input`, as part of the current frame.
+    void record_tick(const Game& game, const Input& input, const PhaseTimes& times);
+
+    // Closes the current frame, with the time of its phases (PHASE_PAINT to
+    // PHASE_FRAME). False when a dump was due and could not be written.
+    bool end_frame(const PhaseTimes& times);
+
+    // Writes the dump still waiting for the frames after its hitch, if any.
+    bool Finish();
+
+    u64 get_hitches() const { return hitches; }
+    u32 get_dumps() const { return dumps; }
+
+private:
+    bool dump();
+
+    std::vector<FlightTick> ticks;
+    std::vector<FlightFrame> frames;
+
+    // Ticks and frames ever recorded; the current frame is `frame`.
+    u64 tick_count = 0;
+    u64 frame = 0;
+
+    u64 budget = 0;
+    std::filesystem::path dump_dir;
+
+    u64 hitches = 0;
+    u32 dumps = 0;
+
+    // The hitch waiting to be dumped, and the frame that writes it (0 when
+    // none is waiting).
+    u64 hitch_frame = 0;
+    u64 dump_frame = 0;
+};
@@ -0,0 +1,141 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <bit>
+#include <filesystem>
+#include <ostream>
+
+#include "common.hpp"
+
+// Where the time of a frame goes. The first four are the phases of a game
+// tick, timed once per tick (a frame has any number of ticks); the others
+// are timed once per painted frame.
+enum FramePhase : u32 {
+    PHASE_MOTION,       // update_motion, compute_penalty
+    PHASE_SPAWN,        // new_asteroids, new_bullets
+    PHASE_COLLISION,    // is_there_collision, destroy_asteroids
+    PHASE_GC,           // collect_garbage
+    PHASE_PAINT,        // ScenePainter::paint (and compositing, in software)
+    PHASE_TEXT_FLUSH,   // TextHelper::Flush
+    PHASE_PRESENT,      // EndDraw and Present
+    PHASE_FRAME,        // all of the frame, ticks included
+    PHASE_COUNT,
+};
+
+const char* phase_name(FramePhase phase);
+
+struct PerfCounters;
+
+// A timestamp for the profiler only (the game itself never reads the time,
+// see `Clock`): the time stamp counter on x86, read in a fraction of the time
+// of the OS clock, the monotonic clock in nanoseconds elsewhere.
+u64 profile_now();
+
+// Nanoseconds per unit of `profile_now`, measured on the first call.
+f64 profile_tick_ns();
+
+// Counts of values in buckets that widen with the value: one per value
+// below SUB_BUCKETS, then SUB_BUCKETS per power of two, so that a percentile
+// is off by at most 1 / SUB_BUCKETS of itself (3%). Recording is a couple of
+// shifts and an increment, and any u64 fits.
+struct LogHistogram {
+    static constexpr u32 SUB_BITS = 5;
+    static constexpr u32 SUB_BUCKETS = 1 << SUB_BITS;
+    static constexpr u32 BUCKETS = (64 - SUB_BITS + 1) * SUB_BUCKETS;
+
+    static u32 bucket_of(u64 value) {
+        if (value < SUB_BUCKETS)
+            return u32(value);
+
+        const u32 shift = u32(std::bit_width(value)) - 1 - SUB_BITS;
+        return (shift + 1) * SUB_BUCKETS + u32(value >> shift) - SUB_BUCKETS;
+    }
+
+    // The largest value that falls in `bucket`.
+    static u64 bucket_max(u32 bucket);
+
+    void record(u64 value) {
+        ++buckets[bucket_of(value)];
+        ++count;
+        sum += value;
+        max = value > max ? value : max;
+    }
+
+    // The value that a fraction `q` of those recorded do not exceed, rounded
+    // up to the end of its bucket (but never past the largest one).
+    u64 percentile(f64 q) const;
+
+    f64 mean() const { return count ? f64(sum) / f64(count) : 0; }
+
+    void clear();
+
+    u64 count = 0;
+    u64 sum = 0;
+    u64 max = 0;
+    std::array<u32, BUCKETS> buckets {};
+};
+
+// The time spent in each phase over one tick or frame, added up as the
+// phases go: a phase may be timed in several pieces, and on several threads
+// at once (it is then the time of all of them together). Phases left at 0
+// were not timed. Does nothing when not `enabled`, so the code being timed
+// need not check.
+struct PhaseTimes {
+    explicit PhaseTimes(bool enabled)
+        : enabled(enabled) {}
+
+    // Where a phase starts from: now, or 0 when disabled.
+    u64 start() const {
+        if (counters)
+            count_start();
+
+        return enabled ? profile_now() : 0;
+    }
+
+    // Adds the time since `start` to `phase`; returns now, for the phase
+    // that follows to start from.
+    u64 add(FramePhase phase, u64 start) {
+        if (counters)
+            count(phase);
+
+        if (!enabled)
+            return 0;
+
+        const u64 now = profile_now();
+
+        ticks[phase].fetch_add(now - start, std::memory_order_relaxed);
+        return now;
+    }
+
+    const bool enabled;
+    std::array<std::atomic<u64>, PHASE_COUNT> ticks {};
+
+    // When set, the phases are also counted there, timed or not; only for
+    // phases timed in order, on the thread that opened the counters.
+    PerfCounters* counters = nullptr;
+
+private:
+    void count_start() const;
+    void count(FramePhase phase) const;
+};
+
+// One histogram of durations per phase, in units of `profile_now`, turned
+// into time when printed. Kept for the whole run and dumped when asked for:
+// on exit, or on a key in the windowed game. Recorded from one thread; tasks
+// add up to `PhaseTimes` instead.
+struct FrameProfiler {
+    void record(FramePhase phase, u64 ticks) { phases[phase].record(ticks); }
+
+    // One value for every phase timed in `times`.
+    void record(const PhaseTimes& times);
+
+    void clear();
+
+    // Count, mean, p50, p99, p99.9 and max of every phase, in microseconds.
+    void print(std::wostream& out) const;
+
+    // The same, as JSON when `path` ends with .json and as CSV otherwise.
+    bool write(const std::filesystem::path& path) const;
+
+    std::array<LogHistogram, PHASE_COUNT> phases;
+};
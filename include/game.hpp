@@ -0,0 +1,265 @@
+#pragma once
+#include <random>
+
+#include "common.hpp"
+#include "timer.hpp"
+#include "math.hpp"
+#include "spirits_gen.hpp"
+#include "typewriter.hpp"
+#include "broadphase.hpp"
+#include "entity_pool.hpp"
+#include "job_system.hpp"
+#include "frame_profiler.hpp"
+#include "flight_recorder.hpp"
+#include "perf_counters.hpp"
+#include "live_counters.hpp"
+
+// Keys sampled once per frame by the platform layer (or injected by the
+// headless driver).
+struct Input {
+    bool left = false;
+    bool right = false;
+    bool space = false;
+
+    // Level picked on the CHOOSE_NEW_LEVEL screen (1-6), 0 if none.
+    i32 level = 0;
+};
+
+// Whole gameplay state and stepping, free of any platform API. `WindowLogic`
+// feeds it with input and time and paints what is left here.
+//
+// The game advances in fixed ticks of 1 / `tick_rate` seconds, each one
+// taking the same input, so a run depends only on the seed and the inputs and
+// never on the frame rate of whoever drives it.
+struct Game {
+    static constexpr u32 DEFAULT_TICK_RATE = 200;
+    static constexpr u32 MAX_CATCH_UP_TICKS = 20;
+
+    bool Init(SizeF size_, u32 seed, u32 tick_rate_ = DEFAULT_TICK_RATE);
+
+    bool set_asteroid_frequency();
+
+    void reset_controller_pos();
+    void set_size(SizeF size_);
+    // Advances the game by exactly one tick.
+    bool update_scene(const Input& input);
+
+    // Clears the playfield and fades into a fresh game at the given level.
+    bool start_level(i32 level);
+
+    // Hash of the gameplay state, for checking that two runs are identical.
+    u64 checksum() const;
+
+    //
+    // Phases of `update_scene`, public for the benchmarks.
+    //
+    void compute_penalty();
+
+    void collect_garbage();
+    void destroy_asteroids();
+
+    bool is_there_collision();
+
+    // How `destroy_asteroids` finds bullet-asteroid pairs. Both give the same
+    // result; NESTED tests every pair and is kept as the reference.
+    enum BroadphaseKind {
+        BROADPHASE_GRID,
+        BROADPHASE_NESTED,
+    } broadphase = BROADPHASE_GRID;
+
+    // How a candidate pair is tested. SWEPT runs the separating axis test
+    // over the whole motion of the tick, so nothing tunnels however long the
+    // tick is, and a bullet that touches an asteroid earlier takes it first.
+    // SAT tests only the positions at the end of the tick; EDGES is the
+    // original edge crossing test (blind to containment), batched with SIMD.
+    // MASK ANDs the alpha masks of the sprites, exact to a pixel of what is
+    // painted, also at the end of the tick.
+    enum NarrowphaseKind {
+        NARROWPHASE_SWEPT,
+        NARROWPHASE_SAT,
+        NARROWPHASE_EDGES,
+        NARROWPHASE_MASK,
+    } narrowphase = NARROWPHASE_SWEPT;
+
+    // When set, ticks with at least PARALLEL_MIN_ENTITIES entities run as a
+    // task graph on these threads; see `update_scene_parallel`. The outcome
+    // is the same, bit for bit, as that of the serial tick. The graph splits
+    // the work of BROADPHASE_GRID, so with NESTED every tick stays serial.
+    JobSystem* jobs = nullptr;
+
+    static constexpr size_t PARALLEL_MIN_ENTITIES = 2'048;
+
+    // When set, every tick adds the time of its phases (PHASE_MOTION to
+    // PHASE_GC) to these histograms.
+    FrameProfiler* profiler = nullptr;
+
+    // When set, every tick is recorded there, with its input and the state
+    // it ends in (and the time of its phases, with a `profiler`).
+    FlightRecorder* flight_recorder = nullptr;
+
+    // When set, the serial tick adds up the hardware counters of its phases
+    // there. The parallel one does not: the counters follow one thread.
+    PerfCounters* counters = nullptr;
+
+    // When set, gets the counts of every tick, see `tick_counts`.
+    LiveCounters* live_counters = nullptr;
+
+    Game()
+        : norm_asteroid_x(0.5f, 0.125f) // Almost always (0, 1)
+        , unif_asteroid_y(0.f, 1.f)     // Always [0, 1)
+        , unif_speed(1.f, 1.5f) {}
+
+private:
+    void new_asteroids();
+    void new_bullets(const Input& input);
+
+    void asteroids_move(const f32 shift);
+    void controller_move(const f32 shift, const Input& input);
+    void bullets_move(const f32 shift);
+    void game_over_move(const f32 shift);
+
+    void update_motion(const Input& input);
+    bool update_state(const Input& input);
+
+    void destroy_asteroids_nested();
+    void destroy_asteroids_grid();
+
+    Vector bullet_reach() const;
+    Vector build_bullet_grid();
+    Vector query_reach(const Vector& reach, const Vector& asteroid_motion) const;
+
+    void update_scene_parallel(const Input& input, PhaseTimes& times);
+
+    // The bullets that touch one asteroid during the tick, and when.
+    struct HitCandidate {
+        u32 bullet;
+        f32 toi;
+    };
+
+    // Asteroids in one vertical strip of the playfield, with their candidates:
+    // those of `asteroids[k]` are [first[k], first[k + 1]) in `candidates`,
+    // the first to touch first.
+    struct HitRegion {
+        std::vector<u32> asteroids;
+        std::vector<u32> first;
+        std::vector<HitCandidate> candidates;
+
+        // Those of `find_hits`, added to `tick_counts` by `apply_hits`.
+        TickCounts counts;
+    };
+
+    void bin_asteroids(u32 regions);
+    void find_hits(HitRegion& region) const;
+    void apply_hits();
+
+    std::vector<HitRegion> hit_regions;
+    std::vector<u32> hit_region_of;
+    std::vector<u32> hit_slot_of;
+
+    void remember_positions();
+
+    // `rhs` ends the tick at `rhs_center` having moved by `rhs_motion`
+    // relative to `lhs`. `toi` is the fraction of the tick at which they
+    // touch (1 for the tests that only look at the end of the tick).
+    template<typename Lhs, typename Rhs>
+    bool collide(const Lhs& lhs, const Rhs& rhs,
+                 const Vector& lhs_center, const Vector& rhs_center,
+                 const Vector& rhs_motion, f32& toi, TickCounts& counts) const;
+
+    SpatialGrid bullet_grid;
+
+    // Simulated time, advanced by one tick per `update_scene`. All the
+    // gameplay timers run on it.
+    Clock clock;
+
+    // Distance covered in one tick, in units of the original 5 ms motion step.
+    f32 shift;
+
+public:
+    //
+    // Everything below is read by the painting code.
+    //
+    SizeF size;
+
+    enum GameState {
+        FADE_IN,
+        GAME_PLAY,
+        GAME_OVER,
+        FADE_OUT,
+        CHOOSE_NEW_LEVEL,
+    } State = GAME_PLAY;
+
+    //
+    // GAME_PLAY, GAME_OVER
+    //
+    Spirits spirits;
+    u32 difficulty = 1;
+    bool bullet_forbidden = false;
+
+    u32 tick_rate;
+    u64 tick = 0;
+
+    // What the last tick did (what the phases did since, when called alone).
+    TickCounts tick_counts;
+
+    Timer new_asteroid_timer;
+    Timer new_bullet_timer;
+    Timer penalty_timer;
+
+    f32 bound_left;
+    f32 bound_right;
+
+    f32 penalty = 0;
+    f32 paint_blue = 0;
+
+    i32 penalty_points_total = 0;
+    i32 score = 0;
+
+    // Kept oldest first; the collision passes walk them newest first, the
+    // order the game has always resolved hits in. `prev_y` is the position
+    // one tick ago; painting interpolates between the two.
+    EntityPool asteroids;
+    EntityPool bullets;
+
+    bool asteroid_visible(f32 y) const {
+        return y <= size.height + spirits.asteroid.contour.half_of_sides.y;
+    }
+
+    bool bullet_visible(f32 y) const {
+        return y + spirits.bullet.contour.half_of_sides.y >= 0;
+    }
+
+    bool bullet_can_destroy(f32 y) const {
+        return y > 0;
+    }
+
+    f32 accel_left = 0, accel_right = 0;
+    f32 controller_downspeed = 0;
+    Vector controller_pos;
+    Vector prev_controller_pos;
+
+    std::normal_distribution<float> norm_asteroid_x;
+    std::uniform_real_distribution<float> unif_asteroid_y;
+    std::uniform_real_distribution<float> unif_speed;
+
+    std::mt19937 gen;
+
+    f32 game_over_progress = 0;
+
+    //
+    // FADE_OUT
+    //
+    Timer fade_out_timer;
+
+    //
+    // CHOOSE_NEW_LEVEL
+    //
+    Timer typewriter_timer;
+    TextTypewriterAnimation typewriter_animation;
+    i32 chosen_next_difficulty = -1;
+
+    //
+    // FADE_IN
+    //
+    f32 fade_in_progress = 0;
+};
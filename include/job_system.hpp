@@ -0,0 +1,122 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+#include "common.hpp"
+
+// Tasks of one run with the order they must keep: a task starts only after
+// every task that precedes it has finished. Built anew for every run (the
+// tick graph of `Game` depends on how many entities there are).
+struct TaskGraph {
+    using TaskId = u32;
+
+    TaskId add(std::function<void()> body) {
+        tasks.push_back({ std::move(body), {}, 0 });
+        return TaskId(tasks.size() - 1);
+    }
+
+    void precede(TaskId before, TaskId after) {
+        tasks[before].successors.push_back(after);
+        ++tasks[after].dependencies;
+    }
+
+    // `chunks` independent tasks calling `body(chunk)`.
+    template<typename Body>
+    std::vector<TaskId> add_chunks(u32 chunks, Body&& body) {
+        std::vector<TaskId> ids;
+
+        for (u32 chunk = 0; chunk < chunks; ++chunk)
+            ids.push_back(add([body, chunk] { body(chunk); }));
+
+        return ids;
+    }
+
+    void precede(const std::vector<TaskId>& before, TaskId after) {
+        for (TaskId id : before)
+            precede(id, after);
+    }
+
+    void precede(TaskId before, const std::vector<TaskId>& after) {
+        for (TaskId id : after)
+            precede(before, id);
+    }
+
+    size_t size() const { return tasks.size(); }
+
+private:
+    friend struct JobSystem;
+
+    struct Task {
+        std::function<void()> body;
+        std::vector<TaskId> successors;
+        u32 dependencies;
+    };
+
+    std::vector<Task> tasks;
+};
+
+// Runs task graphs on a fixed set of threads. Every thread owns a queue: it
+// pushes the tasks it makes ready at the back and pops from the back, so a
+// chain of tasks stays on one (warm) core, and when its queue is empty it
+// steals from the front of the others. The thread calling `run` works too.
+struct JobSystem {
+    JobSystem() = default;
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+    ~JobSystem();
+
+    // `threads` counts the caller of `run`; 0 means one per hardware thread.
+    bool Init(u32 threads);
+
+    u32 thread_count() const { return u32(queues.size()); }
+
+    // How many tasks to split an even parallel pass into: a few per thread,
+    // so that the threads that finish early can steal from the busy ones.
+    u32 chunk_count() const { return thread_count() * TASKS_PER_THREAD; }
+
+    // Returns when every task of `graph` has finished.
+    void run(TaskGraph& graph);
+
+private:
+    static constexpr u32 TASKS_PER_THREAD = 4;
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<TaskGraph::TaskId> tasks;
+    };
+
+    void worker_main(u32 index);
+    void work(u32 index);
+    bool next_task(u32 index, TaskGraph::TaskId& task);
+    void push(u32 index, TaskGraph::TaskId task);
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+
+    // The graph being run, with the count of unfinished dependencies of each
+    // of its tasks and of unfinished tasks.
+    TaskGraph* graph = nullptr;
+    std::unique_ptr<std::atomic<u32>[]> pending;
+    size_t pending_capacity = 0;
+    std::atomic<size_t> remaining { 0 };
+
+    // Threads that found nothing to do for a while sleep until a task is
+    // queued or the graph is done, instead of taking the core from those
+    // that have work.
+    std::atomic<size_t> queued { 0 };
+    std::atomic<u32> sleepers { 0 };
+    std::mutex idle_mutex;
+    std::condition_variable idle;
+
+    // Idle workers sleep until `epoch` changes, i.e. until the next run.
+    std::mutex wake_mutex;
+    std::condition_variable wake;
+    u64 epoch = 0;
+    bool stopping = false;
+};
@@ -0,0 +1,74 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <string>
+
+#include "common.hpp"
+
+struct Game;
+
+// What one tick did, counted by `Game` as it goes, whether anyone reads it or
+// not: an increment next to a narrowphase test does not show.
+struct TickCounts {
+    u64 pair_tests = 0;     // narrowphase tests of two sprites
+    u64 bbox_rejects = 0;   // of those, decided by the outer rectangles alone
+    u64 segment_tests = 0;  // segment against edge tests, by NARROWPHASE_EDGES
+
+    TickCounts& operator+=(const TickCounts& other) {
+        pair_tests += other.pair_tests;
+        bbox_rejects += other.bbox_rejects;
+        segment_tests += other.segment_tests;
+        return *this;
+    }
+};
+
+// Counters of a running game for anyone to look at while it runs (see
+// `CounterServer`): totals since the start, and gauges of the last tick or
+// frame. The game thread updates them once per tick and per frame, with plain
+// stores of totals it keeps itself; readers on other threads load them.
+enum LiveCounter : u32 {
+    LIVE_TICKS,
+    LIVE_FRAMES,
+    LIVE_PAIR_TESTS,
+    LIVE_BBOX_REJECTS,
+    LIVE_SEGMENT_TESTS,
+    LIVE_SPAWNED,
+    LIVE_RECLAIMED,
+    LIVE_ALLOCATED_BYTES,
+
+    // Gauges from here on.
+    LIVE_ASTEROIDS,
+    LIVE_BULLETS,
+    LIVE_DEAD_ASTEROIDS,    // destroyed, still shrinking in `asteroids`
+    LIVE_DEAD_BULLETS,
+    LIVE_FRAME_BYTES,       // allocated during the last frame
+    LIVE_COUNTER_COUNT,
+};
+
+constexpr u32 LIVE_FIRST_GAUGE = LIVE_ASTEROIDS;
+
+const char* live_counter_name(LiveCounter counter);
+
+struct LiveCounters {
+    // After every tick of `game`.
+    void record_tick(const Game& game);
+
+    // After every frame, with the bytes allocated since the last one.
+    void record_frame(u64 bytes);
+
+    // One "counter NAME VALUE" or "gauge NAME VALUE" line per counter.
+    std::string snapshot() const;
+
+private:
+    void publish(LiveCounter counter, u64 value) {
+        values[counter].store(value, std::memory_order_relaxed);
+    }
+
+    // Written by the game thread only.
+    TickCounts tick_totals;
+    u64 ticks = 0;
+    u64 frames = 0;
+    u64 allocated = 0;
+
+    std::array<std::atomic<u64>, LIVE_COUNTER_COUNT> values {};
+};
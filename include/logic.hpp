@@ -1,27 +1,40 @@
 #pragma once
-#include <random>
-#include <deque>
 
 #include <windows.h>
 #include <d2d1.h>
 #include <d2d1_2.h>
+#include <d2d1_3.h>
 #include <d3d11.h>
 #include <dxgi1_2.h>
+#include <span>
+#include <array>
+#include <vector>
 
 #include "common.hpp"
 #include "timer.hpp"
 #include "math.hpp"
-#include "spirits_gen.hpp"
+#include "game.hpp"
+#include "replay.hpp"
 #include "text_helper.hpp"
+#include "renderer.hpp"
+#include "sprite_atlas.hpp"
+#include "asset_pack.hpp"
+#include "frame_profiler.hpp"
+#include "flight_recorder.hpp"
 
 struct Window;
 
-struct WindowLogic {
-    bool Init();
+// Paints the scene with Direct2D; what gets painted is up to `ScenePainter`.
+struct WindowLogic final : Renderer {
+    // Inputs are recorded to `replay_path` unless it is null; the frame
+    // timings are written to `profile_path` (if not null) on F9 and on exit.
+    // F10 starts and stops a trace, written to `trace_path` (default
+    // trace.json); when given, the session is traced from the start. The
+    // last frames are dumped to the working directory around any frame that
+    // takes longer than `hitch_us`.
+    bool Init(const wchar_t* replay_path, const wchar_t* profile_path,
+              const wchar_t* trace_path, u64 hitch_us);
 
-    bool set_asteroid_frequency();
-
-    void reset_controller_pos();
     bool update_scene();
     bool paint();
 
@@ -30,44 +43,45 @@ struct WindowLogic {
     bool on_keypress(u16 vkey);
 
     WindowLogic(Window& window)
-        : window(window)
-        , norm_asteroid_x(0.5f, 0.125f) // Almost always (0, 1)
-        , unif_asteroid_y(0.f, 1.f)     // Always [0, 1)
-        , unif_speed(1.f, 1.5f)
-        , gen(rd())
-        , State(GAME_PLAY) {}
+        : window(window) {}
 
-private:
-    void compute_penalty();
+    ~WindowLogic();
 
-    void new_asteroids();
-    void new_bullets();
+    SizeF frame_size() const override;
+    SizeF sprite_size(SpriteKind sprite) const override;
+    void draw_sprite(SpriteKind sprite, const RectF& rect, f32 opacity) override;
+    void draw_sprites(SpriteKind sprite, std::span<const SpriteInstance> instances) override;
 
-    void asteroids_move(const f32 shift);
-    void controller_move(const f32 shift);
-    void bullets_move(const f32 shift);
-    void game_over_move(const f32 shift);
+    void draw_next_text(const wchar_t* text, size_t len) override;
+    void draw_chosen_level(i32 level, f32 opacity) override;
+    void draw_game_over(f32 opacity) override;
+    void draw_penalty(f32 opacity, i32 penalty) override;
+    void draw_data(i32 score, u32 difficulty) override;
 
-    void update_motion();
+#ifdef PAINT_CONTOUR_DBG
+    void draw_contour_dbg(std::span<const Vector> vertices, const Vector& center) override;
+#endif // PAINT_CONTOUR_DBG
 
-    void paint_asteroids();
-    void paint_controller();
-    void paint_bullets();
+private:
+    ComPtr<ID2D1Bitmap> create_gradient(const GradientColors& colors);
 
-    void collect_garbage();
-    void destroy_asteroids();
+    // Prints the frame timings, and writes them to `profile_path`.
+    void dump_profile() const;
 
-    bool is_there_collision();
+    // Starts tracing, or stops and writes the trace to `trace_path`.
+    void toggle_trace();
 
-    ComPtr<ID2D1Bitmap> create_gradient(D2D1_COLOR_F side_bg, D2D1_COLOR_F middle_bg);
+    ID2D1Bitmap* bitmap_of(SpriteKind sprite) const;
 
-#ifdef PAINT_CONTOUR_DBG
-    void paint_contour_dbg(const ObjectContour& contour, const Vector& center);
-#endif // PAINT_CONTOUR_DBG
+    // Where in `atlas_bitmap` to take `sprite` painted over `rect` from.
+    D2D1_RECT_U atlas_source(SpriteKind sprite, const RectF& rect) const;
 
-    ComPtr<ID2D1Bitmap> controller_bitmap;
-    ComPtr<ID2D1Bitmap> asteroid_bitmap;
-    ComPtr<ID2D1Bitmap> bullet_bitmap;
+    // The sprites, scaled for the DPI of the window, in one bitmap; mapped
+    // from the asset pack when it has them at this DPI.
+    AssetPack pack;
+    SpriteAtlas atlas;
+    SpiritSprites spirit_sprites;
+    ComPtr<ID2D1Bitmap1> atlas_bitmap;
 
     ComPtr<ID2D1Factory1> d2d_factory;
     ComPtr<ID3D11Device> device;
@@ -88,6 +102,15 @@ private:
     ComPtr<ID2D1Bitmap> red_background_bitmap;
     ComPtr<ID2D1Bitmap> blue_background_bitmap;
 
+    // Sprite batches need ID2D1DeviceContext3 (Windows 10 1703); without it
+    // `draw_sprites` falls back to one DrawBitmap per instance. One batch
+    // per sprite, as a batch is read when the frame is flushed.
+    ComPtr<ID2D1DeviceContext3> target3;
+    std::array<ComPtr<ID2D1SpriteBatch>, SPRITE_COUNT> sprite_batches;
+    std::vector<D2D1_RECT_F> batch_rects;
+    std::vector<D2D1_RECT_U> batch_sources;
+    std::vector<D2D1_COLOR_F> batch_colors;
+
 #ifdef PAINT_CONTOUR_DBG
     ComPtr<ID2D1SolidColorBrush> contour_brush;
 #endif // PAINT_CONTOUR_DBG
@@ -97,98 +120,33 @@ private:
 
     D2D1_SIZE_F size;
 
-    enum {
-        FADE_IN,
-        GAME_PLAY,
-        GAME_OVER,
-        FADE_OUT,
-        CHOOSE_NEW_LEVEL,
-    } State;
-
-    //
-    // GAME_PLAY, GAME_OVER
-    //
-    Spirits spirits;
-    u32 difficulty = 1;
-    bool bullet_forbidden = false;
-
-    f32 dpi_factor;
-
-    Timer background_timer;
-    Timer new_asteroid_timer;
-    Timer move_timer;
-    Timer new_bullet_timer;
-    Timer penalty_timer;
-
-    f32 bound_left;
-    f32 bound_right;
-
-    f32 penalty;
-    f32 paint_blue;
-
-    i32 penalty_points_total;
-    i32 score = 0;
-
-    D2D1_SIZE_F controller_bmp_size;
-    D2D1_SIZE_F asteroid_bmp_size;
-    D2D1_SIZE_F bullet_bmp_size;
-
-    struct Asteroid {
-        Vector pos;
-        f32 speed;
-        bool destroyed;
-        f32 size;
-    };
-
-    bool asteroid_visible(const Asteroid& asteroid) {
-        return asteroid.pos.y <= size.height + spirits.asteroid.contour.half_of_sides.y;
-    }
-
-    struct Bullet {
-        Vector pos;
-        bool destroyed;
-        f32 size;
-    };
-
-    bool bullet_visible(const Bullet& bullet) {
-        return bullet.pos.y + spirits.bullet.contour.half_of_sides.y >= 0;
-    }
-
-    bool bullet_can_destroy(const Bullet& bullet) {
-        return bullet.pos.y > 0;
-    }
-
-    f32 accel_left = 0, accel_right = 0;
-    f32 controller_downspeed = 0;
-    Vector controller_pos;
-
-    std::deque<Asteroid> asteroids;
-    std::deque<Bullet> bullets;
-
-    std::uniform_real_distribution<float> unif_speed;
-    std::normal_distribution<float> norm_asteroid_x;
-    std::uniform_real_distribution<float> unif_asteroid_y;
-
-    std::random_device rd;
-    std::mt19937 gen;
-
-    f32 game_over_progress = 0;
-
-    //
-    // FADE_OUT
-    //
-    Timer fade_out_timer;
-
-    //
-    // CHOOSE_NEW_LEVEL
-    //
-    Timer typewriter_timer;
-    TextTypewriterAnimation typewriter_animation;
-    inline static const wchar_t choose_difficulty[] = L"Choose new level difficulty:";
-    i32 chosen_next_difficulty = -1;
-
-    //
-    // FADE_IN
-    //
-    f32 fade_in_progress;
+    // Gameplay lives in the platform-free core; this class only feeds it
+    // with QueryPerformanceCounter time and keyboard state.
+    Game game;
+    ScenePainter painter;
+    Clock clock;
+    FixedTimestep timestep;
+
+    // How far between the last two ticks the painted frame is, [0, 1).
+    f32 alpha = 0.f;
+
+    ReplayWriter recorder;
+    bool recording = false;
+
+    // Level key pressed since the last update (WM_KEYDOWN arrives between
+    // updates, so it is kept until the next `Input` is built).
+    i32 pending_level = 0;
+
+    // Pixels per DIP.
+    f32 dpi_factor = 1.f;
+
+    // Every phase of every tick and frame of the session, at a few
+    // nanoseconds each.
+    FrameProfiler profiler;
+    std::filesystem::path profile_path;
+    u64 frame_start = 0;
+
+    std::filesystem::path trace_path = "trace.json";
+
+    FlightRecorder flight_recorder;
 };
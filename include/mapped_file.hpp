@@ -0,0 +1,30 @@
+#pragma once
+#include <filesystem>
+
+#include "common.hpp"
+
+// A whole file mapped read-only into memory, for as long as this lives: the
+// pages are read in by the OS when first touched (and shared with every
+// other process mapping the file), instead of copied up front.
+struct MappedFile {
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile();
+
+    bool Init(const std::filesystem::path& path);
+
+    // Done by `Init` and on destruction too.
+    void unmap();
+
+    const u8* data() const { return bytes; }
+    size_t size() const { return length; }
+
+private:
+    const u8* bytes = nullptr;
+    size_t length = 0;
+
+#ifdef _WIN32
+    void* mapping = nullptr;
+#endif
+};
@@ -1,37 +1,56 @@
 #pragma once
-#include <vector>
 #include <iostream>
+#include <cmath>
 #include <array>
+#include <utility>
 #include "common.hpp"
 
 struct Vector {
     f32 x, y;
 
-    Vector(f32 x, f32 y) : x(x), y(y) {}
-    Vector() : x(0), y(0) {}
+    constexpr Vector(f32 x, f32 y) : x(x), y(y) {}
+    constexpr Vector() : x(0), y(0) {}
 
-    Vector operator-(const Vector& rhs) const {
+    constexpr Vector operator-(const Vector& rhs) const {
         return Vector(x - rhs.x, y - rhs.y);
     }
 
-    Vector operator+(const Vector& rhs) const {
+    constexpr Vector operator+(const Vector& rhs) const {
         return Vector(x + rhs.x, y + rhs.y);
     }
 
-    Vector operator/(f32 rhs) const {
+    constexpr Vector operator/(f32 rhs) const {
         return Vector(x / rhs, y / rhs);
     }
 
-    Vector operator*(f32 rhs) const {
+    constexpr Vector operator*(f32 rhs) const {
         return Vector(x * rhs, y * rhs);
     }
 
-    void operator*=(f32 rhs) {
+    constexpr void operator*=(f32 rhs) {
         x *= rhs;
         y *= rhs;
     }
 };
 
+constexpr f32 dot(const Vector& a, const Vector& b) {
+    return a.x * b.x + a.y * b.y;
+}
+
+inline Vector lerp(const Vector& from, const Vector& to, f32 alpha) {
+    return from + (to - from) * alpha;
+}
+
+// Platform-free counterpart of D2D1_SIZE_F.
+struct SizeF {
+    f32 width, height;
+};
+
+// Platform-free counterpart of D2D1_RECT_F.
+struct RectF {
+    f32 left, top, right, bottom;
+};
+
 // If slope of AB is greater than slope of AC, then this three points are in clockwise order.
 inline bool clockwise(Vector a, Vector b, Vector c) {
     return (b.y - a.y) * (c.x - a.x) > (c.y - a.y) * (b.x - a.x);
@@ -44,42 +63,279 @@ inline bool intersect(const Vector& a, const Vector& b, const Vector& c, const V
     return clockwise(a, c, d) != clockwise(b, c, d) && clockwise(a, b, c) != clockwise(a, b, d);
 }
 
+// Convex part of a contour. `contour_gen` cuts every contour into such pieces
+// at build time and stores, for every edge, its outward normal together with
+// the projection of the whole piece onto it, so at runtime only the other
+// piece has to be projected.
+//
+// All pieces of a contour have the same number of vertices `V`, so every loop
+// over them has a trip count known at compile time. Smaller pieces repeat
+// their last vertex and axis, which changes none of the projections.
+template<size_t V>
+struct ConvexPiece {
+    struct Axis {
+        Vector normal;
+        f32 min, max;
+    };
+
+    std::array<Vector, V> vertices;
+    std::array<Axis, V> axes;
+
+    // Bounding box, in the same coordinates as `vertices`.
+    Vector box_min, box_max;
+};
+
+// Edges of a contour as coordinate columns (edge i goes from (ax[i], ay[i]) to
+// (bx[i], by[i])), padded to a multiple of EDGE_BATCH with zero-length edges,
+// which never cross anything. Consumed by the SIMD kernels in
+// `segment_kernel.hpp`.
+constexpr size_t EDGE_BATCH = 8;
+
+template<size_t N>
+struct EdgeSoA {
+    static_assert(N % EDGE_BATCH == 0);
+
+    std::array<f32, N> ax, ay, bx, by;
+};
+
 // Class for storing approximated objects in a form of polygons (convex or not,
-// doesn't matter) for the purpose of collision detection.
+// doesn't matter) for the purpose of collision detection. The sizes are
+// template parameters, so the generated contours in `spirits_gen.hpp` are
+// constant data and every test below is compiled separately for each pair of
+// sprites, with all its loops unrolled.
+template<size_t Vertices, size_t PieceVertices, size_t Pieces>
 struct ObjectContour {
-    std::vector<Vector> vertices;
+    static constexpr size_t EDGES = (Vertices + EDGE_BATCH - 1) / EDGE_BATCH * EDGE_BATCH;
+
+    std::array<Vector, Vertices> vertices;
 
     // A size of the half of "outer rectangle" of the object
     Vector half_of_sides;
+
+    // The edges of `vertices`, wrapped around and padded; the first
+    // `Vertices` of them are the real ones.
+    EdgeSoA<EDGES> edges;
+
+    // The same polygon as `vertices`, split into convex pieces.
+    std::array<ConvexPiece<PieceVertices>, Pieces> pieces;
 };
 
+// Is `other`, moved by `offset`, overlapping `piece` on every axis of `piece`?
+template<size_t V, size_t W>
+inline bool overlap_on_axes(const ConvexPiece<V>& piece, const ConvexPiece<W>& other,
+                            const Vector& offset) {
+    for (const auto& axis : piece.axes) {
+        f32 lo = INFINITY, hi = -INFINITY;
+
+        for (const auto& v : other.vertices) {
+            const f32 projection = dot(v, axis.normal);
+            lo = projection < lo ? projection : lo;
+            hi = projection > hi ? projection : hi;
+        }
+
+        const f32 shift = dot(offset, axis.normal);
+
+        if (hi + shift < axis.min || lo + shift > axis.max)
+            return false;
+    }
+
+    return true;
+}
+
+// Separating axis test of two convex pieces, `rhs` being moved by `offset`
+// relative to `lhs`. Unlike edge crossing, it also catches one piece lying
+// entirely inside the other.
+template<size_t V, size_t W>
+inline bool intersect(const ConvexPiece<V>& lhs, const ConvexPiece<W>& rhs, const Vector& offset) {
+    if (rhs.box_max.x + offset.x < lhs.box_min.x || rhs.box_min.x + offset.x > lhs.box_max.x ||
+        rhs.box_max.y + offset.y < lhs.box_min.y || rhs.box_min.y + offset.y > lhs.box_max.y) {
+        return false;
+    }
+
+    return overlap_on_axes(lhs, rhs, offset) && overlap_on_axes(rhs, lhs, offset * -1.f);
+}
+
+inline bool outer_rectangles_apart(const Vector& lhs_half_of_sides, const Vector& rhs_half_of_sides,
+                                   const Vector& distance) {
+    bool safe_distance_on_x = fabsf(distance.x) > lhs_half_of_sides.x + rhs_half_of_sides.x;
+
+    if (safe_distance_on_x)
+        return true;
+
+    bool safe_distance_on_y = fabsf(distance.y) > lhs_half_of_sides.y + rhs_half_of_sides.y;
+
+    return safe_distance_on_y;
+}
+
 // Check if the collision may occur by comparing distance of the objects to
-// their size. If so, then check every edge pair for collision.
-//
-// The main advantage of this algorithms in comparison to SAT is it's
-// simplicity, so it is easy to implement it at 2 AM.
-inline bool intersect(const ObjectContour& lhs, const ObjectContour& rhs,
-                      const Vector& lhs_center, const Vector& rhs_center) {
+// their size. If so, run the separating axis test on every pair of convex
+// pieces until one of them overlaps. Pairs decided by the sizes alone are
+// added to `bbox_rejects`.
+template<size_t N, size_t V, size_t P, size_t M, size_t W, size_t Q>
+inline bool intersect(const ObjectContour<N, V, P>& lhs, const ObjectContour<M, W, Q>& rhs,
+                      const Vector& lhs_center, const Vector& rhs_center,
+                      u64* bbox_rejects = nullptr) {
     Vector distance = rhs_center - lhs_center;
 
-    bool safe_distance_on_x = fabsf(distance.x) > lhs.half_of_sides.x + rhs.half_of_sides.x;
+    if (outer_rectangles_apart(lhs.half_of_sides, rhs.half_of_sides, distance)) {
+        if (bbox_rejects)
+            ++*bbox_rejects;
 
-    if (safe_distance_on_x)
         return false;
+    }
+
+    for (const auto& lhs_piece : lhs.pieces) {
+        for (const auto& rhs_piece : rhs.pieces) {
+            if (intersect(lhs_piece, rhs_piece, distance))
+                return true;
+        }
+    }
 
-    bool safe_distance_on_y = fabsf(distance.y) > lhs.half_of_sides.y + rhs.half_of_sides.y;
+    return false;
+}
+
+// Narrows [t_enter, t_exit] down to the times at which `other`, moved by
+// `offset + t * motion`, overlaps `piece` on every axis of `piece`.
+template<size_t V, size_t W>
+inline bool sweep_on_axes(const ConvexPiece<V>& piece, const ConvexPiece<W>& other,
+                          const Vector& offset, const Vector& motion,
+                          f32& t_enter, f32& t_exit) {
+    for (const auto& axis : piece.axes) {
+        f32 lo = INFINITY, hi = -INFINITY;
+
+        for (const auto& v : other.vertices) {
+            const f32 projection = dot(v, axis.normal);
+            lo = projection < lo ? projection : lo;
+            hi = projection > hi ? projection : hi;
+        }
+
+        const f32 shift = dot(offset, axis.normal);
+        const f32 speed = dot(motion, axis.normal);
+
+        lo += shift;
+        hi += shift;
+
+        if (speed == 0.f) {
+            if (hi < axis.min || lo > axis.max)
+                return false;
+
+            continue;
+        }
+
+        // The projections touch from t0 (other's leading side reaches the
+        // piece) until t1 (its trailing side leaves it).
+        f32 t0 = (axis.min - hi) / speed;
+        f32 t1 = (axis.max - lo) / speed;
+
+        if (speed < 0.f)
+            std::swap(t0, t1);
+
+        t_enter = t0 > t_enter ? t0 : t_enter;
+        t_exit = t1 < t_exit ? t1 : t_exit;
+
+        if (t_enter > t_exit)
+            return false;
+    }
+
+    return true;
+}
+
+// Swept separating axis test: `rhs` moves from `offset` to `offset + motion`
+// relative to `lhs` during one step. Moving by a constant vector, the pieces
+// touch exactly when their Minkowski difference contains the offset, and the
+// edges of that difference have the normals of both pieces, so the per-axis
+// time intervals intersect to the exact contact interval. `toi` is its start,
+// as a fraction of the step.
+template<size_t V, size_t W>
+inline bool sweep(const ConvexPiece<V>& lhs, const ConvexPiece<W>& rhs,
+                  const Vector& offset, const Vector& motion, f32& toi) {
+    const Vector end = offset + motion;
+
+    const f32 min_x = offset.x < end.x ? offset.x : end.x;
+    const f32 max_x = offset.x < end.x ? end.x : offset.x;
+    const f32 min_y = offset.y < end.y ? offset.y : end.y;
+    const f32 max_y = offset.y < end.y ? end.y : offset.y;
+
+    if (rhs.box_max.x + max_x < lhs.box_min.x || rhs.box_min.x + min_x > lhs.box_max.x ||
+        rhs.box_max.y + max_y < lhs.box_min.y || rhs.box_min.y + min_y > lhs.box_max.y) {
+        return false;
+    }
+
+    f32 t_enter = 0.f, t_exit = 1.f;
+
+    if (!sweep_on_axes(lhs, rhs, offset, motion, t_enter, t_exit) ||
+        !sweep_on_axes(rhs, lhs, offset * -1.f, motion * -1.f, t_enter, t_exit)) {
+        return false;
+    }
+
+    toi = t_enter;
+    return true;
+}
+
+// Both ends of a motion from `start` to `end` (of one center relative to the
+// other) past the same side of the outer rectangles, `reach` being the sum of
+// their half sides.
+inline bool swept_rectangles_apart(const Vector& reach, const Vector& start, const Vector& end) {
+    return (start.x > reach.x && end.x > reach.x) || (start.x < -reach.x && end.x < -reach.x) ||
+           (start.y > reach.y && end.y > reach.y) || (start.y < -reach.y && end.y < -reach.y);
+}
+
+// Swept counterpart of `intersect`: `rhs` ends the step at `rhs_center` after
+// moving by `rhs_motion` relative to `lhs`, and so cannot tunnel through it
+// however long the step is. `toi` is the earliest contact over all pieces.
+template<size_t N, size_t V, size_t P, size_t M, size_t W, size_t Q>
+inline bool sweep(const ObjectContour<N, V, P>& lhs, const ObjectContour<M, W, Q>& rhs,
+                  const Vector& lhs_center, const Vector& rhs_center,
+                  const Vector& rhs_motion, f32& toi, u64* bbox_rejects = nullptr) {
+    const Vector end = rhs_center - lhs_center;
+    const Vector start = end - rhs_motion;
+    const Vector reach = lhs.half_of_sides + rhs.half_of_sides;
+
+    if (swept_rectangles_apart(reach, start, end)) {
+        if (bbox_rejects)
+            ++*bbox_rejects;
+
+        return false;
+    }
+
+    bool hit = false;
+    toi = 1.f;
+
+    for (const auto& lhs_piece : lhs.pieces) {
+        for (const auto& rhs_piece : rhs.pieces) {
+            f32 piece_toi;
+
+            if (sweep(lhs_piece, rhs_piece, start, rhs_motion, piece_toi) && piece_toi <= toi) {
+                toi = piece_toi;
+                hit = true;
+            }
+        }
+    }
+
+    return hit;
+}
+
+// The original narrowphase: check every edge pair for crossing. It misses one
+// contour lying entirely inside the other and is kept only as a reference.
+//
+// The main advantage of this algorithms in comparison to SAT is it's
+// simplicity, so it is easy to implement it at 2 AM.
+template<size_t N, size_t V, size_t P, size_t M, size_t W, size_t Q>
+inline bool intersect_edges(const ObjectContour<N, V, P>& lhs, const ObjectContour<M, W, Q>& rhs,
+                            const Vector& lhs_center, const Vector& rhs_center) {
+    Vector distance = rhs_center - lhs_center;
 
-    if (safe_distance_on_y)
+    if (outer_rectangles_apart(lhs.half_of_sides, rhs.half_of_sides, distance))
         return false;
 
     // Maybe there is an intersection (maybe not). Check every edge pair.
-    for (size_t i = 0; i < lhs.vertices.size(); ++i) {
-        const Vector& a = lhs.vertices[i] - distance;
-        const Vector& b = lhs.vertices[i + 1 < lhs.vertices.size() ? i + 1 : 0] - distance;
+    for (size_t i = 0; i < N; ++i) {
+        const Vector a = Vector(lhs.edges.ax[i], lhs.edges.ay[i]) - distance;
+        const Vector b = Vector(lhs.edges.bx[i], lhs.edges.by[i]) - distance;
 
-        for (size_t j = 0; j < rhs.vertices.size(); ++j) {
-            const Vector& c = rhs.vertices[j];
-            const Vector& d = rhs.vertices[j + 1 < rhs.vertices.size() ? j + 1 : 0];
+        for (size_t j = 0; j < M; ++j) {
+            const Vector c(rhs.edges.ax[j], rhs.edges.ay[j]);
+            const Vector d(rhs.edges.bx[j], rhs.edges.by[j]);
 
             if (intersect(a, b, c, d))
                 return true;
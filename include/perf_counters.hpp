@@ -0,0 +1,63 @@
+#pragma once
+#include <array>
+
+#include "common.hpp"
+#include "frame_profiler.hpp"
+
+// What the CPU did during each phase of a tick, from its performance
+// monitoring counters: whether a phase is slow for the cache misses, the
+// branch misses or the sheer instructions. Linux only (perf_event_open),
+// and only where the kernel lets a process count its own user space
+// (perf_event_paranoid 2 and below) on a CPU, or VM, that has the counters.
+//
+// The counters follow the thread that opens them, so they only make sense on
+// `PhaseTimes` used by that one thread: the serial tick, not the task graph.
+// Every phase boundary reads them all with one system call, which is far
+// more than the phases of a small tick take; the counts are of user space
+// only, so the call itself barely shows in them, but the time does.
+
+enum PerfEvent : u32 {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_L1D_MISSES,    // L1 data cache read misses
+    PERF_LLC_MISSES,    // last level cache read misses
+    PERF_BRANCH_MISSES,
+    PERF_EVENT_COUNT,
+};
+
+const char* perf_event_name(PerfEvent event);
+
+struct PerfCounters {
+    // Opens the counters for the calling thread. False when none of them can
+    // be opened; those that can are counted even if some cannot.
+    bool Init();
+
+    // Whether `event` is counted; the others stay at 0.
+    bool has(PerfEvent event) const { return fds[event] >= 0; }
+
+    // Where the next phase starts from.
+    void start();
+
+    // Adds the counts since `start` or the last `add` to `phase`.
+    void add(FramePhase phase);
+
+    void clear();
+
+    PerfCounters() = default;
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    ~PerfCounters();
+
+    // The counts of every phase, indexed by `PerfEvent`.
+    std::array<std::array<u64, PERF_EVENT_COUNT>, PHASE_COUNT> phases {};
+
+private:
+    bool read(std::array<u64, PERF_EVENT_COUNT>& values) const;
+
+    // The first counter opened leads the group; all are read through it.
+    std::array<int, PERF_EVENT_COUNT> fds { -1, -1, -1, -1, -1 };
+    int leader = -1;
+
+    std::array<u64, PERF_EVENT_COUNT> mark {};
+};
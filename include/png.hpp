@@ -0,0 +1,52 @@
+#pragma once
+#include <vector>
+#include <filesystem>
+
+#include "common.hpp"
+
+// Decoded image: 8-bit RGBA with straight (not premultiplied) alpha, rows top
+// to bottom, `width * 4` bytes each.
+struct Image {
+    u32 width = 0;
+    u32 height = 0;
+    std::vector<u8> pixels;
+
+    const u8* pixel(u32 x, u32 y) const { return pixels.data() + (size_t(y) * width + x) * 4; }
+};
+
+// Decoded image ready to draw: premultiplied BGRA, one `u32` per pixel with
+// blue in the lowest byte (the 32bppPBGRA layout of Direct2D bitmaps, and
+// what the software renderer blends); rows top to bottom, no padding.
+struct Sprite {
+    u32 width = 0;
+    u32 height = 0;
+    std::vector<u32> pixels;
+
+    const u32* row(u32 y) const { return pixels.data() + size_t(y) * width; }
+};
+
+// Decompresses a zlib stream (RFC 1950/1951), appending to `out`. Fails as
+// soon as the stream would append more than `max_size` bytes.
+bool inflate_zlib(const u8* data, size_t size, std::vector<u8>& out,
+                  size_t max_size = SIZE_MAX);
+
+// Decodes a non-interlaced PNG with 8 bits per channel: grayscale, RGB,
+// palette, grayscale with alpha or RGBA. No dependency beyond the standard
+// library, so the build tools can use it on every platform.
+//
+// Rows are unfiltered and converted one at a time, with the SIMD kernels of
+// `png_kernel.hpp`, while they are still in cache.
+bool decode_png(const u8* data, size_t size, Image& image);
+
+// The same, premultiplied on the fly.
+bool decode_png(const u8* data, size_t size, Sprite& sprite);
+
+bool load_png(const std::filesystem::path& path, Image& image);
+bool load_png(const std::filesystem::path& path, Sprite& sprite);
+
+// Encodes an RGBA image as a PNG that any viewer opens, quickly and without
+// compression. Every row gets `filter` (see `png_kernel.hpp`); none by
+// default.
+bool encode_png(const Image& image, std::vector<u8>& out, u8 filter = 0);
+
+bool save_png(const std::filesystem::path& path, const Image& image);
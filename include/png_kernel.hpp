@@ -0,0 +1,51 @@
+#pragma once
+#include <cstddef>
+#include <cstdlib>
+
+#include "common.hpp"
+
+// The per-row steps of PNG decoding that touch every byte: undoing the row
+// filters, and turning straight RGBA into premultiplied BGRA (one `u32` per
+// pixel, blue in the lowest byte). The implementation (AVX2, SSE2 or scalar)
+// is picked at startup from what the CPU supports; all of them produce the
+// same bytes.
+//
+// Up is vectorized for any pixel size. Sub, Average and Paeth depend on the
+// pixel to the left, so their vector versions work a pixel at a time, and
+// only for 4 bytes per pixel (RGBA), the format of every asset.
+
+enum PngFilter : u8 {
+    FILTER_NONE = 0,
+    FILTER_SUB = 1,
+    FILTER_UP = 2,
+    FILTER_AVERAGE = 3,
+    FILTER_PAETH = 4,
+};
+
+// The Paeth predictor: whichever of left, above and upper left is closest to
+// left + above - upper left, preferring them in that order on ties.
+inline u8 paeth_predictor(u8 a, u8 b, u8 c) {
+    const i32 p = i32(a) + i32(b) - i32(c);
+    const i32 pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+
+    if (pa <= pb && pa <= pc)
+        return a;
+
+    return pb <= pc ? b : c;
+}
+
+// Undoes `filter` on the `stride` bytes of `line`, in place; `prev` is the
+// row above, already unfiltered (zeros for the first row), and `bpp` the
+// bytes per pixel. `filter` must be one of PngFilter.
+void unfilter_row(PngFilter filter, u8* line, const u8* prev, size_t stride, u32 bpp);
+
+// Premultiplies `count` straight RGBA pixels into BGRA ones, every channel
+// times alpha / 255 rounded to nearest.
+void premultiply_row(u32* dst, const u8* rgba, size_t count);
+
+// Name of the implementation in use ("avx2", "sse2" or "scalar").
+const char* png_kernel_name();
+
+// Forces one of the implementations, e.g. to compare them. Fails if the CPU
+// does not support it.
+bool select_png_kernel(const char* name);
@@ -0,0 +1,131 @@
+#pragma once
+#include <span>
+#include <vector>
+
+#include "common.hpp"
+#include "math.hpp"
+
+struct Game;
+struct EntityPool;
+
+// Platform-free counterpart of D2D1_COLOR_F (straight alpha).
+struct ColorF {
+    f32 r, g, b, a;
+};
+
+// Colors of the background gradients: `side` at the left and right edges,
+// `middle` in the middle of the screen.
+struct GradientColors {
+    ColorF side;
+    ColorF middle;
+};
+
+namespace Palette {
+    constexpr ColorF REFERENCE_BG { 0.10f - 0.075f, 0.10f - 0.075f, 0.20f - 0.075f, 1.f };
+
+    // Fades in with the penalty, outside the safe zone.
+    constexpr GradientColors RED_GRADIENT {
+        { 1.f, REFERENCE_BG.g, REFERENCE_BG.b, 1.f },
+        REFERENCE_BG,
+    };
+
+    // Fades in with `Game::paint_blue`, right after a level starts.
+    constexpr GradientColors BLUE_GRADIENT {
+        REFERENCE_BG,
+        { REFERENCE_BG.r, REFERENCE_BG.g, REFERENCE_BG.b + 0.3f, 1.f },
+    };
+
+    constexpr ColorF TEXT_PINK { 1.f, 0.6f, 0.6f, 1.f };
+    constexpr ColorF TEXT_GREEN { 0.6f, 1.f, 0.6f, 1.f };
+    constexpr ColorF TEXT_WHITE { 1.f, 1.f, 1.f, 1.f };
+    constexpr ColorF TEXT_YELLOW { 1.f, 1.f, 0.f, 1.f };
+}
+
+// One sprite of a batch, centered on `center` and `scale` times its painted
+// size.
+struct SpriteInstance {
+    Vector center;
+    f32 scale;
+    f32 opacity;
+};
+
+// What a frame is made of, whatever paints it: the windowed game implements
+// it with Direct2D, `SoftRenderer` on the CPU into a memory framebuffer. The
+// frame itself (clearing, presenting) is up to the backend; `ScenePainter`
+// issues the calls in between.
+struct Renderer {
+    enum SpriteKind {
+        SPRITE_CONTROLLER,
+        SPRITE_ASTEROID,
+        SPRITE_BULLET,
+        // Gradients as large as the frame.
+        SPRITE_RED_BACKGROUND,
+        SPRITE_BLUE_BACKGROUND,
+        SPRITE_COUNT,
+    };
+
+    virtual ~Renderer() = default;
+
+    virtual SizeF frame_size() const = 0;
+
+    // Painted size of a sprite, i.e. its bitmap scaled by `SpiritData::scale`.
+    virtual SizeF sprite_size(SpriteKind sprite) const = 0;
+
+    // Stretches the sprite over `rect`, painted over what is already there.
+    virtual void draw_sprite(SpriteKind sprite, const RectF& rect, f32 opacity) = 0;
+
+    // Many instances of one sprite in a single call, painted in order.
+    virtual void draw_sprites(SpriteKind sprite, std::span<const SpriteInstance> instances) = 0;
+
+    // The texts of the HUD, as laid out by `TextHelper`.
+    virtual void draw_next_text(const wchar_t* text, size_t len) = 0;
+    virtual void draw_chosen_level(i32 level, f32 opacity) = 0;
+    virtual void draw_game_over(f32 opacity) = 0;
+    virtual void draw_penalty(f32 opacity, i32 penalty) = 0;
+    virtual void draw_data(i32 score, u32 difficulty) = 0;
+
+#ifdef PAINT_CONTOUR_DBG
+    virtual void draw_contour_dbg(std::span<const Vector>, const Vector&) {}
+#endif // PAINT_CONTOUR_DBG
+};
+
+// Paints the state of a game through a `Renderer`, `alpha` of the way from
+// the previous tick to the last one.
+//
+// BATCHED gathers the asteroids and the bullets into one instance buffer per
+// sprite and hands each buffer over in a single `draw_sprites`. PER_SPRITE
+// makes one `draw_sprite` call per entity, as the game always did, and is
+// kept as the reference; both paint the same frame.
+struct ScenePainter {
+    enum SubmissionKind {
+        SUBMISSION_BATCHED,
+        SUBMISSION_PER_SPRITE,
+    } submission = SUBMISSION_BATCHED;
+
+    void paint(Renderer& renderer, const Game& game, f32 alpha);
+
+private:
+    void paint_controller(Renderer& renderer, const Game& game, f32 alpha);
+    void paint_asteroids(Renderer& renderer, const Game& game, f32 alpha);
+    void paint_bullets(Renderer& renderer, const Game& game, f32 alpha);
+
+    template<typename Spirit>
+    void paint_entities(Renderer& renderer, const EntityPool& pool, Renderer::SpriteKind sprite,
+                        const Spirit& spirit, f32 alpha);
+
+    // Reused from frame to frame, so a frame allocates nothing.
+    std::vector<SpriteInstance> instances;
+};
+
+// Where an instance is painted, given the painted size of its sprite.
+inline RectF instance_rect(const SpriteInstance& instance, const SizeF& size) {
+    const f32 hlfw_x = size.width / 2 * instance.scale;
+    const f32 hlfw_y = size.height / 2 * instance.scale;
+
+    return {
+        instance.center.x - hlfw_x,
+        instance.center.y - hlfw_y,
+        instance.center.x + hlfw_x,
+        instance.center.y + hlfw_y,
+    };
+}
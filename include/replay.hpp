@@ -0,0 +1,97 @@
+#pragma once
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include "common.hpp"
+#include "math.hpp"
+#include "game.hpp"
+
+// A recorded session: everything needed to start the same game plus the input
+// of every single tick. With a fixed tick rate this is enough to replay the
+// session bit for bit.
+//
+// File layout (all integers are LEB128 varints):
+//
+//   "ASRP" version seed tick_rate start_level width_bits height_bits narrowphase
+//   run* 0
+//
+// where every run is `(ticks << INPUT_BITS) | input_mask` for `ticks`
+// consecutive ticks with the same input. Holding a key for a second costs a
+// couple of bytes. A file cut short (e.g. by a crash) is valid up to the last
+// complete run.
+
+struct ReplayHeader {
+    u32 seed = 0;
+    u32 tick_rate = Game::DEFAULT_TICK_RATE;
+
+    // Level passed to `Game::start_level` before the first tick, 0 when the
+    // game was started right away.
+    i32 start_level = 0;
+
+    SizeF size { 0, 0 };
+
+    // Collisions resolved by different narrowphases differ now and then, so
+    // the replay must use the one it was recorded with.
+    Game::NarrowphaseKind narrowphase = Game::NARROWPHASE_SWEPT;
+};
+
+constexpr u32 INPUT_BITS = 6;
+
+// left, right, space in the lowest bits, then the chosen level (0-6).
+inline u8 pack_input(const Input& input) {
+    return u8((input.left ? 1 : 0) | (input.right ? 2 : 0) | (input.space ? 4 : 0) |
+              (u32(input.level) & 7) << 3);
+}
+
+inline Input unpack_input(u8 mask) {
+    return Input {
+        .left = !!(mask & 1),
+        .right = !!(mask & 2),
+        .space = !!(mask & 4),
+        .level = i32(mask >> 3 & 7),
+    };
+}
+
+struct ReplayWriter {
+    bool Init(const std::filesystem::path& path, const ReplayHeader& header);
+
+    // Appends the input of the next tick.
+    bool record(const Input& input);
+
+    // Writes the pending run and the end marker.
+    bool Finish();
+
+    ~ReplayWriter();
+
+private:
+    void put_varint(u64 value);
+    bool flush_run();
+    bool flush_buffer();
+
+    std::ofstream file;
+    std::vector<u8> buffer;
+
+    u8 run_mask = 0;
+    u64 run_ticks = 0;
+    bool finished = true;
+};
+
+struct ReplayReader {
+    bool Init(const std::filesystem::path& path);
+
+    const ReplayHeader& get_header() const { return header; }
+
+    // Input of the next tick; false when the recording is over, or at the
+    // first malformed run.
+    bool next(Input& input);
+
+private:
+    bool get_varint(u64& value);
+
+    std::ifstream file;
+    ReplayHeader header;
+
+    u8 run_mask = 0;
+    u64 run_ticks = 0;
+};
@@ -0,0 +1,66 @@
+#pragma once
+#include "common.hpp"
+#include "math.hpp"
+
+// Batched version of the edge crossing test: one edge of a contour against all
+// edges of the other one at once. The implementation (AVX2, SSE2 or scalar) is
+// picked at startup from what the CPU supports; all of them compute exactly
+// the same products as `clockwise`, so they agree bit for bit with the scalar
+// `intersect_edges`.
+
+// The columns of an `EdgeSoA` of any size; `count` is a multiple of EDGE_BATCH.
+struct EdgeColumns {
+    const f32* ax;
+    const f32* ay;
+    const f32* bx;
+    const f32* by;
+    size_t count;
+
+    template<size_t N>
+    EdgeColumns(const EdgeSoA<N>& edges)
+        : ax(edges.ax.data()), ay(edges.ay.data()), bx(edges.bx.data()), by(edges.by.data())
+        , count(N) {}
+};
+
+// Does segment ab cross any edge in `edges`?
+bool intersect_any(const Vector& a, const Vector& b, const EdgeColumns& edges);
+
+// Name of the implementation in use ("avx2", "sse2" or "scalar").
+const char* segment_kernel_name();
+
+// Forces one of the implementations, e.g. to compare them. Fails if the CPU
+// does not support it.
+bool select_segment_kernel(const char* name);
+
+// Same result as `intersect_edges`, with the inner loop vectorized. Counts a
+// pair decided by the outer rectangles in `bbox_rejects`, and adds the segment
+// against edge tests it runs (whole batches) to `segment_tests`.
+template<size_t N, size_t V, size_t P, size_t M, size_t W, size_t Q>
+inline bool intersect_edges_batched(const ObjectContour<N, V, P>& lhs,
+                                    const ObjectContour<M, W, Q>& rhs,
+                                    const Vector& lhs_center, const Vector& rhs_center,
+                                    u64* bbox_rejects = nullptr, u64* segment_tests = nullptr) {
+    Vector distance = rhs_center - lhs_center;
+
+    if (outer_rectangles_apart(lhs.half_of_sides, rhs.half_of_sides, distance)) {
+        if (bbox_rejects)
+            ++*bbox_rejects;
+
+        return false;
+    }
+
+    const EdgeColumns rhs_edges(rhs.edges);
+
+    for (size_t i = 0; i < N; ++i) {
+        const Vector a = Vector(lhs.edges.ax[i], lhs.edges.ay[i]) - distance;
+        const Vector b = Vector(lhs.edges.bx[i], lhs.edges.by[i]) - distance;
+
+        if (segment_tests)
+            *segment_tests += rhs_edges.count;
+
+        if (intersect_any(a, b, rhs_edges))
+            return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,144 @@
+#pragma once
+#include <array>
+#include <vector>
+#include <string>
+#include <filesystem>
+
+#include "common.hpp"
+#include "math.hpp"
+#include "png.hpp"
+#include "sprite_atlas.hpp"
+#include "asset_pack.hpp"
+#include "renderer.hpp"
+#include "blend_kernel.hpp"
+#include "job_system.hpp"
+
+struct Framebuffer {
+    u32 width = 0;
+    u32 height = 0;
+    std::vector<u32> pixels;
+
+    u32* row(u32 y) { return pixels.data() + size_t(y) * width; }
+    const u32* row(u32 y) const { return pixels.data() + size_t(y) * width; }
+};
+
+// Whole pixels [left, right) x [top, bottom).
+struct PixelRect {
+    i32 left, top, right, bottom;
+};
+
+// One sprite stretched over `rect`. When the sizes match, which they do for
+// everything but text and debris between two mip levels, rows are blended as
+// they are; otherwise every pixel takes the source pixel under its center.
+struct DrawCommand {
+    const SpriteView* sprite;
+    PixelRect rect;
+    Modulate modulate;
+};
+
+// Blends the part of `command` inside `clip` (which must lie within the
+// framebuffer) into `framebuffer`. `scratch` holds the stretched rows.
+void composite(Framebuffer& framebuffer, const DrawCommand& command, const PixelRect& clip,
+               std::vector<u32>& scratch);
+
+// Paints frames on the CPU, on any platform: the calls of a frame are
+// recorded as draw commands between `begin_frame` and `end_frame`, which
+// composites them in order over a black framebuffer with `blend_row`. Text is
+// drawn with a built-in 5x8 pixel font instead of DirectWrite, without the
+// glow. The sprites come from a `SpriteAtlas` at one pixel per DIP, mapped
+// from the asset pack when there is one, the glyphs from another; the
+// gradients, as large as the frame, are kept on their own.
+//
+// `end_frame` splits the frame into TILE_WIDTH x TILE_HEIGHT tiles and bins every command
+// into the tiles it covers, keeping the order. Each tile is then cleared and
+// composited on its own, clipped to the tile, so the tiles can go to
+// different threads without any lock: no two of them share a pixel. Every
+// pixel sees the same commands in the same order however the frame is
+// split, so the frame is the same, byte for byte, on any number of threads.
+struct SoftRenderer final : Renderer {
+    static constexpr u32 TILE_WIDTH = 128;
+    static constexpr u32 TILE_HEIGHT = 32;
+
+    // Maps the sprites from ASSET_PACK_PATH, or decodes them from the paths
+    // in `Spirits` without it, relative to `root`.
+    bool Init(const std::filesystem::path& root, u32 width, u32 height);
+
+    // Whether the sprites came from the asset pack.
+    bool sprites_packed() const { return packed; }
+
+    void begin_frame();
+    void end_frame();
+
+    const Framebuffer& get_framebuffer() const { return framebuffer; }
+    const std::vector<DrawCommand>& get_commands() const { return commands; }
+
+    // When set, `end_frame` composites the tiles on these threads, and
+    // `Init` decodes the sprites on them.
+    JobSystem* jobs = nullptr;
+
+    // Writes the last frame as a PNG.
+    bool dump(const std::filesystem::path& path) const;
+
+    SizeF frame_size() const override;
+    SizeF sprite_size(SpriteKind sprite) const override;
+    void draw_sprite(SpriteKind sprite, const RectF& rect, f32 opacity) override;
+    void draw_sprites(SpriteKind sprite, std::span<const SpriteInstance> instances) override;
+
+    void draw_next_text(const wchar_t* text, size_t len) override;
+    void draw_chosen_level(i32 level, f32 opacity) override;
+    void draw_game_over(f32 opacity) override;
+    void draw_penalty(f32 opacity, i32 penalty) override;
+    void draw_data(i32 score, u32 difficulty) override;
+
+    static constexpr wchar_t FIRST_GLYPH = L' ';
+    static constexpr wchar_t LAST_GLYPH = L'~';
+
+private:
+    enum Align {
+        ALIGN_LEADING,
+        ALIGN_CENTER,
+        ALIGN_TRAILING,
+    };
+
+    // `x` is the left edge, the center or the right edge of the text.
+    void draw_text(const wchar_t* text, size_t len, f32 x, f32 top, f32 font_size, Align align,
+                   const ColorF& color, f32 opacity);
+
+    void draw_text(const std::wstring& text, f32 x, f32 top, f32 font_size, Align align,
+                   const ColorF& color, f32 opacity) {
+        draw_text(text.data(), text.size(), x, top, font_size, align, color, opacity);
+    }
+
+    void create_gradient(const GradientColors& colors, Sprite& sprite) const;
+
+    // The level of `sprite` to stretch over `rect`.
+    const SpriteView* level_view(SpriteKind sprite, const PixelRect& rect) const;
+
+    void bin_commands();
+    void composite_tile(u32 tile, std::vector<u32>& scratch);
+
+    AssetPack pack;
+    bool packed = false;
+
+    SpriteAtlas atlas;
+    SpiritSprites spirits;
+    SpriteAtlas font;
+    std::array<Sprite, 2> backgrounds;
+
+    // Every level of every sprite, the largest first.
+    std::array<std::vector<SpriteView>, SPRITE_COUNT> levels;
+    std::array<SizeF, SPRITE_COUNT> sizes;
+    std::array<SpriteView, LAST_GLYPH - FIRST_GLYPH + 1> glyphs;
+
+    std::vector<DrawCommand> commands;
+    Framebuffer framebuffer;
+
+    // Tiles in rows of `tiles_x`; `bins[tile]` lists the indices in
+    // `commands` of what covers the tile, in order.
+    u32 tiles_x = 0;
+    u32 tiles_y = 0;
+    std::vector<std::vector<u32>> bins;
+
+    // Stretched rows, one buffer per task.
+    std::vector<std::vector<u32>> scratch;
+};
@@ -0,0 +1,129 @@
+#pragma once
+#include <array>
+#include <vector>
+#include <span>
+#include <filesystem>
+
+#include "common.hpp"
+#include "math.hpp"
+#include "png.hpp"
+#include "job_system.hpp"
+
+// Pixels of a sprite kept elsewhere: rows are `stride` pixels apart.
+struct SpriteView {
+    const u32* pixels = nullptr;
+    u32 width = 0;
+    u32 height = 0;
+    u32 stride = 0;
+
+    const u32* row(u32 y) const { return pixels + size_t(y) * stride; }
+};
+
+inline SpriteView view_of(const Sprite& sprite) {
+    return { sprite.pixels.data(), sprite.width, sprite.height, sprite.width };
+}
+
+// Area-averages `source` into `width` x `height` pixels, which is what a
+// bitmap drawn smaller looks like; done once per sprite instead of per frame.
+void resample_sprite(const Sprite& source, u32 width, u32 height, Sprite& sprite);
+
+// Where a sprite sits in the atlas, in pixels.
+struct AtlasRegion {
+    u32 x = 0;
+    u32 y = 0;
+    u32 width = 0;
+    u32 height = 0;
+};
+
+// Every sprite, already scaled to the pixels it covers on the screen, with a
+// few smaller mip levels for when it is drawn shrunk, packed into one image:
+// one texture to upload and bind, and no frame ever reads more source pixels
+// than it paints. Sprites are queued with `add` and laid out by `pack`, in
+// shelves of decreasing height; a transparent gutter keeps linear filtering
+// from bleeding a neighbour in.
+struct SpriteAtlas {
+    using SpriteId = u32;
+
+    static constexpr u32 MAX_LEVELS = 4;
+    static constexpr u32 PADDING = 1;
+
+    // Copies would point at the pixels of the original.
+    SpriteAtlas() = default;
+    SpriteAtlas(const SpriteAtlas&) = delete;
+    SpriteAtlas& operator=(const SpriteAtlas&) = delete;
+    SpriteAtlas(SpriteAtlas&&) = default;
+    SpriteAtlas& operator=(SpriteAtlas&&) = default;
+
+    // Queues `source` resampled to `width` x `height`, followed by `levels - 1`
+    // levels of half the size of the one before.
+    SpriteId add(const Sprite& source, u32 width, u32 height, u32 levels);
+
+    // `add` in two steps, so that sprites can be resampled on any thread:
+    // the levels `add` would queue, then queuing them.
+    static void make_levels(const Sprite& source, u32 width, u32 height, u32 levels,
+                            std::vector<Sprite>& resampled);
+    SpriteId add_levels(std::vector<Sprite> levels);
+
+    void pack();
+
+    // Takes an atlas packed before, e.g. read from an asset pack, instead of
+    // packing: `sprites[id][level]` are the regions, and `pixels`, used in
+    // place, must outlive the atlas.
+    void assign(u32 width, u32 height, const u32* pixels,
+                std::vector<std::vector<AtlasRegion>> sprites);
+
+    u32 level_count(SpriteId sprite) const { return u32(sprites[sprite].size()); }
+    const AtlasRegion& region(SpriteId sprite, u32 level) const { return sprites[sprite][level]; }
+
+    // The smallest level at least `width` x `height` pixels large, or the
+    // first one if none is: shrunk from above, never stretched up.
+    u32 level_for(SpriteId sprite, u32 width, u32 height) const;
+
+    // Valid once packed.
+    SpriteView view(SpriteId sprite, u32 level) const;
+
+    u32 sprite_count() const { return u32(sprites.size()); }
+
+    u32 get_width() const { return width; }
+    u32 get_height() const { return height; }
+
+    // `get_width()` pixels per row, no padding.
+    const u32* get_pixels() const { return pixels; }
+
+private:
+    u32 width = 0;
+    u32 height = 0;
+    const u32* pixels = nullptr;
+
+    // What `pixels` points to, unless assigned.
+    std::vector<u32> storage;
+
+    std::vector<std::vector<AtlasRegion>> sprites;
+
+    // The levels waiting for `pack`, in the order of `sprites`.
+    std::vector<std::vector<Sprite>> queued;
+};
+
+// The sprites of `Spirits` (the rocket, the asteroid and the bullet, in the
+// order of `Renderer::SpriteKind`), as placed in an atlas, with the size
+// they are painted at in DIPs.
+struct SpiritSprites {
+    static constexpr u32 COUNT = 3;
+
+    // The asteroids and bullets shrink down to nothing when they are hit.
+    static constexpr u32 MIP_LEVELS = 3;
+
+    std::array<SpriteAtlas::SpriteId, COUNT> ids;
+    std::array<SizeF, COUNT> sizes;
+};
+
+// Decodes the PNGs at `paths` into `sprites` (as many), several at once on
+// `jobs` when given; reports the first that fails.
+bool load_sprites(std::span<const std::filesystem::path> paths, std::span<Sprite> sprites,
+                  JobSystem* jobs = nullptr);
+
+// Loads the PNGs relative to `root` and adds them to `atlas`, scaled for a
+// screen of `pixels_per_dip` pixels per DIP; decoded and resampled on `jobs`
+// when given.
+bool add_spirit_sprites(const std::filesystem::path& root, f32 pixels_per_dip,
+                        SpriteAtlas& atlas, SpiritSprites& sprites, JobSystem* jobs = nullptr);
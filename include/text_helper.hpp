@@ -5,19 +5,6 @@
 #include <d2d1.h>
 #include <d2d1_1.h>
 
-
-struct TextTypewriterAnimation {
-    bool Init(const wchar_t* animation_text_);
-    bool is_frame_left();
-    void next_frame();
-
-    std::pair<const wchar_t*, size_t> get_text();
-
-private:
-    const wchar_t* animation_text;
-    size_t chars_progress;
-};
-
 struct TextHelper {
     TextHelper() {}
 
@@ -1,23 +1,31 @@
 #pragma once
-#include <iostream>
-#include <windows.h>
 #include "common.hpp"
 
+// Monotonic time source shared by the timers of one game. It never reads the
+// hardware by itself: the Windows build fills it from QueryPerformanceCounter
+// and the headless driver advances it by hand.
+struct Clock {
+    i64 frequency = 1'000; // ticks per second
+    i64 now = 0;
+};
+
+// Reads its clock only when handed one, so a copy of a timer (of a whole
+// game) keeps no reference to the original's clock.
 struct Timer {
-    bool Init(i64 interval_in_milliseconds) {
-        if (!QueryPerformanceFrequency((LARGE_INTEGER*) &frequency) ||
-            !QueryPerformanceCounter((LARGE_INTEGER*) &last_time)) {
+    bool Init(i64 interval_in_milliseconds, const Clock& clock) {
+        if (clock.frequency <= 0)
             return false;
-        }
 
+        last_time = clock.now;
         reference_time = last_time;
-        interval = (frequency * interval_in_milliseconds) / 1000;
+        interval = (clock.frequency * interval_in_milliseconds) / 1000;
 
-        return true;
+        return interval > 0;
     }
 
-    bool update() {
-        return QueryPerformanceCounter((LARGE_INTEGER*) &last_time);
+    bool update(const Clock& clock) {
+        last_time = clock.now;
+        return true;
     }
 
     // Returns [0, 1)
@@ -59,7 +67,62 @@ struct Timer {
 protected:
     i64 last_time;
     i64 reference_time;
-    i64 frequency;
     i64 interval;
 };
 
+// Accumulates real time from a clock and hands it out as whole ticks of a
+// fixed length. The remainder is kept for the next frame, so no time is lost;
+// only when a frame is so long that more than `max_ticks_per_frame` would be
+// due, the excess is dropped and the simulation slows down instead of
+// spiraling into ever longer catch-ups.
+struct FixedTimestep {
+    bool Init(u32 tick_rate_, u32 max_ticks_per_frame_, const Clock& clock_) {
+        clock = &clock_;
+        tick_rate = tick_rate_;
+        max_ticks_per_frame = max_ticks_per_frame_;
+
+        if (clock->frequency <= 0 || tick_rate == 0 || max_ticks_per_frame == 0)
+            return false;
+
+        last_time = clock->now;
+        accumulator = 0;
+
+        return true;
+    }
+
+    // Number of ticks due since the last call.
+    u32 advance() {
+        // Everything is scaled by the tick rate, so a tick is exactly
+        // `clock->frequency` units long and no rounding creeps in.
+        accumulator += (clock->now - last_time) * tick_rate;
+        last_time = clock->now;
+
+        i64 ticks = accumulator / clock->frequency;
+        accumulator -= ticks * clock->frequency;
+
+        if (ticks > max_ticks_per_frame) {
+            dropped_ticks += ticks - max_ticks_per_frame;
+            ticks = max_ticks_per_frame;
+        }
+
+        return u32(ticks);
+    }
+
+    // Fraction of the next tick that has already elapsed, [0, 1). Used to
+    // interpolate between the last two simulated states when painting.
+    f32 get_alpha() const {
+        return f32(accumulator) / f32(clock->frequency);
+    }
+
+    u64 get_dropped_ticks() const {
+        return dropped_ticks;
+    }
+
+protected:
+    const Clock* clock = nullptr;
+    u32 tick_rate;
+    u32 max_ticks_per_frame;
+    i64 last_time;
+    i64 accumulator;
+    u64 dropped_ticks = 0;
+};
@@ -0,0 +1,62 @@
+#pragma once
+#include <filesystem>
+#include <string>
+
+#include "common.hpp"
+#include "frame_profiler.hpp"
+
+// Scope markers written out as Chrome trace events, for chrome://tracing or
+// ui.perfetto.dev: a timeline of every marked scope on every thread, from any
+// run, without attaching a profiler.
+//
+//   bool WindowLogic::paint() {
+//       TRACE_SCOPE("paint");
+//       ...
+//
+// Tracing is switched on and off at runtime. While off, a marker costs a
+// call and a relaxed load. While on, it reads the timestamp twice and
+// appends an event to a ring holding the last TRACE_RING_EVENTS events of
+// its thread; only that thread writes the ring, so nothing is locked, and
+// the ring is allocated once, the first time the thread traces.
+
+constexpr u32 TRACE_RING_EVENTS = 1 << 18;
+
+// Starts tracing; whatever was recorded before is forgotten.
+void trace_start();
+
+// Stops tracing and writes the events recorded since `trace_start` (the
+// last TRACE_RING_EVENTS of each thread) to `path`, as trace-event JSON.
+// Scopes still open are left out.
+bool trace_stop(const std::filesystem::path& path);
+
+bool trace_enabled();
+
+// Names the calling thread in the traces ("main", "worker 1", ...).
+void trace_thread_name(std::string name);
+
+// Records one event, unless tracing is off by now; `name` must outlive the
+// trace (a string literal).
+void trace_event(const char* name, u64 start, u64 end);
+
+// Times the scope it lives in, as `name`, if tracing was on when it began.
+struct TraceScope {
+    explicit TraceScope(const char* name)
+        : name(name)
+        , start(trace_enabled() ? profile_now() : 0) {}
+
+    ~TraceScope() {
+        if (start)
+            trace_event(name, start, profile_now());
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name;
+    u64 start;
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(trace_scope_, __LINE__)(name)
@@ -0,0 +1,15 @@
+#pragma once
+#include <utility>
+#include <cstddef>
+
+struct TextTypewriterAnimation {
+    bool Init(const wchar_t* animation_text_);
+    bool is_frame_left() const;
+    void next_frame();
+
+    std::pair<const wchar_t*, size_t> get_text() const;
+
+private:
+    const wchar_t* animation_text = L"";
+    size_t chars_progress = 0;
+};
@@ -9,7 +9,10 @@ struct Window {
         , inner_height(inner_height)
         , logic(*this) {}
 
-    bool Init(const wchar_t* class_name, const wchar_t* title);
+    bool Init(const wchar_t* class_name, const wchar_t* title,
+              const wchar_t* replay_path = nullptr, const wchar_t* profile_path = nullptr,
+              const wchar_t* trace_path = nullptr,
+              u64 hitch_us = FlightRecorder::DEFAULT_BUDGET_US);
     bool ComputeOuterSize(i32 &outer_width, i32 &outer_height);
     bool SetOuterSize(i32 outer_width, i32 outer_height, u32 dpi);
     void MessageHandler(UINT uMsg, WPARAM wParam, LPARAM lParam);
@@ -0,0 +1,101 @@
+#include "alloc_counter.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// The replacements of every operator new and delete that do not take
+// std::nothrow; those that do call these. Memory comes from malloc, as with
+// the ones they replace.
+
+namespace {
+    std::atomic<u64> allocated = 0;
+
+    void* allocate(size_t size) {
+        allocated.fetch_add(size, std::memory_order_relaxed);
+
+        if (void* p = std::malloc(size ? size : 1))
+            return p;
+
+        throw std::bad_alloc();
+    }
+
+    void* allocate(size_t size, std::align_val_t alignment) {
+        allocated.fetch_add(size, std::memory_order_relaxed);
+
+        const size_t align = size_t(alignment);
+
+#ifdef _WIN32
+        void* p = _aligned_malloc(size ? size : 1, align);
+#else
+        // aligned_alloc wants a nonzero multiple of the alignment.
+        const size_t rounded = size ? (size + align - 1) / align * align : align;
+        void* p = std::aligned_alloc(align, rounded);
+#endif // _WIN32
+
+        if (p)
+            return p;
+
+        throw std::bad_alloc();
+    }
+
+    void release(void* p, std::align_val_t) {
+#ifdef _WIN32
+        _aligned_free(p);
+#else
+        std::free(p);
+#endif // _WIN32
+    }
+}
+
+u64 allocated_bytes() {
+    return allocated.load(std::memory_order_relaxed);
+}
+
+void* operator new(size_t size) {
+    return allocate(size);
+}
+
+void* operator new[](size_t size) {
+    return allocate(size);
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    return allocate(size, alignment);
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+    return allocate(size, alignment);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t alignment) noexcept {
+    release(p, alignment);
+}
+
+void operator delete[](void* p, std::align_val_t alignment) noexcept {
+    release(p, alignment);
+}
+
+void operator delete(void* p, size_t, std::align_val_t alignment) noexcept {
+    release(p, alignment);
+}
+
+void operator delete[](void* p, size_t, std::align_val_t alignment) noexcept {
+    release(p, alignment);
+}
@@ -0,0 +1,221 @@
+#include "asset_pack.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "spirits_gen.hpp"
+
+namespace {
+    constexpr char MAGIC[4] = { 'A', 'S', 'P', 'K' };
+    constexpr u32 VERSION = 1;
+
+    constexpr f32 SPIRIT_SCALES[SpiritSprites::COUNT] = {
+        Spirits::controller.scale,
+        Spirits::asteroid.scale,
+        Spirits::bullet.scale,
+    };
+
+    u64 align(u64 offset) {
+        return (offset + PACK_ALIGNMENT - 1) / PACK_ALIGNMENT * PACK_ALIGNMENT;
+    }
+
+    bool same_scale(f32 a, f32 b) {
+        return std::abs(a - b) < 1e-4f;
+    }
+
+    void report(const std::filesystem::path& path, const wchar_t* reason) {
+        std::wcout << L"Ignoring the asset pack (" << path.wstring() << L"): " << reason << L'\n';
+    }
+}
+
+bool AssetPack::Init(const std::filesystem::path& path) {
+    header = nullptr;
+    atlases = nullptr;
+
+    if (!file.Init(path))
+        return false;
+
+    if (!validate(path)) {
+        file.unmap();
+        return false;
+    }
+
+    header = (const PackHeader*) file.data();
+    atlases = (const PackAtlas*) (file.data() + sizeof(PackHeader));
+
+    return true;
+}
+
+// Everything `load_atlas` relies on, so that a damaged file is never read out
+// of bounds.
+bool AssetPack::validate(const std::filesystem::path& path) const {
+    const u8* data = file.data();
+    const size_t size = file.size();
+
+    if (size < sizeof(PackHeader) || memcmp(data, MAGIC, sizeof(MAGIC)) != 0) {
+        report(path, L"not an asset pack");
+        return false;
+    }
+
+    PackHeader pack;
+    memcpy(&pack, data, sizeof(pack));
+
+    if (pack.version != VERSION) {
+        report(path, L"unsupported version");
+        return false;
+    }
+
+    if (pack.file_size != size ||
+        u64(pack.atlas_count) * sizeof(PackAtlas) > size - sizeof(PackHeader)) {
+        report(path, L"truncated");
+        return false;
+    }
+
+    bool current = pack.sprite_count == SpiritSprites::COUNT &&
+                   pack.level_count == SpiritSprites::MIP_LEVELS;
+
+    for (u32 i = 0; current && i < SpiritSprites::COUNT; ++i)
+        current = same_scale(pack.scales[i], SPIRIT_SCALES[i]);
+
+    if (!current) {
+        report(path, L"out of date");
+        return false;
+    }
+
+    for (u32 a = 0; a < pack.atlas_count; ++a) {
+        PackAtlas atlas;
+        memcpy(&atlas, data + sizeof(PackHeader) + a * sizeof(PackAtlas), sizeof(atlas));
+
+        const u64 bytes = u64(atlas.width) * atlas.height * sizeof(u32);
+
+        if (atlas.offset % PACK_ALIGNMENT != 0 || atlas.offset > size ||
+            bytes > size - atlas.offset) {
+            report(path, L"atlas out of bounds");
+            return false;
+        }
+
+        for (const PackSprite& sprite : atlas.sprites) {
+            if (sprite.level_count == 0 || sprite.level_count > SpriteAtlas::MAX_LEVELS) {
+                report(path, L"bad level count");
+                return false;
+            }
+
+            for (u32 level = 0; level < sprite.level_count; ++level) {
+                const AtlasRegion& region = sprite.levels[level];
+
+                if (u64(region.x) + region.width > atlas.width ||
+                    u64(region.y) + region.height > atlas.height) {
+                    report(path, L"sprite out of bounds");
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+bool AssetPack::load_atlas(f32 pixels_per_dip, SpriteAtlas& atlas,
+                           SpiritSprites& sprites) const {
+    if (!header)
+        return false;
+
+    for (u32 a = 0; a < header->atlas_count; ++a) {
+        const PackAtlas& packed = atlases[a];
+
+        if (!same_scale(packed.pixels_per_dip, pixels_per_dip))
+            continue;
+
+        std::vector<std::vector<AtlasRegion>> regions;
+
+        for (u32 i = 0; i < SpiritSprites::COUNT; ++i) {
+            const PackSprite& sprite = packed.sprites[i];
+
+            regions.emplace_back(sprite.levels, sprite.levels + sprite.level_count);
+            sprites.ids[i] = i;
+            sprites.sizes[i] = { sprite.width, sprite.height };
+        }
+
+        atlas.assign(packed.width, packed.height,
+                     (const u32*) (file.data() + packed.offset), std::move(regions));
+
+        return true;
+    }
+
+    return false;
+}
+
+bool write_asset_pack(const std::filesystem::path& root, const std::filesystem::path& path,
+                      JobSystem* jobs) {
+    constexpr u32 ATLAS_COUNT = u32(std::size(PACKED_PIXELS_PER_DIP));
+
+    std::vector<SpriteAtlas> atlases(ATLAS_COUNT);
+    std::vector<PackAtlas> entries(ATLAS_COUNT);
+
+    u64 offset = align(sizeof(PackHeader) + sizeof(PackAtlas) * ATLAS_COUNT);
+
+    for (u32 a = 0; a < ATLAS_COUNT; ++a) {
+        SpriteAtlas& atlas = atlases[a];
+        SpiritSprites sprites;
+
+        if (!add_spirit_sprites(root, PACKED_PIXELS_PER_DIP[a], atlas, sprites, jobs))
+            return false;
+
+        atlas.pack();
+
+        PackAtlas& entry = entries[a];
+        entry = {};
+
+        entry.offset = offset;
+        entry.pixels_per_dip = PACKED_PIXELS_PER_DIP[a];
+        entry.width = atlas.get_width();
+        entry.height = atlas.get_height();
+
+        for (u32 i = 0; i < SpiritSprites::COUNT; ++i) {
+            PackSprite& sprite = entry.sprites[i];
+
+            sprite.width = sprites.sizes[i].width;
+            sprite.height = sprites.sizes[i].height;
+            sprite.level_count = atlas.level_count(sprites.ids[i]);
+
+            for (u32 level = 0; level < sprite.level_count; ++level)
+                sprite.levels[level] = atlas.region(sprites.ids[i], level);
+        }
+
+        offset = align(offset + u64(entry.width) * entry.height * sizeof(u32));
+    }
+
+    PackHeader header = {};
+
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.atlas_count = ATLAS_COUNT;
+    header.sprite_count = SpiritSprites::COUNT;
+    header.level_count = SpiritSprites::MIP_LEVELS;
+    std::copy_n(SPIRIT_SCALES, SpiritSprites::COUNT, header.scales);
+    header.file_size = offset;
+
+    std::vector<u8> out(offset, 0);
+
+    memcpy(out.data(), &header, sizeof(header));
+    memcpy(out.data() + sizeof(header), entries.data(), sizeof(PackAtlas) * ATLAS_COUNT);
+
+    for (u32 a = 0; a < ATLAS_COUNT; ++a) {
+        memcpy(out.data() + entries[a].offset, atlases[a].get_pixels(),
+               size_t(entries[a].width) * entries[a].height * sizeof(u32));
+    }
+
+    std::ofstream pack(path, std::ios::binary | std::ios::trunc);
+    pack.write((const char*) out.data(), std::streamsize(out.size()));
+
+    if (!pack) {
+        std::wcout << L"Cannot write " << path.wstring() << L'\n';
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,208 @@
+#include "blend_kernel.hpp"
+
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+#include "cpu_features.hpp"
+
+namespace {
+    using Kernel = void (*)(u32* dst, const u32* src, size_t count, const Modulate& modulate);
+
+    // x / 255 rounded to nearest, exact for x <= 255 * 255.
+    u32 div255(u32 x) {
+        x += 128;
+        return (x + (x >> 8)) >> 8;
+    }
+
+    u32 blend_pixel(u32 dst, u32 src, const Modulate& m) {
+        const u32 a = (((src >> 24) & 0xff) * m.a + 128) >> 8;
+        const u32 inv = 255 - a;
+
+        auto channel = [&](u32 shift, u32 factor) {
+            const u32 s = (((src >> shift) & 0xff) * factor + 128) >> 8;
+            return std::min<u32>(s + div255(((dst >> shift) & 0xff) * inv), 255) << shift;
+        };
+
+        return channel(0, m.b) | channel(8, m.g) | channel(16, m.r) |
+               std::min<u32>(a + div255((dst >> 24) * inv), 255) << 24;
+    }
+
+    void blend_row_scalar(u32* dst, const u32* src, size_t count, const Modulate& modulate) {
+        for (size_t i = 0; i < count; ++i) {
+            if (src[i])
+                dst[i] = blend_pixel(dst[i], src[i], modulate);
+        }
+    }
+
+#ifdef CPU_X86
+    // Both vector versions widen the channels to 16 bits, where every step
+    // of the scalar formula fits without overflow:
+    //
+    //   src * modulate + 128  <= 255 * 256 + 128
+    //   dst * inv + 128 + 254 <= 255 * 255 + 382
+    //
+    // and skip runs of fully transparent source pixels, which are most of a
+    // sprite's bounding box.
+
+    // The last `count` < N pixels of a row, through a whole vector: rows are
+    // clipped to tiles, so short tails are common and the scalar loop would
+    // cost more than the rest of the row. Transparent padding leaves the
+    // destination as it is.
+    template<size_t N>
+    void blend_tail(u32* dst, const u32* src, size_t count, const Modulate& modulate,
+                    Kernel kernel) {
+        u32 src_tail[N] = {};
+        u32 dst_tail[N] = {};
+
+        memcpy(src_tail, src, count * sizeof(u32));
+        memcpy(dst_tail, dst, count * sizeof(u32));
+
+        kernel(dst_tail, src_tail, N, modulate);
+
+        memcpy(dst, dst_tail, count * sizeof(u32));
+    }
+
+    __m128i blend_half_sse2(__m128i dst, __m128i src, __m128i modulate) {
+        const __m128i bias = _mm_set1_epi16(128);
+
+        const __m128i s = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(src, modulate), bias), 8);
+        const __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, 0xff), 0xff);
+        const __m128i inv = _mm_sub_epi16(_mm_set1_epi16(255), a);
+
+        __m128i d = _mm_add_epi16(_mm_mullo_epi16(dst, inv), bias);
+        d = _mm_srli_epi16(_mm_add_epi16(d, _mm_srli_epi16(d, 8)), 8);
+
+        return _mm_add_epi16(s, d);
+    }
+
+    void blend_row_sse2(u32* dst, const u32* src, size_t count, const Modulate& modulate) {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i m = _mm_setr_epi16(modulate.b, modulate.g, modulate.r, modulate.a,
+                                         modulate.b, modulate.g, modulate.r, modulate.a);
+        const __m128i alpha = _mm_set1_epi32(i32(0xff000000));
+        const bool identity = modulate.is_identity();
+
+        size_t i = 0;
+
+        for (; i + 4 <= count; i += 4) {
+            const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+
+            if (_mm_movemask_epi8(_mm_cmpeq_epi32(s, zero)) == 0xffff)
+                continue;
+
+            __m128i* out = reinterpret_cast<__m128i*>(dst + i);
+
+            if (identity &&
+                _mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(s, alpha), alpha)) == 0xffff) {
+                _mm_storeu_si128(out, s);
+                continue;
+            }
+
+            const __m128i d = _mm_loadu_si128(out);
+
+            const __m128i lo = blend_half_sse2(_mm_unpacklo_epi8(d, zero),
+                                               _mm_unpacklo_epi8(s, zero), m);
+            const __m128i hi = blend_half_sse2(_mm_unpackhi_epi8(d, zero),
+                                               _mm_unpackhi_epi8(s, zero), m);
+
+            _mm_storeu_si128(out, _mm_packus_epi16(lo, hi));
+        }
+
+        if (i < count)
+            blend_tail<4>(dst + i, src + i, count - i, modulate, blend_row_sse2);
+    }
+
+    TARGET_AVX2
+    __m256i blend_half_avx2(__m256i dst, __m256i src, __m256i modulate) {
+        const __m256i bias = _mm256_set1_epi16(128);
+
+        const __m256i s = _mm256_srli_epi16(
+            _mm256_add_epi16(_mm256_mullo_epi16(src, modulate), bias), 8);
+        const __m256i a = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(s, 0xff), 0xff);
+        const __m256i inv = _mm256_sub_epi16(_mm256_set1_epi16(255), a);
+
+        __m256i d = _mm256_add_epi16(_mm256_mullo_epi16(dst, inv), bias);
+        d = _mm256_srli_epi16(_mm256_add_epi16(d, _mm256_srli_epi16(d, 8)), 8);
+
+        return _mm256_add_epi16(s, d);
+    }
+
+    // The unpacks and the pack work within each 128-bit lane, so the pixels
+    // come back in the order they were loaded.
+    TARGET_AVX2
+    void blend_row_avx2(u32* dst, const u32* src, size_t count, const Modulate& modulate) {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i m = _mm256_setr_epi16(
+            modulate.b, modulate.g, modulate.r, modulate.a,
+            modulate.b, modulate.g, modulate.r, modulate.a,
+            modulate.b, modulate.g, modulate.r, modulate.a,
+            modulate.b, modulate.g, modulate.r, modulate.a);
+        const __m256i alpha = _mm256_set1_epi32(i32(0xff000000));
+        const bool identity = modulate.is_identity();
+
+        size_t i = 0;
+
+        for (; i + 8 <= count; i += 8) {
+            const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+
+            if (_mm256_testz_si256(s, s))
+                continue;
+
+            __m256i* out = reinterpret_cast<__m256i*>(dst + i);
+
+            if (identity &&
+                _mm256_movemask_epi8(_mm256_cmpeq_epi32(_mm256_and_si256(s, alpha), alpha)) == -1) {
+                _mm256_storeu_si256(out, s);
+                continue;
+            }
+
+            const __m256i d = _mm256_loadu_si256(out);
+
+            const __m256i lo = blend_half_avx2(_mm256_unpacklo_epi8(d, zero),
+                                               _mm256_unpacklo_epi8(s, zero), m);
+            const __m256i hi = blend_half_avx2(_mm256_unpackhi_epi8(d, zero),
+                                               _mm256_unpackhi_epi8(s, zero), m);
+
+            _mm256_storeu_si256(out, _mm256_packus_epi16(lo, hi));
+        }
+
+        if (i < count)
+            blend_tail<8>(dst + i, src + i, count - i, modulate, blend_row_avx2);
+    }
+#endif // CPU_X86
+
+    KernelDispatch<Kernel> dispatch {
+#ifdef CPU_X86
+        { "avx2", blend_row_avx2, cpu_has_avx2() },
+        { "sse2", blend_row_sse2, true },
+#endif
+        { "scalar", blend_row_scalar, true },
+    };
+
+    u16 to_factor(f32 value) {
+        return u16(std::lround(std::clamp(value, 0.f, 1.f) * 256.f));
+    }
+}
+
+Modulate Modulate::opacity(f32 opacity) {
+    const u16 factor = to_factor(opacity);
+    return { factor, factor, factor, factor };
+}
+
+Modulate Modulate::tint(f32 r, f32 g, f32 b, f32 opacity) {
+    return { to_factor(b * opacity), to_factor(g * opacity), to_factor(r * opacity),
+             to_factor(opacity) };
+}
+
+void blend_row(u32* dst, const u32* src, size_t count, const Modulate& modulate) {
+    dispatch.kernels()(dst, src, count, modulate);
+}
+
+const char* blend_kernel_name() {
+    return dispatch.name();
+}
+
+bool select_blend_kernel(const char* name) {
+    return dispatch.select(name);
+}
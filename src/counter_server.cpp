@@ -0,0 +1,142 @@
+#include "counter_server.hpp"
+
+#include <iostream>
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+#ifndef _WIN32
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif // _WIN32
+
+namespace {
+    // How long `serve` may take to notice that it is being stopped.
+    constexpr int POLL_MS = 100;
+
+#ifndef _WIN32
+    // Clears the way for binding at `address`: removes a socket left there by
+    // an earlier run, but neither one that another run still answers on nor
+    // anything that is not a socket.
+    bool claim(const sockaddr_un& address) {
+        struct stat status;
+
+        if (lstat(address.sun_path, &status) < 0)
+            return errno == ENOENT;
+
+        if (!S_ISSOCK(status.st_mode)) {
+            std::wcout << L"Not a socket: " << address.sun_path << L'\n';
+            return false;
+        }
+
+        const int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+
+        if (probe < 0)
+            return false;
+
+        const bool answered = connect(probe, (const sockaddr*) &address, sizeof(address)) == 0;
+        close(probe);
+
+        if (answered) {
+            std::wcout << L"Socket in use: " << address.sun_path << L'\n';
+            return false;
+        }
+
+        return unlink(address.sun_path) == 0;
+    }
+#endif // _WIN32
+}
+
+#if !defined(_WIN32) && !defined(MSG_NOSIGNAL)
+#define MSG_NOSIGNAL 0
+#endif
+
+bool CounterServer::Init(const std::filesystem::path& path_, const LiveCounters& counters_) {
+#ifndef _WIN32
+    path = path_;
+    counters = &counters_;
+
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+
+    const std::string name = path.string();
+
+    if (name.size() >= sizeof(address.sun_path)) {
+        std::wcout << L"Socket path too long: " << path.wstring() << L'\n';
+        return false;
+    }
+
+    std::memcpy(address.sun_path, name.c_str(), name.size() + 1);
+
+    if (!claim(address))
+        return false;
+
+    listener = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if (listener >= 0)
+        bound = bind(listener, (const sockaddr*) &address, sizeof(address)) == 0;
+
+    if (!bound || listen(listener, 4) < 0) {
+        std::wcout << L"Cannot listen at " << path.wstring() << L'\n';
+        return false;
+    }
+
+    thread = std::thread([this] { serve(); });
+    return true;
+#else
+    (void) path_;
+    (void) counters_;
+
+    std::wcout << L"No counter socket on Windows\n";
+    return false;
+#endif // _WIN32
+}
+
+CounterServer::~CounterServer() {
+#ifndef _WIN32
+    stopping.store(true, std::memory_order_relaxed);
+
+    if (thread.joinable())
+        thread.join();
+
+    if (listener >= 0)
+        close(listener);
+
+    if (bound)
+        unlink(path.string().c_str());
+#endif // _WIN32
+}
+
+void CounterServer::serve() {
+#ifndef _WIN32
+    while (!stopping.load(std::memory_order_relaxed)) {
+        pollfd waiting { listener, POLLIN, 0 };
+
+        if (poll(&waiting, 1, POLL_MS) <= 0)
+            continue;
+
+        const int client = accept(listener, nullptr, nullptr);
+
+        if (client < 0)
+            continue;
+
+        const std::string snapshot = counters->snapshot();
+
+        // A poller that goes away early is not our problem.
+        for (size_t sent = 0; sent < snapshot.size();) {
+            const ssize_t n = send(client, snapshot.data() + sent, snapshot.size() - sent,
+                                   MSG_NOSIGNAL);
+
+            if (n <= 0)
+                break;
+
+            sent += size_t(n);
+        }
+
+        close(client);
+    }
+#endif // _WIN32
+}
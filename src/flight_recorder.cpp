@@ -0,0 +1,169 @@
+#include "flight_recorder.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+
+#include "game.hpp"
+#include "replay.hpp"
+
+namespace {
+    constexpr const char* STATE_NAMES[] = {
+        "FADE_IN",
+        "GAME_PLAY",
+        "GAME_OVER",
+        "FADE_OUT",
+        "CHOOSE_NEW_LEVEL",
+    };
+
+    const char* state_name(u8 state) {
+        return state < std::size(STATE_NAMES) ? STATE_NAMES[state] : "unknown";
+    }
+
+    f64 us(u64 ticks) {
+        return f64(ticks) * profile_tick_ns() / 1e3;
+    }
+
+    void write_tick(std::ostream& out, const FlightTick& tick) {
+        const Input input = unpack_input(tick.input);
+
+        out << "        { \"tick\": " << tick.tick << ", \"state\": \""
+            << state_name(tick.state) << "\", \"input\": \"" << (input.left ? 'L' : '-')
+            << (input.right ? 'R' : '-') << (input.space ? 'S' : '-') << "\", \"level\": "
+            << input.level << ", \"asteroids\": " << tick.asteroids << ", \"bullets\": "
+            << tick.bullets << ", \"score\": " << tick.score;
+
+        for (u32 phase = 0; phase < TICK_PHASES; ++phase) {
+            out << ", \"" << phase_name(FramePhase(phase)) << "_us\": "
+                << us(tick.phases[phase]);
+        }
+
+        out << " }";
+    }
+}
+
+bool FlightRecorder::Init(u64 budget_us, std::filesystem::path dump_dir_) {
+    ticks.assign(TICKS, FlightTick {});
+    frames.assign(FRAMES, FlightFrame {});
+
+    budget = budget_us ? u64(f64(budget_us) * 1e3 / profile_tick_ns()) : 0;
+    dump_dir = std::move(dump_dir_);
+
+    return true;
+}
+
+void FlightRecorder::record_tick(const Game& game, const Input& input,
+                                 const PhaseTimes& times) {
+    FlightTick& record = ticks[tick_count++ % TICKS];
+
+    record.tick = game.tick;
+    record.frame = frame;
+
+    for (u32 phase = 0; phase < TICK_PHASES; ++phase)
+        record.phases[phase] = times.ticks[phase].load(std::memory_order_relaxed);
+
+    record.asteroids = u32(game.asteroids.count());
+    record.bullets = u32(game.bullets.count());
+    record.score = game.score;
+    record.state = u8(game.State);
+    record.input = pack_input(input);
+}
+
+bool FlightRecorder::end_frame(const PhaseTimes& times) {
+    FlightFrame& record = frames[frame % FRAMES];
+
+    record.frame = frame;
+
+    for (u32 phase = TICK_PHASES; phase < PHASE_COUNT; ++phase)
+        record.phases[phase - TICK_PHASES] = times.ticks[phase].load(std::memory_order_relaxed);
+
+    bool result = true;
+
+    if (dump_frame && dump_frame == frame)
+        result = dump();
+
+    if (budget && times.ticks[PHASE_FRAME].load(std::memory_order_relaxed) > budget) {
+        ++hitches;
+
+        if (!dump_frame && dumps < MAX_DUMPS) {
+            hitch_frame = frame;
+            dump_frame = frame + FRAMES_AFTER;
+        }
+    }
+
+    ++frame;
+    return result;
+}
+
+bool FlightRecorder::Finish() {
+    if (!dump_frame)
+        return true;
+
+    // The current frame is still open; only those before it are complete.
+    --frame;
+    const bool result = dump();
+    ++frame;
+
+    return result;
+}
+
+// Writes the frames up to `frame`, oldest first, each with the ticks it took
+// (those of the oldest frames may have left the ring already).
+bool FlightRecorder::dump() {
+    std::string name = std::to_string(hitch_frame);
+    name = "hitch_" + std::string(name.size() < 8 ? 8 - name.size() : 0, '0') + name + ".json";
+
+    const std::filesystem::path path = dump_dir / name;
+    std::ofstream file(path);
+
+    dump_frame = 0;
+    ++dumps;
+
+    const u64 first_frame = frame + 1 > FRAMES ? frame + 1 - FRAMES : 0;
+    u64 tick = tick_count > TICKS ? tick_count - TICKS : 0;
+
+    // Ticks of frames that have left the ring.
+    while (tick < tick_count && ticks[tick % TICKS].frame < first_frame)
+        ++tick;
+
+    file << std::fixed << std::setprecision(3);
+
+    file << "{\n"
+         << "  \"hitch_frame\": " << hitch_frame << ",\n"
+         << "  \"budget_us\": " << us(budget) << ",\n"
+         << "  \"frames\": [";
+
+    for (u64 i = first_frame; i <= frame; ++i) {
+        const FlightFrame& record = frames[i % FRAMES];
+
+        file << (i > first_frame ? ",\n" : "\n") << "    { \"frame\": " << record.frame;
+
+        for (u32 phase = TICK_PHASES; phase < PHASE_COUNT; ++phase) {
+            file << ", \"" << phase_name(FramePhase(phase)) << "_us\": "
+                 << us(record.phases[phase - TICK_PHASES]);
+        }
+
+        file << ", \"ticks\": [";
+
+        for (bool first = true; tick < tick_count && ticks[tick % TICKS].frame == i; ++tick) {
+            file << (first ? "\n" : ",\n");
+            write_tick(file, ticks[tick % TICKS]);
+            first = false;
+        }
+
+        file << " ] }";
+    }
+
+    file << "\n  ]\n"
+         << "}\n";
+
+    if (!file) {
+        std::wcout << L"Cannot write " << path.wstring() << L'\n';
+        return false;
+    }
+
+    std::wcout << L"Frame " << hitch_frame << L" over budget, written to " << path.wstring()
+               << L'\n';
+    return true;
+}
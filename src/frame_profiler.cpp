@@ -0,0 +1,197 @@
+#include "frame_profiler.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+
+#include "cpu_features.hpp"
+#include "perf_counters.hpp"
+
+namespace {
+    constexpr const char* PHASE_NAMES[PHASE_COUNT] = {
+        "update_motion",
+        "spawn",
+        "collision",
+        "gc",
+        "paint",
+        "text_flush",
+        "present",
+        "frame",
+    };
+
+    constexpr f64 PERCENTILES[] = { 0.5, 0.99, 0.999 };
+
+    u64 steady_ns() {
+        return u64(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    f64 us(f64 ticks) {
+        return ticks * profile_tick_ns() / 1e3;
+    }
+
+    void write_csv(std::ostream& out, const FrameProfiler& profiler) {
+        out << "phase,count,mean_us,p50_us,p99_us,p999_us,max_us\n";
+
+        for (u32 phase = 0; phase < PHASE_COUNT; ++phase) {
+            const LogHistogram& histogram = profiler.phases[phase];
+
+            out << PHASE_NAMES[phase] << ',' << histogram.count << ',' << us(histogram.mean());
+
+            for (f64 q : PERCENTILES)
+                out << ',' << us(f64(histogram.percentile(q)));
+
+            out << ',' << us(f64(histogram.max)) << '\n';
+        }
+    }
+
+    void write_json(std::ostream& out, const FrameProfiler& profiler) {
+        out << "{\n"
+            << "  \"unit\": \"us\",\n"
+            << "  \"phases\": [\n";
+
+        for (u32 phase = 0; phase < PHASE_COUNT; ++phase) {
+            const LogHistogram& histogram = profiler.phases[phase];
+
+            out << "    { \"phase\": \"" << PHASE_NAMES[phase] << "\", \"count\": "
+                << histogram.count << ", \"mean\": " << us(histogram.mean())
+                << ", \"p50\": " << us(f64(histogram.percentile(0.5)))
+                << ", \"p99\": " << us(f64(histogram.percentile(0.99)))
+                << ", \"p999\": " << us(f64(histogram.percentile(0.999)))
+                << ", \"max\": " << us(f64(histogram.max)) << " }"
+                << (phase + 1 < PHASE_COUNT ? "," : "") << '\n';
+        }
+
+        out << "  ]\n"
+            << "}\n";
+    }
+}
+
+const char* phase_name(FramePhase phase) {
+    return phase < PHASE_COUNT ? PHASE_NAMES[phase] : "unknown";
+}
+
+u64 profile_now() {
+#ifdef CPU_X86
+    return __rdtsc();
+#else
+    return steady_ns();
+#endif
+}
+
+f64 profile_tick_ns() {
+#ifdef CPU_X86
+    // Against the OS clock over a few milliseconds: the counter runs at a
+    // constant rate on every CPU of the last fifteen years, whatever the
+    // clock speed.
+    static const f64 tick_ns = [] {
+        const u64 ns = steady_ns();
+        const u64 ticks = __rdtsc();
+        u64 elapsed;
+
+        do {
+            elapsed = steady_ns() - ns;
+        } while (elapsed < 10'000'000);
+
+        return f64(elapsed) / f64(__rdtsc() - ticks);
+    }();
+
+    return tick_ns;
+#else
+    return 1;
+#endif
+}
+
+u64 LogHistogram::bucket_max(u32 bucket) {
+    if (bucket < SUB_BUCKETS)
+        return bucket;
+
+    const u32 shift = bucket / SUB_BUCKETS - 1;
+    const u64 first = u64(bucket % SUB_BUCKETS + SUB_BUCKETS) << shift;
+
+    return first + ((u64(1) << shift) - 1);
+}
+
+u64 LogHistogram::percentile(f64 q) const {
+    if (!count)
+        return 0;
+
+    const u64 rank = std::max<u64>(1, u64(std::ceil(q * f64(count))));
+    u64 seen = 0;
+
+    for (u32 bucket = 0; bucket < BUCKETS; ++bucket) {
+        seen += buckets[bucket];
+
+        if (seen >= rank)
+            return std::min(bucket_max(bucket), max);
+    }
+
+    return max;
+}
+
+void LogHistogram::clear() {
+    count = 0;
+    sum = 0;
+    max = 0;
+    buckets.fill(0);
+}
+
+void PhaseTimes::count_start() const {
+    counters->start();
+}
+
+void PhaseTimes::count(FramePhase phase) const {
+    counters->add(phase);
+}
+
+void FrameProfiler::record(const PhaseTimes& times) {
+    for (u32 phase = 0; phase < PHASE_COUNT; ++phase) {
+        const u64 ticks = times.ticks[phase].load(std::memory_order_relaxed);
+
+        if (ticks)
+            phases[phase].record(ticks);
+    }
+}
+
+void FrameProfiler::clear() {
+    for (LogHistogram& histogram : phases)
+        histogram.clear();
+}
+
+void FrameProfiler::print(std::wostream& out) const {
+    out << L"phase             count     mean      p50      p99    p99.9      max (us)\n";
+
+    for (u32 phase = 0; phase < PHASE_COUNT; ++phase) {
+        const LogHistogram& histogram = phases[phase];
+
+        out << std::left << std::setw(12) << PHASE_NAMES[phase] << std::right
+            << std::setw(11) << histogram.count << std::fixed << std::setprecision(1)
+            << std::setw(9) << us(histogram.mean());
+
+        for (f64 q : PERCENTILES)
+            out << std::setw(9) << us(f64(histogram.percentile(q)));
+
+        out << std::setw(9) << us(f64(histogram.max)) << L'\n';
+    }
+
+    out << std::defaultfloat << std::setprecision(6);
+}
+
+bool FrameProfiler::write(const std::filesystem::path& path) const {
+    std::ofstream file(path);
+
+    if (path.extension() == ".json")
+        write_json(file, *this);
+    else
+        write_csv(file, *this);
+
+    if (!file) {
+        std::wcout << L"Cannot write " << path.wstring() << L'\n';
+        return false;
+    }
+
+    return true;
+}
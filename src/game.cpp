@@ -0,0 +1,744 @@
+#include "game.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+#include "common.hpp"
+#include "math.hpp"
+#include "timer.hpp"
+#include "segment_kernel.hpp"
+#include "trace.hpp"
+
+namespace {
+    constexpr i32 MOVE_INTERVAL = 0'005;
+    // Animations that used to advance once per painted frame are now scaled
+    // to this frame length, whatever the tick rate is.
+    constexpr f32 REFERENCE_FRAME_INTERVAL = 1000.f / 60.f;
+    constexpr i32 NEW_BULLET_INTERVAL = 0'200;
+    constexpr i32 PENALTY_INTERVAL = 0'300;
+    constexpr i32 FADE_OUT_INTERVAL = 2'000;
+    constexpr f32 BULLET_SPEED = 3;
+    constexpr i32 TYPE_SPEED = 0'100;
+}
+
+void Game::reset_controller_pos() {
+    controller_pos.x = size.width / 2;
+    controller_pos.y = size.height - 40;
+    prev_controller_pos = controller_pos;
+}
+
+void Game::set_size(SizeF size_) {
+    size = size_;
+}
+
+bool Game::Init(SizeF size_, u32 seed, u32 tick_rate_) {
+    if (tick_rate_ == 0)
+        return false;
+
+    size = size_;
+    gen.seed(seed);
+
+    // One tick is exactly 1000 clock units, so timer intervals given in
+    // milliseconds come out as whole numbers.
+    tick_rate = tick_rate_;
+    tick = 0;
+    clock.frequency = i64(tick_rate) * 1000;
+    clock.now = 0;
+
+    shift = 1000.f / f32(tick_rate) / f32(MOVE_INTERVAL);
+
+    reset_controller_pos();
+
+    if (!set_asteroid_frequency())
+        return false;
+
+    return new_bullet_timer.Init(NEW_BULLET_INTERVAL, clock) &&
+           penalty_timer.Init(PENALTY_INTERVAL, clock);
+}
+
+bool Game::set_asteroid_frequency() {
+    return new_asteroid_timer.Init((7 - difficulty) * 100, clock);
+}
+
+void Game::new_bullets(const Input& input) {
+    if (bullet_forbidden) {
+        i32 ticks = new_bullet_timer.get_intervals_count(false);
+
+        if (ticks) {
+            bullet_forbidden = false;
+        }
+    }
+
+    if (bullet_forbidden || !input.space || State != GAME_PLAY)
+        return;
+
+    bullet_forbidden = true;
+    new_bullet_timer.start_new_interval();
+
+    Vector bullet_pos { controller_pos };
+
+    bullet_pos.y -= spirits.controller.contour.half_of_sides.y;
+
+    bullets.push(bullet_pos, -BULLET_SPEED);
+}
+
+void Game::new_asteroids() {
+    const i32 ticks = new_asteroid_timer.get_intervals_count(true);
+
+    if (ticks && (State == GAME_PLAY || State == FADE_IN)) {
+        const f32 asteroid_radius = spirits.asteroid.contour.half_of_sides.y;
+
+        const f32 shift_x = norm_asteroid_x(gen);
+        const f32 shift_y = unif_asteroid_y(gen);
+
+        const f32 x_pos = shift_x * size.width;
+        const f32 y_pos = -(shift_y * (300 - 2 * asteroid_radius) + asteroid_radius);
+
+        const f32 speed = unif_speed(gen);
+
+        asteroids.push(Vector(x_pos, y_pos), speed);
+    }
+}
+
+template<typename Lhs, typename Rhs>
+bool Game::collide(const Lhs& lhs, const Rhs& rhs,
+                   const Vector& lhs_center, const Vector& rhs_center,
+                   const Vector& rhs_motion, f32& toi, TickCounts& counts) const {
+    ++counts.pair_tests;
+
+    if (narrowphase == NARROWPHASE_SWEPT) {
+        return sweep(lhs.contour, rhs.contour, lhs_center, rhs_center, rhs_motion, toi,
+                     &counts.bbox_rejects);
+    }
+
+    toi = 1.f;
+
+    if (narrowphase == NARROWPHASE_EDGES) {
+        return intersect_edges_batched(lhs.contour, rhs.contour, lhs_center, rhs_center,
+                                       &counts.bbox_rejects, &counts.segment_tests);
+    }
+
+    if (narrowphase == NARROWPHASE_MASK)
+        return intersect(lhs.mask, rhs.mask, lhs_center, rhs_center, &counts.bbox_rejects);
+
+    return intersect(lhs.contour, rhs.contour, lhs_center, rhs_center, &counts.bbox_rejects);
+}
+
+// The rocket is hit by the asteroid that touches it first during the tick.
+bool Game::is_there_collision() {
+    const Vector controller_motion = controller_pos - prev_controller_pos;
+
+    size_t hit = asteroids.count();
+    f32 first_toi = INFINITY;
+
+    for (size_t i = asteroids.count(); i-- > 0;) {
+        if (asteroids.destroyed[i])
+            continue;
+
+        if (asteroids.y[i] < size.height / 2)
+            continue;
+
+        f32 toi;
+
+        if (collide(spirits.asteroid, spirits.controller, asteroids.pos(i),
+                    controller_pos, controller_motion - asteroids.motion(i), toi,
+                    tick_counts) &&
+            toi < first_toi) {
+            hit = i;
+            first_toi = toi;
+        }
+    }
+
+    if (hit == asteroids.count())
+        return false;
+
+    controller_downspeed = 3.f * asteroids.speed[hit];
+    return true;
+}
+
+void Game::controller_move(const f32 shift, const Input& input) {
+    if (State == GAME_OVER) {
+        controller_pos.y += shift * controller_downspeed;
+        return;
+    }
+
+    const f32 frames = shift * f32(MOVE_INTERVAL) / REFERENCE_FRAME_INTERVAL;
+
+    auto accelerate = [frames](f32& acceleration) {
+        if (acceleration < 1.5)
+            acceleration += 1.125f * frames;
+        else if (acceleration < 3)
+            acceleration += 0.75f * frames;
+        else if (acceleration < 5)
+            acceleration += 0.375f * frames;
+        else if (acceleration < 15)
+            acceleration += 0.25f * frames;
+    };
+
+    auto decelerate = [frames](f32& acceleration, f32 step) {
+        acceleration = std::max(0.f, acceleration - step * frames);
+    };
+
+    bound_left = size.width / 5;
+    bound_right = size.width - bound_left;
+
+    if (input.left && controller_pos.x > bound_left) {
+        accelerate(accel_left);
+        decelerate(accel_right, 1.f);
+    }
+    else if (input.right && controller_pos.x < bound_right) {
+        accelerate(accel_right);
+        decelerate(accel_left, 1.f);
+    }
+    else {
+        decelerate(accel_right, 0.75f);
+        decelerate(accel_left, 0.75f);
+    }
+
+    controller_pos.x += (accel_right - accel_left) * shift * 0.4f;
+}
+
+void Game::asteroids_move(const f32 shift) {
+    asteroids.move(shift);
+}
+
+void Game::bullets_move(const f32 shift) {
+    bullets.move(shift);
+}
+
+void Game::game_over_move(const f32 shift) {
+    if (State == GAME_OVER && game_over_progress < 1.f)
+        game_over_progress += shift / 128.f;
+
+    if (State == FADE_IN && fade_in_progress < 1.f)
+        fade_in_progress += shift / 128.f;
+}
+
+// Asteroids and bullets remember theirs in `EntityPool::move`.
+void Game::remember_positions() {
+    prev_controller_pos = controller_pos;
+}
+
+void Game::update_motion(const Input& input) {
+    asteroids_move(shift);
+    controller_move(shift, input);
+    bullets_move(shift);
+    game_over_move(shift);
+}
+
+void Game::collect_garbage() {
+    asteroids.remove_if([this](size_t i) {
+        return !asteroid_visible(asteroids.y[i]) || asteroids.size[i] < 0.1f;
+    });
+
+    bullets.remove_if([this](size_t i) {
+        return !bullet_visible(bullets.y[i]) || bullets.size[i] < 0.1f;
+    });
+}
+
+void Game::compute_penalty() {
+    f32 paint_blue_bound = size.width / 5;
+    f32 penalty_bound = size.width / 3;
+
+    penalty = std::max(penalty_bound - controller_pos.x,
+                       controller_pos.x + penalty_bound - size.width);
+    paint_blue = fabsf(controller_pos.x - size.width / 2);
+
+    if (penalty > 0.f)
+        penalty = penalty / penalty_bound;
+    else
+        penalty = 0.f;
+
+    if (paint_blue < paint_blue_bound)
+        paint_blue = 1.f - paint_blue / paint_blue_bound;
+    else
+        paint_blue = 0.f;
+
+    if (penalty_timer.get_intervals_count(true)) {
+        if (penalty == 0)
+            penalty_points_total = 0;
+        else if (State == GAME_PLAY) {
+            i32 penalty_points_unit = (i32) std::floor(penalty * 5.f);
+            penalty_points_total += penalty_points_unit;
+            score -= penalty_points_unit;
+        }
+    }
+}
+
+void Game::destroy_asteroids() {
+    const f32 shrink = 0.05f * shift * f32(MOVE_INTERVAL) / REFERENCE_FRAME_INTERVAL;
+
+    asteroids.shrink_destroyed(shrink);
+    bullets.shrink_destroyed(shrink);
+
+    if (broadphase == BROADPHASE_GRID)
+        destroy_asteroids_grid();
+    else
+        destroy_asteroids_nested();
+}
+
+void Game::destroy_asteroids_nested() {
+    for (size_t i = asteroids.count(); i-- > 0;) {
+        if (asteroids.destroyed[i])
+            continue;
+
+        const Vector a = asteroids.pos(i);
+        const Vector a_motion = asteroids.motion(i);
+
+        size_t hit = bullets.count();
+        f32 first_toi = INFINITY;
+
+        for (size_t j = bullets.count(); j-- > 0;) {
+            if (bullets.destroyed[j] || !bullet_can_destroy(bullets.y[j]))
+                continue;
+
+            f32 toi;
+
+            if (collide(spirits.asteroid, spirits.bullet, a, bullets.pos(j),
+                        bullets.motion(j) - a_motion, toi, tick_counts) &&
+                toi < first_toi) {
+                hit = j;
+                first_toi = toi;
+            }
+        }
+
+        if (hit < bullets.count()) {
+            asteroids.destroy(i);
+            bullets.destroy(hit);
+            score += 5;
+        }
+    }
+}
+
+// A bullet further than this from an asteroid on either axis fails the
+// bounding box check in `intersect`, so the grid candidates are a superset of
+// the hits. Masks are whole pixels snapped to the grid of the other mask, so
+// they may stick out of the outer rectangle of the contour by up to 1.5.
+Vector Game::bullet_reach() const {
+    const f32 snapping = narrowphase == NARROWPHASE_MASK ? 2.f : 0.f;
+
+    return spirits.asteroid.contour.half_of_sides + spirits.bullet.contour.half_of_sides +
+           Vector(snapping, snapping);
+}
+
+Vector Game::build_bullet_grid() {
+    const Vector reach = bullet_reach();
+
+    bullet_grid.build(2 * std::max(reach.x, reach.y), u32(bullets.count()),
+                      [this](u32 i) { return bullets.pos(i); });
+
+    return reach;
+}
+
+// A swept pair may touch anywhere along its relative motion, so the query
+// grows by as much as an asteroid and a bullet cover in a tick.
+Vector Game::query_reach(const Vector& reach, const Vector& asteroid_motion) const {
+    const f32 travel = narrowphase == NARROWPHASE_SWEPT
+                     ? shift * BULLET_SPEED + fabsf(asteroid_motion.y) : 0.f;
+
+    return reach + Vector(0.f, travel);
+}
+
+// Same pairing as the nested loop (each asteroid is destroyed by the live
+// bullet that touches it first, the newest one on a tie), but only bullets
+// from nearby grid cells are tested.
+void Game::destroy_asteroids_grid() {
+    const Vector reach = build_bullet_grid();
+
+    for (size_t i = asteroids.count(); i-- > 0;) {
+        if (asteroids.destroyed[i])
+            continue;
+
+        const Vector a = asteroids.pos(i);
+        const Vector a_motion = asteroids.motion(i);
+        const Vector query = query_reach(reach, a_motion);
+
+        // Bullets are stored oldest first, so on a tie the newest one is the
+        // largest index.
+        u32 hit = u32(bullets.count());
+        f32 first_toi = INFINITY;
+
+        bullet_grid.query(a - query, a + query, [&](u32 j) {
+            if (bullets.destroyed[j] || !bullet_can_destroy(bullets.y[j]))
+                return;
+
+            f32 toi;
+
+            if (!collide(spirits.asteroid, spirits.bullet, a, bullets.pos(j),
+                         bullets.motion(j) - a_motion, toi, tick_counts)) {
+                return;
+            }
+
+            if (toi < first_toi || (toi == first_toi && j > hit)) {
+                hit = j;
+                first_toi = toi;
+            }
+        });
+
+        if (hit < bullets.count()) {
+            asteroids.destroy(i);
+            bullets.destroy(hit);
+            score += 5;
+        }
+    }
+}
+
+// Splits the live asteroids into `regions` vertical strips of equal width.
+void Game::bin_asteroids(u32 regions) {
+    hit_regions.resize(regions);
+
+    for (auto& region : hit_regions)
+        region.asteroids.clear();
+
+    f32 min_x = INFINITY, max_x = -INFINITY;
+
+    for (size_t i = 0; i < asteroids.count(); ++i) {
+        min_x = std::min(min_x, asteroids.x[i]);
+        max_x = std::max(max_x, asteroids.x[i]);
+    }
+
+    const f32 strips_per_unit = max_x > min_x ? f32(regions) / (max_x - min_x) : 0.f;
+
+    hit_region_of.resize(asteroids.count());
+    hit_slot_of.resize(asteroids.count());
+
+    for (size_t i = 0; i < asteroids.count(); ++i) {
+        if (asteroids.destroyed[i])
+            continue;
+
+        const u32 r = std::min(regions - 1, u32((asteroids.x[i] - min_x) * strips_per_unit));
+
+        hit_region_of[i] = r;
+        hit_slot_of[i] = u32(hit_regions[r].asteroids.size());
+        hit_regions[r].asteroids.push_back(u32(i));
+    }
+}
+
+// The read-only half of `destroy_asteroids_grid`: every bullet that could
+// destroy each asteroid of the region, ordered as the serial pass would pick
+// them (earliest first, the newest on a tie). Runs on many threads at once.
+void Game::find_hits(HitRegion& region) const {
+    const Vector reach = bullet_reach();
+
+    region.first.clear();
+    region.candidates.clear();
+    region.counts = {};
+
+    for (u32 i : region.asteroids) {
+        const u32 first = u32(region.candidates.size());
+        region.first.push_back(first);
+
+        const Vector a = asteroids.pos(i);
+        const Vector a_motion = asteroids.motion(i);
+        const Vector query = query_reach(reach, a_motion);
+
+        bullet_grid.query(a - query, a + query, [&](u32 j) {
+            if (bullets.destroyed[j] || !bullet_can_destroy(bullets.y[j]))
+                return;
+
+            f32 toi;
+
+            if (collide(spirits.asteroid, spirits.bullet, a, bullets.pos(j),
+                        bullets.motion(j) - a_motion, toi, region.counts)) {
+                region.candidates.push_back({ j, toi });
+            }
+        });
+
+        std::sort(region.candidates.begin() + first, region.candidates.end(),
+                  [](const HitCandidate& lhs, const HitCandidate& rhs) {
+                      return lhs.toi < rhs.toi || (lhs.toi == rhs.toi && lhs.bullet > rhs.bullet);
+                  });
+    }
+
+    region.first.push_back(u32(region.candidates.size()));
+}
+
+// The serial half: asteroids newest first, as in `destroy_asteroids_grid`,
+// each taking its first candidate not already taken by a newer asteroid.
+void Game::apply_hits() {
+    for (const auto& region : hit_regions)
+        tick_counts += region.counts;
+
+    for (size_t i = asteroids.count(); i-- > 0;) {
+        if (asteroids.destroyed[i])
+            continue;
+
+        const HitRegion& region = hit_regions[hit_region_of[i]];
+        const u32 slot = hit_slot_of[i];
+
+        for (u32 c = region.first[slot]; c < region.first[slot + 1]; ++c) {
+            const u32 j = region.candidates[c].bullet;
+
+            if (bullets.destroyed[j])
+                continue;
+
+            asteroids.destroy(i);
+            bullets.destroy(j);
+            score += 5;
+            break;
+        }
+    }
+}
+
+bool Game::start_level(i32 level) {
+    State = FADE_IN;
+    reset_controller_pos();
+    asteroids.clear();
+    bullets.clear();
+    game_over_progress = 0.f;
+    fade_in_progress = 0.f;
+    controller_downspeed = 0.f;
+    penalty_points_total = 0;
+    score = 0;
+    bullet_forbidden = false;
+    difficulty = level;
+
+    return set_asteroid_frequency();
+}
+
+// Transitions between the screens of the game. They used to be driven from
+// the painting code; they live here so that headless runs go through them too.
+bool Game::update_state(const Input& input) {
+    if (State == GAME_OVER && game_over_progress >= 1.f) {
+        State = FADE_OUT;
+
+        if (!fade_out_timer.Init(FADE_OUT_INTERVAL, clock))
+            return false;
+    }
+    else if (State == FADE_IN && fade_in_progress >= 1.f) {
+        State = GAME_PLAY;
+        fade_in_progress = 0.f;
+    }
+    else if (State == FADE_OUT) {
+        fade_out_timer.update(clock);
+
+        if (fade_out_timer.get_intervals_count(false)) {
+            State = CHOOSE_NEW_LEVEL;
+            typewriter_animation.Init(L"CHOOSE NEXT LEVEL DIFFICULTY");
+            chosen_next_difficulty = -1;
+
+            if (!typewriter_timer.Init(TYPE_SPEED, clock))
+                return false;
+        }
+    }
+    else if (State == CHOOSE_NEW_LEVEL) {
+        if (input.level >= 1 && input.level <= 6)
+            chosen_next_difficulty = input.level;
+
+        typewriter_timer.update(clock);
+
+        if (typewriter_timer.get_intervals_count(true))
+            typewriter_animation.next_frame();
+
+        if (!typewriter_animation.is_frame_left() && chosen_next_difficulty != -1)
+            return start_level(chosen_next_difficulty);
+    }
+
+    return true;
+}
+
+bool Game::update_scene(const Input& input) {
+    TRACE_SCOPE("Game::update_scene");
+
+    ++tick;
+    clock.now += 1000;
+
+    new_asteroid_timer.update(clock);
+    new_bullet_timer.update(clock);
+    penalty_timer.update(clock);
+
+    remember_positions();
+
+    tick_counts = {};
+    PhaseTimes times(profiler != nullptr);
+
+    if (jobs && broadphase == BROADPHASE_GRID &&
+        asteroids.count() + bullets.count() >= PARALLEL_MIN_ENTITIES) {
+        update_scene_parallel(input, times);
+    } else {
+        times.counters = counters;
+        u64 start = times.start();
+
+        update_motion(input);
+        start = times.add(PHASE_MOTION, start);
+
+        new_asteroids();
+        new_bullets(input);
+        start = times.add(PHASE_SPAWN, start);
+
+        compute_penalty();
+        start = times.add(PHASE_MOTION, start);
+
+        if (State == GAME_PLAY)
+            if (is_there_collision()) {
+                State = GAME_OVER;
+            }
+
+        destroy_asteroids();
+        start = times.add(PHASE_COLLISION, start);
+
+        collect_garbage();
+        times.add(PHASE_GC, start);
+    }
+
+    if (profiler)
+        profiler->record(times);
+
+    const bool result = update_state(input);
+
+    if (flight_recorder)
+        flight_recorder->record_tick(*this, input, times);
+
+    if (live_counters)
+        live_counters->record_tick(*this);
+
+    return result;
+}
+
+// The phases of `update_scene` as a task graph. Every arrow joins phases that
+// touch the same data, in the order of the serial tick:
+//
+//   move asteroids (chunks) --> new_asteroids --+--> collision ------------+
+//   controller, penalty ------------------------+                          |
+//                  |                            |                          v
+//   move bullets (chunks) ----> new_bullets ----+--> bin --> find_hits --> apply_hits
+//                                                            (regions)     |
+//                                                                          v
+//                                                                     collect_garbage
+//
+// The hits are applied serially in the same order as in
+// `destroy_asteroids_grid`, so how the work was split changes nothing. The
+// time of a phase is that of all its tasks together, whichever thread ran
+// them.
+void Game::update_scene_parallel(const Input& input, PhaseTimes& times) {
+    const u32 chunks = jobs->chunk_count();
+
+    TaskGraph graph;
+
+    const auto move_asteroids = graph.add_chunks(chunks, [this, chunks, &times](u32 chunk) {
+        const u64 start = times.start();
+        const size_t n = asteroids.count();
+        asteroids.move(shift, n * chunk / chunks, n * (chunk + 1) / chunks);
+        times.add(PHASE_MOTION, start);
+    });
+
+    const auto move_bullets = graph.add_chunks(chunks, [this, chunks, &times](u32 chunk) {
+        const u64 start = times.start();
+        const size_t n = bullets.count();
+        bullets.move(shift, n * chunk / chunks, n * (chunk + 1) / chunks);
+        times.add(PHASE_MOTION, start);
+    });
+
+    const auto controller = graph.add([this, &input, &times] {
+        const u64 start = times.start();
+        controller_move(shift, input);
+        game_over_move(shift);
+        compute_penalty();
+        times.add(PHASE_MOTION, start);
+    });
+
+    const auto spawn_asteroids = graph.add([this, &times] {
+        const u64 start = times.start();
+        new_asteroids();
+        times.add(PHASE_SPAWN, start);
+    });
+
+    const auto spawn_bullets = graph.add([this, &input, &times] {
+        const u64 start = times.start();
+        new_bullets(input);
+        times.add(PHASE_SPAWN, start);
+    });
+
+    const auto collision = graph.add([this, &times] {
+        const u64 start = times.start();
+
+        if (State == GAME_PLAY && is_there_collision())
+            State = GAME_OVER;
+
+        times.add(PHASE_COLLISION, start);
+    });
+
+    const auto bin = graph.add([this, chunks, &times] {
+        const u64 start = times.start();
+        const f32 shrink = 0.05f * shift * f32(MOVE_INTERVAL) / REFERENCE_FRAME_INTERVAL;
+
+        asteroids.shrink_destroyed(shrink);
+        bullets.shrink_destroyed(shrink);
+
+        build_bullet_grid();
+        bin_asteroids(chunks);
+        times.add(PHASE_COLLISION, start);
+    });
+
+    const auto hits = graph.add_chunks(chunks, [this, &times](u32 region) {
+        const u64 start = times.start();
+        find_hits(hit_regions[region]);
+        times.add(PHASE_COLLISION, start);
+    });
+
+    const auto apply = graph.add([this, &times] {
+        const u64 start = times.start();
+        apply_hits();
+        times.add(PHASE_COLLISION, start);
+    });
+
+    const auto garbage = graph.add([this, &times] {
+        const u64 start = times.start();
+        collect_garbage();
+        times.add(PHASE_GC, start);
+    });
+
+    graph.precede(move_asteroids, spawn_asteroids);
+    graph.precede(move_bullets, spawn_bullets);
+    graph.precede(controller, spawn_bullets);
+
+    graph.precede(spawn_asteroids, collision);
+    graph.precede(spawn_bullets, collision);
+    graph.precede(controller, collision);
+
+    graph.precede(spawn_asteroids, bin);
+    graph.precede(spawn_bullets, bin);
+    graph.precede(bin, hits);
+
+    graph.precede(hits, apply);
+    graph.precede(collision, apply);
+    graph.precede(apply, garbage);
+
+    jobs->run(graph);
+}
+
+u64 Game::checksum() const {
+    u64 hash = 0xcbf29ce484222325; // FNV-1a
+
+    auto mix = [&hash](u64 value) {
+        for (u32 i = 0; i < 8; ++i, value >>= 8) {
+            hash ^= value & 0xff;
+            hash *= 0x100000001b3;
+        }
+    };
+
+    auto mix_vector = [&mix](const Vector& v) {
+        mix(std::bit_cast<u32>(v.x));
+        mix(std::bit_cast<u32>(v.y));
+    };
+
+    mix(tick);
+    mix(u64(State));
+    mix(u64(i64(score)));
+    mix_vector(controller_pos);
+
+    // Newest first, as the entities were hashed when they lived in deques.
+    auto mix_pool = [&](const EntityPool& pool) {
+        for (size_t i = pool.count(); i-- > 0;) {
+            mix_vector(pool.pos(i));
+            mix(pool.destroyed[i]);
+            mix(std::bit_cast<u32>(pool.size[i]));
+        }
+    };
+
+    mix_pool(asteroids);
+    mix_pool(bullets);
+
+    return hash;
+}
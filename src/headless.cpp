@@ -0,0 +1,554 @@
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <algorithm>
+#include <filesystem>
+
+#include "common.hpp"
+#include "timer.hpp"
+#include "game.hpp"
+#include "replay.hpp"
+#include "autopilot.hpp"
+#include "job_system.hpp"
+#include "renderer.hpp"
+#include "soft_renderer.hpp"
+#include "blend_kernel.hpp"
+#include "frame_profiler.hpp"
+#include "trace.hpp"
+#include "flight_recorder.hpp"
+#include "live_counters.hpp"
+#include "counter_server.hpp"
+#include "alloc_counter.hpp"
+
+// Steps the game without any window, as fast as the CPU allows. Time and
+// keyboard are injected: the clock advances by a fixed amount per frame, the
+// frame is turned into game ticks just like in the windowed game, and a crude
+// autopilot decides which keys are held. The inputs can be recorded, and a
+// recording can be played back instead of the autopilot, as fast as possible.
+// Frames can also be painted by the software renderer, to measure what a
+// frame costs without any GPU, and written to disk. With `--profile`, every
+// phase of the ticks and frames goes into a histogram, printed at the end and
+// written out as CSV (or JSON, for a .json file). With `--trace`, the run is
+// written out as a Chrome trace (chrome://tracing, ui.perfetto.dev). The last
+// frames are always kept by a flight recorder, dumped when one takes longer
+// than `--hitch-us`. With `--counters`, the live counters of the run are served
+// on a Unix domain socket, for tools/counters_poll.cpp to watch.
+
+namespace {
+    struct Options {
+        u64 frames = 1'000'000;
+        u32 seed = 1;
+        i32 difficulty = 1;
+        i64 frame_us = 16'667;
+        u32 tick_rate = Game::DEFAULT_TICK_RATE;
+        f32 width = 1166;
+        f32 height = 568;
+        std::filesystem::path record_path;
+        std::filesystem::path play_path;
+        Game::NarrowphaseKind narrowphase = Game::NARROWPHASE_SWEPT;
+        u32 threads = 1;
+        bool render = false;
+        std::filesystem::path root = ".";
+        std::filesystem::path dump_dir;
+        u64 dump_every = 60;
+        std::filesystem::path profile_path;
+        std::filesystem::path trace_path;
+        u64 hitch_us = 0;
+        std::filesystem::path hitch_dir = ".";
+        std::filesystem::path counters_path;
+    };
+
+    void usage() {
+        std::wcout << L"Usage: asteroids_headless [--frames N] [--seed S] [--difficulty 1-6]\n"
+                   << L"                          [--frame-us US] [--tick-rate HZ]\n"
+                   << L"                          [--width W] [--height H]\n"
+                   << L"                          [--record FILE] [--play FILE]\n"
+                   << L"                          [--narrowphase swept|sat|edges|mask]\n"
+                   << L"                          [--threads N (0: one per core)]\n"
+                   << L"                          [--render none|soft] [--root DIR]\n"
+                   << L"                          [--dump-frames DIR] [--dump-every N]\n"
+                   << L"                          [--profile FILE.csv|FILE.json]\n"
+                   << L"                          [--trace FILE.json]\n"
+                   << L"                          [--hitch-us US] [--hitch-dir DIR]\n"
+                   << L"                          [--counters SOCKET]\n";
+    }
+
+    bool parse_options(int argc, char** argv, Options& options) {
+        for (int i = 1; i < argc; ++i) {
+            if (i + 1 >= argc) {
+                usage();
+                return false;
+            }
+
+            const char* name = argv[i];
+            const char* value = argv[++i];
+
+            if (!strcmp(name, "--frames"))
+                options.frames = std::strtoull(value, nullptr, 10);
+            else if (!strcmp(name, "--seed"))
+                options.seed = u32(std::strtoul(value, nullptr, 10));
+            else if (!strcmp(name, "--difficulty"))
+                options.difficulty = i32(std::strtol(value, nullptr, 10));
+            else if (!strcmp(name, "--frame-us"))
+                options.frame_us = std::strtoll(value, nullptr, 10);
+            else if (!strcmp(name, "--tick-rate"))
+                options.tick_rate = u32(std::strtoul(value, nullptr, 10));
+            else if (!strcmp(name, "--width"))
+                options.width = std::strtof(value, nullptr);
+            else if (!strcmp(name, "--height"))
+                options.height = std::strtof(value, nullptr);
+            else if (!strcmp(name, "--record"))
+                options.record_path = value;
+            else if (!strcmp(name, "--play"))
+                options.play_path = value;
+            else if (!strcmp(name, "--threads"))
+                options.threads = u32(std::strtoul(value, nullptr, 10));
+            else if (!strcmp(name, "--render") && !strcmp(value, "none"))
+                options.render = false;
+            else if (!strcmp(name, "--render") && !strcmp(value, "soft"))
+                options.render = true;
+            else if (!strcmp(name, "--root"))
+                options.root = value;
+            else if (!strcmp(name, "--dump-frames"))
+                options.dump_dir = value;
+            else if (!strcmp(name, "--profile"))
+                options.profile_path = value;
+            else if (!strcmp(name, "--trace"))
+                options.trace_path = value;
+            else if (!strcmp(name, "--hitch-us"))
+                options.hitch_us = std::strtoull(value, nullptr, 10);
+            else if (!strcmp(name, "--hitch-dir"))
+                options.hitch_dir = value;
+            else if (!strcmp(name, "--counters"))
+                options.counters_path = value;
+            else if (!strcmp(name, "--dump-every"))
+                options.dump_every = std::strtoull(value, nullptr, 10);
+            else if (!strcmp(name, "--narrowphase") && !strcmp(value, "swept"))
+                options.narrowphase = Game::NARROWPHASE_SWEPT;
+            else if (!strcmp(name, "--narrowphase") && !strcmp(value, "sat"))
+                options.narrowphase = Game::NARROWPHASE_SAT;
+            else if (!strcmp(name, "--narrowphase") && !strcmp(value, "edges"))
+                options.narrowphase = Game::NARROWPHASE_EDGES;
+            else if (!strcmp(name, "--narrowphase") && !strcmp(value, "mask"))
+                options.narrowphase = Game::NARROWPHASE_MASK;
+            else {
+                usage();
+                return false;
+            }
+        }
+
+        if (options.difficulty < 1 || options.difficulty > 6 || options.frame_us <= 0 ||
+            options.tick_rate == 0 || options.dump_every == 0 ||
+            (!options.dump_dir.empty() && !options.render)) {
+            usage();
+            return false;
+        }
+
+        return true;
+    }
+
+    struct Stats {
+        u64 ticks = 0;
+        u64 game_overs = 0;
+        size_t max_asteroids = 0;
+        size_t max_bullets = 0;
+    };
+
+    bool step(Game& game, const Input& input, ReplayWriter* recorder, Stats& stats) {
+        auto previous_state = game.State;
+
+        if (!game.update_scene(input)) {
+            std::wcout << L"Error while updating scene\n";
+            return false;
+        }
+
+        if (recorder && !recorder->record(input)) {
+            std::wcout << L"Cannot write the replay\n";
+            return false;
+        }
+
+        if (game.State == Game::GAME_OVER && previous_state != Game::GAME_OVER)
+            ++stats.game_overs;
+
+        ++stats.ticks;
+        stats.max_asteroids = std::max(stats.max_asteroids, game.asteroids.count());
+        stats.max_bullets = std::max(stats.max_bullets, game.bullets.count());
+
+        return true;
+    }
+
+    void print_stats(const Game& game, const Stats& stats, f64 elapsed) {
+        std::wcout << L"ticks:           " << stats.ticks << L'\n'
+                   << L"ticks/s:         " << f64(stats.ticks) / elapsed << L'\n'
+                   << L"game overs:      " << stats.game_overs << L'\n'
+                   << L"max asteroids:   " << stats.max_asteroids << L'\n'
+                   << L"max bullets:     " << stats.max_bullets << L'\n'
+                   << L"final score:     " << game.score << L'\n'
+                   << L"state checksum:  " << std::hex << game.checksum() << std::dec << L'\n';
+    }
+
+    struct RenderStats {
+        u64 frames = 0;
+        u64 commands = 0;
+        u64 dumped = 0;
+        f64 total_s = 0;
+        f64 max_s = 0;
+
+        // Startup of the renderer, and whether the sprites were mapped.
+        f64 init_s = 0;
+        bool packed = false;
+    };
+
+    // Paints the frame in between the last two ticks, and writes it to
+    // `dump_dir` every `dump_every` frames.
+    bool render_frame(const Options& options, const Game& game, f32 alpha, u64 frame,
+                      ScenePainter& painter, SoftRenderer& renderer, RenderStats& stats,
+                      PhaseTimes& times) {
+        auto start = std::chrono::steady_clock::now();
+        const u64 paint_start = times.start();
+
+        renderer.begin_frame();
+        painter.paint(renderer, game, alpha);
+        renderer.end_frame();
+
+        times.add(PHASE_PAINT, paint_start);
+
+        std::chrono::duration<f64> elapsed = std::chrono::steady_clock::now() - start;
+
+        ++stats.frames;
+        stats.commands += renderer.get_commands().size();
+        stats.total_s += elapsed.count();
+        stats.max_s = std::max(stats.max_s, elapsed.count());
+
+        if (options.dump_dir.empty() || frame % options.dump_every)
+            return true;
+
+        std::string name = std::to_string(frame);
+        name = "frame_" + std::string(name.size() < 8 ? 8 - name.size() : 0, '0') + name + ".png";
+
+        if (!renderer.dump(options.dump_dir / name)) {
+            std::wcout << L"Cannot write " << (options.dump_dir / name).wstring() << L'\n';
+            return false;
+        }
+
+        ++stats.dumped;
+        return true;
+    }
+
+    void print_render_stats(const RenderStats& stats) {
+        const f64 frames = f64(std::max<u64>(stats.frames, 1));
+
+        std::wcout << L"sprites from:    " << (stats.packed ? ASSET_PACK_PATH : L"PNG") << L'\n'
+                   << L"render init ms:  " << stats.init_s * 1e3 << L'\n'
+                   << L"blend kernel:    " << blend_kernel_name() << L'\n'
+                   << L"render ms/frame: " << stats.total_s * 1e3 / frames << L'\n'
+                   << L"render max ms:   " << stats.max_s * 1e3 << L'\n'
+                   << L"draws/frame:     " << f64(stats.commands) / frames << L'\n'
+                   << L"frames dumped:   " << stats.dumped << L'\n';
+    }
+
+    // Prints the histograms of `--profile`, and writes them to its file.
+    bool dump_profile(const Options& options, const FrameProfiler& profiler) {
+        std::wcout << L'\n';
+        profiler.print(std::wcout);
+
+        return profiler.write(options.profile_path);
+    }
+
+    // Traces the run if asked to, from the first tick to `finish_trace`.
+    void start_trace(const Options& options) {
+        trace_thread_name("main");
+
+        if (!options.trace_path.empty())
+            trace_start();
+    }
+
+    bool finish_trace(const Options& options) {
+        return options.trace_path.empty() || trace_stop(options.trace_path);
+    }
+
+    // Serves the counters of `game` at `--counters`, if asked to.
+    bool serve_counters(const Options& options, Game& game, LiveCounters& counters,
+                        CounterServer& server) {
+        if (options.counters_path.empty())
+            return true;
+
+        if (!server.Init(options.counters_path, counters))
+            return false;
+
+        game.live_counters = &counters;
+        return true;
+    }
+
+    // Hands the ticks with many entities to `options.threads` threads.
+    bool start_threads(const Options& options, JobSystem& jobs, Game& game) {
+        if (options.threads == 1)
+            return true;
+
+        if (!jobs.Init(options.threads)) {
+            std::wcout << L"Cannot start the worker threads\n";
+            return false;
+        }
+
+        game.jobs = &jobs;
+        return true;
+    }
+
+    // Feeds the recorded inputs tick by tick, with no clock at all.
+    int play(const Options& options) {
+        ReplayReader replay;
+
+        if (!replay.Init(options.play_path)) {
+            std::wcout << L"Cannot read replay " << options.play_path.wstring() << L'\n';
+            return -1;
+        }
+
+        const ReplayHeader& header = replay.get_header();
+        Game game;
+        game.narrowphase = header.narrowphase;
+
+        FrameProfiler profiler;
+
+        if (!options.profile_path.empty())
+            game.profiler = &profiler;
+
+        JobSystem jobs;
+
+        if (!start_threads(options, jobs, game))
+            return -1;
+
+        if (!game.Init(header.size, header.seed, header.tick_rate)) {
+            std::wcout << L"Cannot initialize the game\n";
+            return -1;
+        }
+
+        if (header.start_level && !game.start_level(header.start_level)) {
+            std::wcout << L"Cannot start level " << header.start_level << L'\n';
+            return -1;
+        }
+
+        LiveCounters counters;
+        CounterServer server;
+
+        if (!serve_counters(options, game, counters, server))
+            return -1;
+
+        Stats stats;
+        Input input;
+
+        start_trace(options);
+        auto start = std::chrono::steady_clock::now();
+
+        while (replay.next(input)) {
+            if (!step(game, input, nullptr, stats))
+                return -1;
+        }
+
+        if (!finish_trace(options))
+            return -1;
+
+        std::chrono::duration<f64> elapsed = std::chrono::steady_clock::now() - start;
+
+        std::wcout << L"simulated time:  " << f64(stats.ticks) / f64(header.tick_rate) << L" s\n"
+                   << L"wall time:       " << elapsed.count() << L" s\n";
+
+        print_stats(game, stats, elapsed.count());
+
+        if (game.profiler && !dump_profile(options, profiler))
+            return -1;
+
+        return 0;
+    }
+
+    int simulate(const Options& options) {
+        Clock clock {
+            .frequency = 1'000'000,
+            .now = 0,
+        };
+
+        const SizeF size { options.width, options.height };
+
+        Game game;
+        game.narrowphase = options.narrowphase;
+
+        FrameProfiler profiler;
+
+        if (!options.profile_path.empty())
+            game.profiler = &profiler;
+
+        JobSystem jobs;
+
+        if (!start_threads(options, jobs, game))
+            return -1;
+
+        FixedTimestep timestep;
+
+        if (!game.Init(size, options.seed, options.tick_rate) ||
+            !timestep.Init(options.tick_rate, Game::MAX_CATCH_UP_TICKS, clock)) {
+            std::wcout << L"Cannot initialize the game\n";
+            return -1;
+        }
+
+        if (!game.start_level(options.difficulty)) {
+            std::wcout << L"Cannot start level " << options.difficulty << L'\n';
+            return -1;
+        }
+
+        ReplayWriter recorder;
+
+        if (!options.record_path.empty()) {
+            ReplayHeader header {
+                .seed = options.seed,
+                .tick_rate = options.tick_rate,
+                .start_level = options.difficulty,
+                .size = size,
+                .narrowphase = options.narrowphase,
+            };
+
+            if (!recorder.Init(options.record_path, header)) {
+                std::wcout << L"Cannot create replay " << options.record_path.wstring() << L'\n';
+                return -1;
+            }
+        }
+
+        ReplayWriter* record = options.record_path.empty() ? nullptr : &recorder;
+
+        ScenePainter painter;
+        SoftRenderer renderer;
+        RenderStats render_stats;
+
+        // The sprites are decoded, and the frame tiles composited, on the same
+        // threads as the ticks.
+        renderer.jobs = game.jobs;
+
+        const auto init_start = std::chrono::steady_clock::now();
+
+        if (options.render &&
+            !renderer.Init(options.root, u32(std::lround(size.width)),
+                           u32(std::lround(size.height)))) {
+            std::wcout << L"Cannot initialize the software renderer\n";
+            return -1;
+        }
+
+        render_stats.init_s = std::chrono::duration<f64>(std::chrono::steady_clock::now() -
+                                                         init_start).count();
+        render_stats.packed = renderer.sprites_packed();
+
+        if (!options.dump_dir.empty()) {
+            std::error_code error;
+            std::filesystem::create_directories(options.dump_dir, error);
+
+            if (error) {
+                std::wcout << L"Cannot create " << options.dump_dir.wstring() << L'\n';
+                return -1;
+            }
+        }
+
+        if (options.hitch_us) {
+            std::error_code error;
+            std::filesystem::create_directories(options.hitch_dir, error);
+
+            if (error) {
+                std::wcout << L"Cannot create " << options.hitch_dir.wstring() << L'\n';
+                return -1;
+            }
+        }
+
+        FlightRecorder flight_recorder;
+
+        if (!flight_recorder.Init(options.hitch_us, options.hitch_dir)) {
+            std::wcout << L"Cannot initialize the flight recorder\n";
+            return -1;
+        }
+
+        game.flight_recorder = &flight_recorder;
+
+        LiveCounters counters;
+        CounterServer server;
+
+        if (!serve_counters(options, game, counters, server))
+            return -1;
+
+        Autopilot autopilot(options.seed + 1);
+        Stats stats;
+
+        start_trace(options);
+        auto start = std::chrono::steady_clock::now();
+
+        for (u64 frame = 0; frame < options.frames; ++frame) {
+            TRACE_SCOPE("frame");
+
+            PhaseTimes times(true);
+            const u64 frame_start = times.start();
+            const u64 frame_bytes = allocated_bytes();
+            clock.now += options.frame_us;
+
+            const Input input = autopilot.next(game, options.difficulty);
+
+            for (u32 i = timestep.advance(); i > 0; --i) {
+                if (!step(game, input, record, stats))
+                    return -1;
+            }
+
+            if (options.render && !render_frame(options, game, timestep.get_alpha(), frame,
+                                                painter, renderer, render_stats, times)) {
+                return -1;
+            }
+
+            times.add(PHASE_FRAME, frame_start);
+
+            if (game.profiler)
+                profiler.record(times);
+
+            if (!flight_recorder.end_frame(times))
+                return -1;
+
+            if (game.live_counters)
+                counters.record_frame(allocated_bytes() - frame_bytes);
+        }
+
+        std::chrono::duration<f64> elapsed = std::chrono::steady_clock::now() - start;
+
+        if (!finish_trace(options) || !flight_recorder.Finish())
+            return -1;
+
+        if (record && !recorder.Finish()) {
+            std::wcout << L"Cannot write the replay\n";
+            return -1;
+        }
+
+        std::wcout << L"frames:          " << options.frames << L'\n'
+                   << L"simulated time:  " << f64(clock.now) / f64(clock.frequency) << L" s\n"
+                   << L"wall time:       " << elapsed.count() << L" s\n"
+                   << L"frames/s:        " << f64(options.frames) / elapsed.count() << L'\n'
+                   << L"dropped ticks:   " << timestep.get_dropped_ticks() << L'\n';
+
+        if (options.hitch_us)
+            std::wcout << L"hitches:         " << flight_recorder.get_hitches() << L'\n';
+
+        print_stats(game, stats, elapsed.count());
+
+        if (options.render)
+            print_render_stats(render_stats);
+
+        if (game.profiler && !dump_profile(options, profiler))
+            return -1;
+
+        return 0;
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+
+    if (!parse_options(argc, argv, options))
+        return -1;
+
+    if (!options.play_path.empty())
+        return play(options);
+
+    return simulate(options);
+}
@@ -0,0 +1,182 @@
+#include "job_system.hpp"
+
+#include <algorithm>
+#include <string>
+
+#include "trace.hpp"
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard lock(wake_mutex);
+        stopping = true;
+    }
+
+    wake.notify_all();
+
+    for (auto& worker : workers)
+        worker.join();
+}
+
+bool JobSystem::Init(u32 threads) {
+    if (!queues.empty())
+        return false;
+
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    for (u32 i = 0; i < threads; ++i)
+        queues.push_back(std::make_unique<Queue>());
+
+    for (u32 i = 1; i < threads; ++i)
+        workers.emplace_back(&JobSystem::worker_main, this, i);
+
+    return true;
+}
+
+void JobSystem::run(TaskGraph& graph_) {
+    const size_t count = graph_.tasks.size();
+
+    if (count == 0)
+        return;
+
+    if (pending_capacity < count) {
+        pending = std::make_unique<std::atomic<u32>[]>(count);
+        pending_capacity = count;
+    }
+
+    graph = &graph_;
+
+    for (size_t i = 0; i < count; ++i)
+        pending[i] = graph_.tasks[i].dependencies;
+
+    remaining = count;
+
+    for (size_t i = 0; i < count; ++i) {
+        if (graph_.tasks[i].dependencies == 0)
+            push(0, TaskGraph::TaskId(i));
+    }
+
+    if (!workers.empty()) {
+        {
+            std::lock_guard lock(wake_mutex);
+            ++epoch;
+        }
+
+        wake.notify_all();
+    }
+
+    work(0);
+}
+
+void JobSystem::worker_main(u32 index) {
+    trace_thread_name("worker " + std::to_string(index));
+
+    u64 seen = 0;
+
+    for (;;) {
+        {
+            std::unique_lock lock(wake_mutex);
+            wake.wait(lock, [&] { return stopping || epoch != seen; });
+
+            if (stopping)
+                return;
+
+            seen = epoch;
+        }
+
+        work(index);
+    }
+}
+
+namespace {
+    // Failed attempts to find a task before going to sleep.
+    constexpr u32 SPIN_LIMIT = 64;
+}
+
+// Runs tasks until the whole graph is done. Tasks made ready go to the queue
+// of this thread.
+void JobSystem::work(u32 index) {
+    u32 misses = 0;
+
+    while (remaining.load() > 0) {
+        TaskGraph::TaskId id;
+
+        if (!next_task(index, id)) {
+            if (++misses < SPIN_LIMIT) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            std::unique_lock lock(idle_mutex);
+            ++sleepers;
+            idle.wait(lock, [this] { return queued.load() > 0 || remaining.load() == 0; });
+            --sleepers;
+
+            misses = 0;
+            continue;
+        }
+
+        misses = 0;
+
+        const TaskGraph::Task& task = graph->tasks[id];
+        task.body();
+
+        for (TaskGraph::TaskId successor : task.successors) {
+            if (--pending[successor] == 0)
+                push(index, successor);
+        }
+
+        if (--remaining == 0 && sleepers.load() > 0) {
+            std::lock_guard lock(idle_mutex);
+            idle.notify_all();
+        }
+    }
+}
+
+bool JobSystem::next_task(u32 index, TaskGraph::TaskId& task) {
+    {
+        Queue& own = *queues[index];
+        std::lock_guard lock(own.mutex);
+
+        if (!own.tasks.empty()) {
+            task = own.tasks.back();
+            own.tasks.pop_back();
+            --queued;
+            return true;
+        }
+    }
+
+    const u32 threads = thread_count();
+
+    for (u32 k = 1; k < threads; ++k) {
+        Queue& victim = *queues[(index + k) % threads];
+        std::lock_guard lock(victim.mutex);
+
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.front();
+            victim.tasks.pop_front();
+            --queued;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void JobSystem::push(u32 index, TaskGraph::TaskId task) {
+    {
+        Queue& queue = *queues[index];
+        std::lock_guard lock(queue.mutex);
+
+        queue.tasks.push_back(task);
+        ++queued;
+    }
+
+    // A thread going to sleep counts itself before it checks `queued`, and
+    // this checks `sleepers` after counting the task, so one of the two sees
+    // the other.
+    if (sleepers.load() > 0) {
+        std::lock_guard lock(idle_mutex);
+        idle.notify_one();
+    }
+}
@@ -0,0 +1,65 @@
+#include "live_counters.hpp"
+
+#include "game.hpp"
+
+namespace {
+    constexpr const char* COUNTER_NAMES[LIVE_COUNTER_COUNT] = {
+        "ticks",
+        "frames",
+        "pair_tests",
+        "bbox_rejects",
+        "segment_tests",
+        "spawned",
+        "reclaimed",
+        "allocated_bytes",
+        "asteroids",
+        "bullets",
+        "dead_asteroids",
+        "dead_bullets",
+        "frame_bytes",
+    };
+}
+
+const char* live_counter_name(LiveCounter counter) {
+    return counter < LIVE_COUNTER_COUNT ? COUNTER_NAMES[counter] : "unknown";
+}
+
+void LiveCounters::record_tick(const Game& game) {
+    tick_totals += game.tick_counts;
+    ++ticks;
+
+    publish(LIVE_TICKS, ticks);
+    publish(LIVE_PAIR_TESTS, tick_totals.pair_tests);
+    publish(LIVE_BBOX_REJECTS, tick_totals.bbox_rejects);
+    publish(LIVE_SEGMENT_TESTS, tick_totals.segment_tests);
+    publish(LIVE_SPAWNED, game.asteroids.spawned + game.bullets.spawned);
+    publish(LIVE_RECLAIMED, game.asteroids.reclaimed + game.bullets.reclaimed);
+
+    publish(LIVE_ASTEROIDS, game.asteroids.count());
+    publish(LIVE_BULLETS, game.bullets.count());
+    publish(LIVE_DEAD_ASTEROIDS, game.asteroids.dead);
+    publish(LIVE_DEAD_BULLETS, game.bullets.dead);
+}
+
+void LiveCounters::record_frame(u64 bytes) {
+    ++frames;
+    allocated += bytes;
+
+    publish(LIVE_FRAMES, frames);
+    publish(LIVE_ALLOCATED_BYTES, allocated);
+    publish(LIVE_FRAME_BYTES, bytes);
+}
+
+std::string LiveCounters::snapshot() const {
+    std::string out;
+
+    for (u32 counter = 0; counter < LIVE_COUNTER_COUNT; ++counter) {
+        out += counter < LIVE_FIRST_GAUGE ? "counter " : "gauge ";
+        out += COUNTER_NAMES[counter];
+        out += ' ';
+        out += std::to_string(values[counter].load(std::memory_order_relaxed));
+        out += '\n';
+    }
+
+    return out;
+}
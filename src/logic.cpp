@@ -3,6 +3,7 @@
 #include <iostream>
 #include <utility>
 #include <cmath>
+#include <random>
 
 #include <d2d1_2.h>
 #include <d3d11.h>
@@ -14,24 +15,12 @@
 #include "window.hpp"
 #include "math.hpp"
 #include "timer.hpp"
-#include "bitmap_helper.hpp"
+#include "trace.hpp"
 
 namespace {
-    constexpr i32 MOVE_INTERVAL = 0'005;
-    constexpr i32 BACKGROUND_INTERVAL = 4'000;
-    constexpr i32 ASTEROID_INTERVAL = 0'600;
-    constexpr i32 NEW_BULLET_INTERVAL = 0'200;
-    constexpr i32 PENALTY_INTERVAL = 0'300;
-    constexpr i32 FADE_OUT_INTERVAL = 2'000;
-    constexpr f32 BULLET_SPEED = 3;
-    constexpr i32 TYPE_SPEED = 0'100;
-
-    constexpr D2D1_COLOR_F reference_bg {
-        .r = 0.10f - 0.075f,
-        .g = 0.10f - 0.075f,
-        .b = 0.20f - 0.075f,
-        .a = 1.f,
-    };
+    D2D1_COLOR_F to_d2d(const ColorF& color) {
+        return { color.r, color.g, color.b, color.a };
+    }
 
     namespace ErrorCollection {
         void com_crash(HRESULT hr) {
@@ -53,28 +42,27 @@ namespace {
             std::wcout << L"Failed to create brush: " << _com_error(hr).ErrorMessage() << L'\n';
         }
 
-        void imaging_factory_crash(HRESULT hr) {
-            std::wcout << L"Failed to create ImagingFactory: " << _com_error(hr).ErrorMessage()
+        void atlas_crash(HRESULT hr) {
+            std::wcout << L"Failed to create the sprite atlas: " << _com_error(hr).ErrorMessage()
                        << L'\n';
         }
 
-        void bitmap_crash(const wchar_t* filename, HRESULT hr) {
-            std::wcout << L"Failed to load bitmap (" << filename << L"): "
-                       << _com_error(hr).ErrorMessage() << L'\n';
-        }
-
         void text_helper_crash() {
             std::wcout << L"Failed to create text helper for drawing text\n";
         }
-    }
-}
 
-void WindowLogic::reset_controller_pos() {
-    controller_pos.x = size.width / 2;
-    controller_pos.y = size.height - 40;
+        void game_crash() {
+            std::wcout << L"Failed to initialize the game\n";
+        }
+
+        void replay_crash(const wchar_t* filename) {
+            std::wcout << L"Failed to create replay file (" << filename << L")\n";
+        }
+    }
 }
 
-bool WindowLogic::Init() {
+bool WindowLogic::Init(const wchar_t* replay_path, const wchar_t* profile_path_,
+                       const wchar_t* trace_path_, u64 hitch_us) {
     HRESULT hr;
     hr = CoInitializeEx(NULL, COINIT_MULTITHREADED);
 
@@ -229,52 +217,49 @@ bool WindowLogic::Init() {
     }
 #endif // PAINT_CONTOUR_DBG
 
-    ComPtr<IWICImagingFactory2> imaging_factory;
+    // The bitmap keeps the default 96 DPI, so its DIPs are its pixels.
+    dpi_factor = f32(dpi) / 96.f;
 
-    hr = CoCreateInstance(
-        CLSID_WICImagingFactory2,
-        nullptr,
-        CLSCTX_INPROC_SERVER,
-        __uuidof(IWICImagingFactory2),
-        &imaging_factory
-    );
-
-    if (hr != S_OK || !imaging_factory) {
-        ErrorCollection::imaging_factory_crash(hr);
-        return false;
-    }
+    if (!pack.Init(ASSET_PACK_PATH) || !pack.load_atlas(dpi_factor, atlas, spirit_sprites)) {
+        std::wcout << L"No packed sprites for " << dpi << L" DPI, decoding the PNGs\n";
 
-    auto load_bitmap = [&](const wchar_t* fname, Microsoft::WRL::ComPtr<ID2D1Bitmap>& bitmap) {
-        auto result = load_bitmap_from_file(*target.Get(), *imaging_factory.Get(), fname);
+        JobSystem loaders;
 
-        if (result.first != S_OK || !result.second) {
-            ErrorCollection::bitmap_crash(fname, result.first);
+        if (!loaders.Init(0) ||
+            !add_spirit_sprites(".", dpi_factor, atlas, spirit_sprites, &loaders)) {
             return false;
-        } else {
-            bitmap = result.second;
         }
 
-        return true;
-    };
+        atlas.pack();
+    }
 
-    if (!load_bitmap(spirits.controller.filename, controller_bitmap) ||
-        !load_bitmap(spirits.asteroid.filename, asteroid_bitmap) ||
-        !load_bitmap(spirits.bullet.filename, bullet_bitmap)) {
+    hr = target->CreateBitmap(
+        D2D1::SizeU(atlas.get_width(), atlas.get_height()),
+        atlas.get_pixels(),
+        u32(atlas.get_width() * sizeof(u32)),
+        D2D1::BitmapProperties1(
+            D2D1_BITMAP_OPTIONS_NONE,
+            D2D1::PixelFormat(DXGI_FORMAT_B8G8R8A8_UNORM, D2D1_ALPHA_MODE_PREMULTIPLIED)
+        ),
+        &atlas_bitmap
+    );
+
+    if (hr != S_OK || !atlas_bitmap) {
+        ErrorCollection::atlas_crash(hr);
         return false;
     }
 
-    auto scale = [](D2D1_SIZE_F& size, f32 factor) {
-        size.width = size.width * factor;
-        size.height = size.height * factor;
-    };
-
-    controller_bmp_size = controller_bitmap->GetSize();
-    asteroid_bmp_size = asteroid_bitmap->GetSize();
-    bullet_bmp_size = bullet_bitmap->GetSize();
+    if (target.As(&target3) == S_OK) {
+        for (auto& batch : sprite_batches) {
+            if (target3->CreateSpriteBatch(&batch) != S_OK) {
+                target3 = nullptr;
+                break;
+            }
+        }
+    }
 
-    scale(controller_bmp_size, spirits.controller.scale);
-    scale(asteroid_bmp_size, spirits.asteroid.scale);
-    scale(bullet_bmp_size, spirits.bullet.scale);
+    if (!target3)
+        std::wcout << L"Sprite batches unavailable, drawing sprites one by one\n";
 
     if (!text_helper.Init(target)) {
         ErrorCollection::text_helper_crash();
@@ -282,209 +267,198 @@ bool WindowLogic::Init() {
     }
 
     size = target->GetSize();
-    reset_controller_pos();
 
-    if (!set_asteroid_frequency())
+    if (!QueryPerformanceFrequency((LARGE_INTEGER*) &clock.frequency) ||
+        !QueryPerformanceCounter((LARGE_INTEGER*) &clock.now)) {
+        return false;
+    }
+
+    const u32 seed = std::random_device{}();
+    const SizeF game_size { size.width, size.height };
+
+    if (!game.Init(game_size, seed) ||
+        !timestep.Init(Game::DEFAULT_TICK_RATE, Game::MAX_CATCH_UP_TICKS, clock)) {
+        ErrorCollection::game_crash();
         return false;
+    }
 
-    D2D1_COLOR_F red_bg = reference_bg;
-    D2D1_COLOR_F blue_bg = reference_bg;
+    game.profiler = &profiler;
+
+    if (!flight_recorder.Init(hitch_us, ".")) {
+        ErrorCollection::game_crash();
+        return false;
+    }
 
-    red_bg.r = 1.f;
-    blue_bg.b += 0.3f;
+    game.flight_recorder = &flight_recorder;
+
+    if (profile_path_)
+        profile_path = profile_path_;
+
+    trace_thread_name("main");
+
+    if (trace_path_) {
+        trace_path = trace_path_;
+        trace_start();
+    }
+
+    if (replay_path) {
+        ReplayHeader header {
+            .seed = seed,
+            .tick_rate = Game::DEFAULT_TICK_RATE,
+            .start_level = 0,
+            .size = game_size,
+            .narrowphase = game.narrowphase,
+        };
+
+        if (!recorder.Init(replay_path, header)) {
+            ErrorCollection::replay_crash(replay_path);
+            return false;
+        }
+
+        recording = true;
+    }
 
     size = target->GetSize();
 
-    red_background_bitmap = create_gradient(red_bg, reference_bg);
+    red_background_bitmap = create_gradient(Palette::RED_GRADIENT);
 
     if (!red_background_bitmap) {
         std::wcout << L"Cannot create red gradient background\n";
     }
 
-    blue_background_bitmap = create_gradient(reference_bg, blue_bg);
+    blue_background_bitmap = create_gradient(Palette::BLUE_GRADIENT);
 
     if (!blue_background_bitmap) {
         std::wcout << L"Cannot create blue gradient background\n";
     }
 
-    return background_timer.Init(BACKGROUND_INTERVAL) &&
-           move_timer.Init(MOVE_INTERVAL) &&
-           new_bullet_timer.Init(NEW_BULLET_INTERVAL) &&
-           penalty_timer.Init(PENALTY_INTERVAL);
+    return true;
 }
 
-bool WindowLogic::set_asteroid_frequency() {
-    return new_asteroid_timer.Init((7 - difficulty) * 100);
+SizeF WindowLogic::frame_size() const {
+    return { size.width, size.height };
 }
 
-void WindowLogic::new_bullets() {
-    if (bullet_forbidden) {
-        i32 ticks = new_bullet_timer.get_intervals_count(false);
+SizeF WindowLogic::sprite_size(SpriteKind sprite) const {
+    if (sprite < SpiritSprites::COUNT)
+        return spirit_sprites.sizes[sprite];
 
-        if (ticks) {
-            bullet_forbidden = false;
-        }
-    }
-
-    bool space_press = key_up(VK_SPACE);
-
-    if (bullet_forbidden || !space_press || State != GAME_PLAY)
-        return;
-
-    bullet_forbidden = true;
-    new_bullet_timer.start_new_interval();
+    return frame_size();
+}
 
-    Vector bullet_pos { controller_pos };
+ID2D1Bitmap* WindowLogic::bitmap_of(SpriteKind sprite) const {
+    switch (sprite) {
+        case SPRITE_CONTROLLER:
+        case SPRITE_ASTEROID:
+        case SPRITE_BULLET: return atlas_bitmap.Get();
+        case SPRITE_RED_BACKGROUND: return red_background_bitmap.Get();
+        case SPRITE_BLUE_BACKGROUND: return blue_background_bitmap.Get();
+        default: return nullptr;
+    }
+}
 
-    bullet_pos.y -= spirits.controller.contour.half_of_sides.y;
+D2D1_RECT_U WindowLogic::atlas_source(SpriteKind sprite, const RectF& rect) const {
+    const SpriteAtlas::SpriteId id = spirit_sprites.ids[sprite];
+    const u32 width = u32(std::lround((rect.right - rect.left) * dpi_factor));
+    const u32 height = u32(std::lround((rect.bottom - rect.top) * dpi_factor));
+    const AtlasRegion& region = atlas.region(id, atlas.level_for(id, width, height));
 
-    bullets.push_front(Bullet {
-        .pos = bullet_pos,
-        .destroyed = false,
-        .size = 1.f,
-    });
+    return D2D1::RectU(region.x, region.y, region.x + region.width, region.y + region.height);
 }
 
-void WindowLogic::new_asteroids() {
-    const i32 ticks = new_asteroid_timer.get_intervals_count(true);
+void WindowLogic::draw_sprite(SpriteKind sprite, const RectF& rect, f32 opacity) {
+    ID2D1Bitmap* bitmap = bitmap_of(sprite);
 
-    if (ticks && (State == GAME_PLAY || State == FADE_IN)) {
-        const f32 asteroid_radius = spirits.asteroid.contour.half_of_sides.y;
-
-        const f32 shift_x = norm_asteroid_x(gen);
-        const f32 shift_y = unif_asteroid_y(gen);
+    if (!bitmap)
+        return;
 
-        const f32 x_pos = shift_x * size.width;
-        const f32 y_pos = -(shift_y * (300 - 2 * asteroid_radius) + asteroid_radius);
+    D2D1_RECT_F source_rect;
+    const D2D1_RECT_F* source = nullptr;
 
-        const f32 speed = unif_speed(gen);
+    if (sprite < SpiritSprites::COUNT) {
+        const D2D1_RECT_U pixels = atlas_source(sprite, rect);
 
-        asteroids.push_front(Asteroid {
-            .pos = Vector(x_pos, y_pos),
-            .speed = speed,
-            .destroyed = false,
-            .size = 1.f,
-        });
+        source_rect = D2D1::RectF(f32(pixels.left), f32(pixels.top), f32(pixels.right),
+                                  f32(pixels.bottom));
+        source = &source_rect;
     }
+
+    target->DrawBitmap(bitmap,
+                       D2D1::RectF(rect.left, rect.top, rect.right, rect.bottom),
+                       opacity,
+                       D2D1_BITMAP_INTERPOLATION_MODE_LINEAR,
+                       source);
 }
 
-bool WindowLogic::is_there_collision() {
-    for (const auto& a : asteroids) {
-        if (a.destroyed)
-            continue;
+void WindowLogic::draw_sprites(SpriteKind sprite, std::span<const SpriteInstance> instances) {
+    ID2D1Bitmap* bitmap = bitmap_of(sprite);
 
-        if (a.pos.y < size.height / 2)
-            continue;
+    if (!bitmap || instances.empty())
+        return;
 
-        if (intersect(spirits.asteroid.contour, spirits.controller.contour,
-                      a.pos, controller_pos)) {
-            controller_downspeed = 3.f * a.speed;
-            return true;
-        }
-    }
+    const SizeF size = sprite_size(sprite);
 
-    return false;
-}
+    if (!target3) {
+        for (const SpriteInstance& instance : instances)
+            draw_sprite(sprite, instance_rect(instance, size), instance.opacity);
 
-void WindowLogic::controller_move(const f32 shift) {
-    if (State == GAME_OVER) {
-        controller_pos.y += shift * controller_downspeed;
         return;
     }
 
-    bool keypress_left = key_up(VK_LEFT);
-    bool keypress_right = key_up(VK_RIGHT);
+    const bool in_atlas = sprite < SpiritSprites::COUNT;
 
-    auto accelerate = [](f32& acceleration) {
-        if (acceleration < 1.5)
-            acceleration += 1.125;
-        else if (acceleration < 3)
-            acceleration += 0.75;
-        else if (acceleration < 5)
-            acceleration += 0.375;
-        else if (acceleration < 15)
-            acceleration += 0.25;
-    };
+    batch_rects.resize(instances.size());
+    batch_sources.resize(in_atlas ? instances.size() : 0);
+    batch_colors.resize(instances.size());
 
-    auto decelerate = [](f32& acceleration, f32 step) {
-        acceleration = max(0.f, acceleration - step);
-    };
+    for (size_t i = 0; i < instances.size(); ++i) {
+        const RectF rect = instance_rect(instances[i], size);
 
-    bound_left = size.width / 5;
-    bound_right = size.width - bound_left;
+        batch_rects[i] = D2D1::RectF(rect.left, rect.top, rect.right, rect.bottom);
+        batch_colors[i] = D2D1::ColorF(1.f, 1.f, 1.f, instances[i].opacity);
 
-    if (keypress_left && controller_pos.x > bound_left) {
-        accelerate(accel_left);
-        decelerate(accel_right, 1.f);
-    }
-    else if (keypress_right && controller_pos.x < bound_right) {
-        accelerate(accel_right);
-        decelerate(accel_left, 1.f);
-    }
-    else {
-        decelerate(accel_right, 0.75f);
-        decelerate(accel_left, 0.75f);
+        if (in_atlas)
+            batch_sources[i] = atlas_source(sprite, rect);
     }
 
-    controller_pos.x += (accel_right - accel_left) * shift * 0.4f;
-}
+    ID2D1SpriteBatch* batch = sprite_batches[sprite].Get();
 
-void WindowLogic::asteroids_move(const f32 shift) {
-    for (auto& a : asteroids) {
-        a.pos.y += shift * a.speed;
-    }
-}
+    batch->Clear();
+    batch->AddSprites(u32(instances.size()), batch_rects.data(),
+                      in_atlas ? batch_sources.data() : nullptr, batch_colors.data());
 
-void WindowLogic::bullets_move(const f32 shift) {
-    for (auto& b : bullets) {
-        b.pos.y -= shift * BULLET_SPEED;
-    }
+    // Sprite batches are only drawn aliased; the bitmaps are still filtered.
+    target3->SetAntialiasMode(D2D1_ANTIALIAS_MODE_ALIASED);
+    target3->DrawSpriteBatch(batch, bitmap, D2D1_BITMAP_INTERPOLATION_MODE_LINEAR,
+                             D2D1_SPRITE_OPTIONS_NONE);
+    target3->SetAntialiasMode(D2D1_ANTIALIAS_MODE_PER_PRIMITIVE);
 }
 
-void WindowLogic::game_over_move(const f32 shift) {
-    if (State == GAME_OVER && game_over_progress < 1.f)
-        game_over_progress += shift / 128.f;
-
-    if (State == FADE_IN && fade_in_progress < 1.f)
-        fade_in_progress += shift / 128.f;
+void WindowLogic::draw_next_text(const wchar_t* text, size_t len) {
+    text_helper.DrawNextTxt(text, len);
 }
 
+void WindowLogic::draw_chosen_level(i32 level, f32 opacity) {
+    text_helper.DrawChosenLevel(level, opacity);
+}
 
-void WindowLogic::update_motion() {
-    const f32 shift = move_timer.get_intervals_continuous();
-    move_timer.start_new_interval();
-
-    asteroids_move(shift);
-    controller_move(shift);
-    bullets_move(shift);
-    game_over_move(shift);
+void WindowLogic::draw_game_over(f32 opacity) {
+    text_helper.DrawGameOver(opacity);
 }
 
-void WindowLogic::paint_controller() {
-    f32 hlfw_x = controller_bmp_size.width / 2;
-    f32 hlfw_y = controller_bmp_size.height / 2;
-
-    // Draw a bitmap.
-    target->DrawBitmap(
-        controller_bitmap.Get(),
-        D2D1::RectF(
-            controller_pos.x - hlfw_x,
-            controller_pos.y - hlfw_y,
-            controller_pos.x + hlfw_x,
-            controller_pos.y + hlfw_y
-        )
-    );
+void WindowLogic::draw_penalty(f32 opacity, i32 penalty) {
+    text_helper.DrawPenalty(opacity, penalty);
+}
 
-#ifdef PAINT_CONTOUR_DBG
-    paint_contour_dbg(spirits.controller.contour, controller_pos);
-#endif // PAINT_CONTOUR_DBG
+void WindowLogic::draw_data(i32 score, u32 difficulty) {
+    text_helper.DrawData(score, difficulty);
 }
 
 #ifdef PAINT_CONTOUR_DBG
-void WindowLogic::paint_contour_dbg(const ObjectContour& contour, const Vector& center) {
-    for (size_t i = 0; i < contour.vertices.size(); ++i) {
-        const Vector& av = contour.vertices[i];
-        const Vector& bv = contour.vertices[i + 1 < contour.vertices.size() ? i + 1 : 0];
+void WindowLogic::draw_contour_dbg(std::span<const Vector> vertices, const Vector& center) {
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        const Vector& av = vertices[i];
+        const Vector& bv = vertices[i + 1 < vertices.size() ? i + 1 : 0];
 
         Vector suma = av + center;
         Vector sumb = bv + center;
@@ -499,98 +473,14 @@ void WindowLogic::paint_contour_dbg(const ObjectContour& contour, const Vector&
 }
 #endif // PAINT_CONTOUR_DBG
 
-void WindowLogic::collect_garbage() {
-    while (!asteroids.empty()) {
-        const Asteroid& last = asteroids.back();
-
-        bool very_small = last.size < 0.1f;
-
-        if (!asteroid_visible(last) || very_small)
-            asteroids.pop_back();
-        else
-            break;
-    }
-
-    while (!bullets.empty()) {
-        const Bullet& last = bullets.back();
-
-        bool very_small = last.size < 0.1f;
-
-        if (!bullet_visible(last) || very_small)
-            bullets.pop_back();
-        else
-            break;
-    }
-}
-
-void WindowLogic::paint_asteroids() {
-    f32 hlfw_x = asteroid_bmp_size.width / 2;
-    f32 hlfw_y = asteroid_bmp_size.height / 2;
-
-    for (auto& a : asteroids) {
-        f32 this_hlfw_x = hlfw_x;
-        f32 this_hlfw_y = hlfw_y;
-
-        if (a.destroyed) {
-            this_hlfw_x *= a.size;
-            this_hlfw_y *= a.size;
-        }
-
-        target->DrawBitmap(
-            asteroid_bitmap.Get(),
-            D2D1::RectF(
-                a.pos.x - this_hlfw_x,
-                a.pos.y - this_hlfw_y,
-                a.pos.x + this_hlfw_x,
-                a.pos.y + this_hlfw_y
-            )
-        );
-
-#ifdef PAINT_CONTOUR_DBG
-        paint_contour_dbg(spirits.asteroid.contour, a.pos);
-#endif // PAINT_CONTOUR_DBG
-    }
-}
-
-void WindowLogic::paint_bullets() {
-    f32 hlfw_x = bullet_bmp_size.width / 2;
-    f32 hlfw_y = bullet_bmp_size.height / 2;
-
-    for (const auto& bullet : bullets) {
-        f32 this_hlfw_x = hlfw_x;
-        f32 this_hlfw_y = hlfw_y;
-
-        if (bullet.destroyed) {
-            this_hlfw_x *= bullet.size;
-            this_hlfw_y *= bullet.size;
-        }
-
-        // Draw a bitmap.
-        target->DrawBitmap(
-            bullet_bitmap.Get(),
-            D2D1::RectF(
-                bullet.pos.x - this_hlfw_x,
-                bullet.pos.y - this_hlfw_y,
-                bullet.pos.x + this_hlfw_x,
-                bullet.pos.y + this_hlfw_y
-            )
-        );
-
-#ifdef PAINT_CONTOUR_DBG
-        paint_contour_dbg(spirits.bullet.contour, bullet.pos);
-#endif // PAINT_CONTOUR_DBG
-    }
-}
-
-ComPtr<ID2D1Bitmap> WindowLogic::create_gradient(D2D1_COLOR_F side_bg,
-                                                 D2D1_COLOR_F middle_bg) {
+ComPtr<ID2D1Bitmap> WindowLogic::create_gradient(const GradientColors& colors) {
     D2D1_GRADIENT_STOP gradient_stops_arr[3];
 
-    gradient_stops_arr[0].color = side_bg;
+    gradient_stops_arr[0].color = to_d2d(colors.side);
     gradient_stops_arr[0].position = 0.0f;
-    gradient_stops_arr[1].color = middle_bg;
+    gradient_stops_arr[1].color = to_d2d(colors.middle);
     gradient_stops_arr[1].position = 0.5f;
-    gradient_stops_arr[2].color = side_bg;
+    gradient_stops_arr[2].color = to_d2d(colors.side);
     gradient_stops_arr[2].position = 1.0f;
 
     Microsoft::WRL::ComPtr<ID2D1GradientStopCollection> gradient_stops;
@@ -648,216 +538,73 @@ ComPtr<ID2D1Bitmap> WindowLogic::create_gradient(D2D1_COLOR_F side_bg,
     return bitmap;
 }
 
-void WindowLogic::compute_penalty() {
-    f32 paint_blue_bound = size.width / 5;
-    f32 penalty_bound = size.width / 3;
-
-    penalty = max(penalty_bound - controller_pos.x, controller_pos.x + penalty_bound - size.width);
-    paint_blue = fabsf(controller_pos.x - size.width / 2);
-
-    if (penalty > 0.f)
-        penalty = penalty / penalty_bound;
-    else
-        penalty = 0.f;
-
-    if (paint_blue < paint_blue_bound)
-        paint_blue = 1.f - paint_blue / paint_blue_bound;
-    else
-        paint_blue = 0.f;
-
-    if (penalty_timer.get_intervals_count(true)) {
-        if (penalty == 0)
-            penalty_points_total = 0;
-        else if (State == GAME_PLAY) {
-            i32 penalty_points_unit = (i32) std::floor(penalty * 5.f);
-            penalty_points_total += penalty_points_unit;
-            score -= penalty_points_unit;
-        }
-    }
-}
-
-void WindowLogic::destroy_asteroids() {
-    for (auto& a : asteroids) {
-        if (a.destroyed) {
-            if (a.size > 0)
-                a.size -= 0.05f;
-        }
-    }
-
-    for (auto& b : bullets) {
-        if (b.destroyed) {
-            if (b.size > 0)
-                b.size -= 0.05f;
-        }
-    }
-
-    for (auto& a : asteroids) {
-        if (a.destroyed)
-            continue;
+bool WindowLogic::update_scene() {
+    TRACE_SCOPE("WindowLogic::update_scene");
 
-        for (auto& b : bullets) {
-            if (b.destroyed || !bullet_can_destroy(b))
-                continue;
+    frame_start = profile_now();
 
-            if (intersect(spirits.asteroid.contour, spirits.bullet.contour, a.pos, b.pos)) {
-                a.destroyed = true;
-                b.destroyed = true;
-                score += 5;
-                break;
-            }
-        }
-    }
-}
+    if (!QueryPerformanceCounter((LARGE_INTEGER*) &clock.now))
+        return false;
 
-bool WindowLogic::update_scene() {
     size = target->GetSize();
 
-    background_timer.update();
-    new_asteroid_timer.update();
-    new_bullet_timer.update();
-    move_timer.update();
-    penalty_timer.update();
+    // The replay stores only the size the game started with, so while
+    // recording the playfield keeps it whatever the window does.
+    if (!recording)
+        game.set_size(SizeF { size.width, size.height });
 
-    update_motion();
-    new_asteroids();
-    new_bullets();
+    Input input {
+        .left = key_up(VK_LEFT),
+        .right = key_up(VK_RIGHT),
+        .space = key_up(VK_SPACE),
+        .level = pending_level,
+    };
 
-    compute_penalty();
+    for (u32 ticks = timestep.advance(); ticks > 0; --ticks) {
+        if (!game.update_scene(input))
+            return false;
 
-    if (State == GAME_PLAY)
-        if (is_there_collision()) {
-            State = GAME_OVER;
-        }
+        if (recording && !recorder.record(input))
+            return false;
 
-    destroy_asteroids();
-    collect_garbage();
+        // A level key counts once, not once per tick.
+        input.level = 0;
+        pending_level = 0;
+    }
+
+    alpha = timestep.get_alpha();
 
     return true;
 }
 
 bool WindowLogic::paint() {
+    TRACE_SCOPE("WindowLogic::paint");
+
+    PhaseTimes times(true);
+    u64 start = times.start();
+
     // Proper drawing.
     target->BeginDraw();
     target->Clear(D2D1::ColorF(0.f, 0.f, 0.f));
 
     text_helper.Start();
 
-    if (State == GAME_PLAY || State == GAME_OVER || State == FADE_IN) {
-        f32 gameplay_opacity;
-
-        if (State == GAME_OVER)
-            gameplay_opacity = 1.f - game_over_progress;
-        else if (State == FADE_IN)
-            gameplay_opacity = fade_in_progress;
-        else /* GAME_PLAY */
-            gameplay_opacity = 1.f;
-
-        // Paint background.
-        if (paint_blue > 0.f) {
-            target->DrawBitmap(blue_background_bitmap.Get(),
-                               NULL,
-                               paint_blue * gameplay_opacity,
-                               D2D1_BITMAP_INTERPOLATION_MODE_LINEAR,
-                               NULL);
-        } else {
-            target->DrawBitmap(red_background_bitmap.Get(),
-                               NULL,
-                               penalty * gameplay_opacity,
-                               D2D1_BITMAP_INTERPOLATION_MODE_LINEAR,
-                               NULL);
-        }
-
-        paint_controller();
-        paint_asteroids();
-        paint_bullets();
-
-        if (State == FADE_IN) {
-            text_helper.DrawChosenLevel(chosen_next_difficulty, 1.f - fade_in_progress);
-        }
-
-        if (State == GAME_OVER) {
-            text_helper.DrawGameOver(game_over_progress);
-        }
-
-        text_helper.DrawData(score, difficulty);
-
-        if (penalty > 0.f) {
-            text_helper.DrawPenalty(penalty * gameplay_opacity, penalty_points_total);
-        }
-
-        if (game_over_progress >= 1.f) {
-            State = FADE_OUT;
-
-            if (!fade_out_timer.Init(FADE_OUT_INTERVAL)) {
-                std::wcout << L"Cannot init fade-out timer\n";
-                return false;
-            }
-        }
-
-        if (fade_in_progress >= 1.f) {
-            State = GAME_PLAY;
-            fade_in_progress = 0.f;
-        }
-    }
-    else if (State == CHOOSE_NEW_LEVEL) {
-        paint_asteroids();
-        paint_bullets();
-
-        text_helper.DrawData(score, difficulty);
-        typewriter_timer.update();
-
-        if (typewriter_timer.get_intervals_count(true)) {
-            typewriter_animation.next_frame();
-        }
-
-        auto [choose_next_txt, choose_next_len] = typewriter_animation.get_text();
-        text_helper.DrawNextTxt(choose_next_txt, choose_next_len);
-        text_helper.DrawChosenLevel(chosen_next_difficulty, 1.f);
-
-        if (!typewriter_animation.is_frame_left()) {
-            if (chosen_next_difficulty != -1) {
-                State = FADE_IN;
-                reset_controller_pos();
-                asteroids.clear();
-                bullets.clear();
-                game_over_progress = 0.f;
-                fade_in_progress = 0.f;
-                controller_downspeed = 0.f;
-                penalty_points_total = 0;
-                score = 0;
-                bullet_forbidden = false;
-                difficulty = chosen_next_difficulty;
-
-                if (!set_asteroid_frequency())
-                    return false;
-            }
-        }
-
-    } else if (State == FADE_OUT) {
-        paint_asteroids();
-        paint_bullets();
-
-        text_helper.DrawGameOver(1.f);
-        text_helper.DrawData(score, difficulty);
-
-        fade_out_timer.update();
-
-        if (fade_out_timer.get_intervals_count(false)) {
-            State = CHOOSE_NEW_LEVEL;
-            typewriter_animation.Init(L"CHOOSE NEXT LEVEL DIFFICULTY");
-            typewriter_timer.Init(TYPE_SPEED);
-            chosen_next_difficulty = -1;
-        }
-
-    }
+    painter.paint(*this, game, alpha);
+    start = times.add(PHASE_PAINT, start);
 
     if (!text_helper.Flush()) {
         std::wcout << L"Failed to flush texts\n";
         return false;
     }
 
+    start = times.add(PHASE_TEXT_FLUSH, start);
+
     HRESULT hr;
-    hr = target->EndDraw();
+
+    {
+        TRACE_SCOPE("ID2D1DeviceContext::EndDraw");
+        hr = target->EndDraw();
+    }
 
     if (hr != S_OK) {
         std::wcout << L"Error while drawing\n";
@@ -867,11 +614,23 @@ bool WindowLogic::paint() {
     // The first argument instructs DXGI to block until VSync, putting the application
     // to sleep until the next VSync. This ensures we don't waste any cycles rendering
     // frames that will never be displayed to the screen.
-    hr = dxgi_swapchain->Present(1, 0);
+    {
+        TRACE_SCOPE("IDXGISwapChain1::Present");
+        hr = dxgi_swapchain->Present(1, 0);
+    }
+
     if (hr != S_OK) {
         return false;
     }
 
+    times.add(PHASE_PRESENT, start);
+    times.add(PHASE_FRAME, frame_start);
+
+    profiler.record(times);
+
+    // A dump that cannot be written is not worth stopping the game for.
+    flight_recorder.end_frame(times);
+
     return true;
 }
 
@@ -884,10 +643,38 @@ bool WindowLogic::on_mousemove() {
 }
 
 bool WindowLogic::on_keypress(u16 vkey) {
-    if (State == CHOOSE_NEW_LEVEL) {
-        if (vkey >= 0x31 && vkey <= 0x36)
-            chosen_next_difficulty = vkey - 0x30;
-    }
+    if (vkey >= 0x31 && vkey <= 0x36)
+        pending_level = vkey - 0x30;
+
+    if (vkey == VK_F9)
+        dump_profile();
+
+    if (vkey == VK_F10)
+        toggle_trace();
 
     return true;
 }
+
+void WindowLogic::dump_profile() const {
+    profiler.print(std::wcout);
+
+    if (!profile_path.empty())
+        profiler.write(profile_path);
+}
+
+void WindowLogic::toggle_trace() {
+    if (!trace_enabled()) {
+        std::wcout << L"Tracing\n";
+        trace_start();
+    } else if (trace_stop(trace_path)) {
+        std::wcout << L"Trace written to " << trace_path.wstring() << L'\n';
+    }
+}
+
+WindowLogic::~WindowLogic() {
+    dump_profile();
+    flight_recorder.Finish();
+
+    if (trace_enabled())
+        toggle_trace();
+}
@@ -1,7 +1,9 @@
 #include <iostream>
 #include <cstdio>
+#include <cstdlib>
 #include <windows.h>
 #include <winuser.h>
+#include <shellapi.h>
 #include "window.hpp"
 
 int WINAPI wWinMain(HINSTANCE, HINSTANCE, PWSTR, int nCmdShow) {
@@ -27,8 +29,31 @@ int WINAPI wWinMain(HINSTANCE, HINSTANCE, PWSTR, int nCmdShow) {
 
 #endif
 
+    // `--record FILE` saves the inputs of the session for asteroids_headless;
+    // `--profile FILE` is where F9 and quitting write the frame timings;
+    // `--trace FILE` traces the session from the start (F10 stops it);
+    // `--hitch-us US` is the frame time over which the last frames are dumped.
+    const wchar_t* replay_path = nullptr;
+    const wchar_t* profile_path = nullptr;
+    const wchar_t* trace_path = nullptr;
+    u64 hitch_us = FlightRecorder::DEFAULT_BUDGET_US;
+    int argc;
+    LPWSTR* argv = CommandLineToArgvW(GetCommandLineW(), &argc);
+
+    for (int i = 1; argv && i + 1 < argc; ++i) {
+        if (!wcscmp(argv[i], L"--record"))
+            replay_path = argv[i + 1];
+        else if (!wcscmp(argv[i], L"--profile"))
+            profile_path = argv[i + 1];
+        else if (!wcscmp(argv[i], L"--trace"))
+            trace_path = argv[i + 1];
+        else if (!wcscmp(argv[i], L"--hitch-us"))
+            hitch_us = wcstoull(argv[i + 1], nullptr, 10);
+    }
+
     Window window(1166, 568);
-    bool result = window.Init(L"Asteroids Class", L"Asteroids!");
+    bool result = window.Init(L"Asteroids Class", L"Asteroids!", replay_path, profile_path,
+                                trace_path, hitch_us);
 
     if (!result) {
         std::wcout << L"Cannot initialize window";
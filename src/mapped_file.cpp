@@ -0,0 +1,101 @@
+#include "mapped_file.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+    unmap();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Init(const std::filesystem::path& path) {
+    unmap();
+
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER file_size;
+
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart <= 0) {
+        CloseHandle(file);
+        return false;
+    }
+
+    // The view keeps the mapping alive, and the mapping the file.
+    mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+
+    if (!mapping)
+        return false;
+
+    bytes = (const u8*) MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+    if (!bytes) {
+        unmap();
+        return false;
+    }
+
+    length = size_t(file_size.QuadPart);
+    return true;
+}
+
+void MappedFile::unmap() {
+    if (bytes)
+        UnmapViewOfFile(bytes);
+
+    if (mapping)
+        CloseHandle(mapping);
+
+    bytes = nullptr;
+    mapping = nullptr;
+    length = 0;
+}
+
+#else
+
+bool MappedFile::Init(const std::filesystem::path& path) {
+    unmap();
+
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0)
+        return false;
+
+    struct stat status;
+
+    if (fstat(fd, &status) != 0 || status.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+
+    // The mapping stays valid once the descriptor is closed.
+    void* view = mmap(nullptr, size_t(status.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (view == MAP_FAILED)
+        return false;
+
+    bytes = (const u8*) view;
+    length = size_t(status.st_size);
+    return true;
+}
+
+void MappedFile::unmap() {
+    if (bytes)
+        munmap((void*) bytes, length);
+
+    bytes = nullptr;
+    length = 0;
+}
+
+#endif // _WIN32
@@ -0,0 +1,126 @@
+#include "perf_counters.hpp"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif // __linux__
+
+namespace {
+    constexpr const char* EVENT_NAMES[PERF_EVENT_COUNT] = {
+        "cycles",
+        "instructions",
+        "l1d_misses",
+        "llc_misses",
+        "branch_misses",
+    };
+
+#ifdef __linux__
+    constexpr u64 cache_read_miss(u64 cache) {
+        return cache | u64(PERF_COUNT_HW_CACHE_OP_READ) << 8 |
+               u64(PERF_COUNT_HW_CACHE_RESULT_MISS) << 16;
+    }
+
+    struct EventConfig {
+        u32 type;
+        u64 config;
+    };
+
+    constexpr EventConfig EVENTS[PERF_EVENT_COUNT] = {
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+        { PERF_TYPE_HW_CACHE, cache_read_miss(PERF_COUNT_HW_CACHE_L1D) },
+        { PERF_TYPE_HW_CACHE, cache_read_miss(PERF_COUNT_HW_CACHE_LL) },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+    };
+
+    // Counts `event` for the calling thread, in user space only, as a member
+    // of `group` (or as a new group when it is -1).
+    int open_event(const EventConfig& event, int group) {
+        perf_event_attr attr {};
+        attr.size = sizeof(attr);
+        attr.type = event.type;
+        attr.config = event.config;
+        attr.read_format = PERF_FORMAT_GROUP;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+
+        // On the counters all the time, or not at all: a group that does not
+        // fit goes into an error state, and reads nothing, instead of being
+        // multiplexed into estimates.
+        attr.pinned = group == -1;
+
+        return int(syscall(SYS_perf_event_open, &attr, 0, -1, group, 0));
+    }
+#endif // __linux__
+}
+
+const char* perf_event_name(PerfEvent event) {
+    return event < PERF_EVENT_COUNT ? EVENT_NAMES[event] : "unknown";
+}
+
+bool PerfCounters::Init() {
+#ifdef __linux__
+    for (u32 event = 0; event < PERF_EVENT_COUNT; ++event) {
+        fds[event] = open_event(EVENTS[event], leader);
+
+        if (leader == -1)
+            leader = fds[event];
+    }
+
+    return leader != -1 && read(mark);
+#else
+    return false;
+#endif // __linux__
+}
+
+PerfCounters::~PerfCounters() {
+#ifdef __linux__
+    for (int fd : fds) {
+        if (fd >= 0)
+            close(fd);
+    }
+#endif // __linux__
+}
+
+// A group read gives the number of counters, then their values in the order
+// they joined the group.
+bool PerfCounters::read(std::array<u64, PERF_EVENT_COUNT>& values) const {
+#ifdef __linux__
+    u64 buffer[1 + PERF_EVENT_COUNT];
+    const ssize_t size = ::read(leader, buffer, sizeof(buffer));
+
+    if (size < ssize_t(sizeof(u64)) || size < ssize_t((1 + buffer[0]) * sizeof(u64)))
+        return false;
+
+    u64 next = 1;
+
+    for (u32 event = 0; event < PERF_EVENT_COUNT; ++event)
+        values[event] = fds[event] >= 0 ? buffer[next++] : 0;
+
+    return true;
+#else
+    (void) values;
+    return false;
+#endif // __linux__
+}
+
+void PerfCounters::start() {
+    read(mark);
+}
+
+void PerfCounters::add(FramePhase phase) {
+    std::array<u64, PERF_EVENT_COUNT> now;
+
+    if (!read(now))
+        return;
+
+    for (u32 event = 0; event < PERF_EVENT_COUNT; ++event)
+        phases[phase][event] += now[event] - mark[event];
+
+    mark = now;
+}
+
+void PerfCounters::clear() {
+    phases = {};
+}
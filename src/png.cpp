@@ -0,0 +1,723 @@
+#include "png.hpp"
+
+#include <cstring>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <array>
+#include <algorithm>
+
+#include "png_kernel.hpp"
+
+namespace {
+    //
+    // Inflate
+    //
+
+    // Reads the deflate stream least significant bit first, 64 bits at a time.
+    // Past the end it shifts in zeros; `overrun` tells whether any of them
+    // was consumed.
+    struct BitReader {
+        const u8* data;
+        size_t size;
+        size_t pos = 0;
+        u64 bits = 0;
+        u32 count = 0;
+
+        void refill() {
+            while (count <= 56) {
+                bits |= u64(pos < size ? data[pos] : 0) << count;
+                ++pos;
+                count += 8;
+            }
+        }
+
+        u32 peek(u32 n) {
+            if (count < n)
+                refill();
+
+            return u32(bits & ((u64(1) << n) - 1));
+        }
+
+        void drop(u32 n) {
+            bits >>= n;
+            count -= n;
+        }
+
+        u32 get(u32 n) {
+            const u32 value = peek(n);
+            drop(n);
+            return value;
+        }
+
+        void align_to_byte() {
+            drop(count % 8);
+        }
+
+        bool overrun() const {
+            return (pos - count / 8) > size;
+        }
+    };
+
+    constexpr u32 MAX_BITS = 15;
+
+    // Canonical Huffman code. Codes of up to FAST_BITS bits are decoded with
+    // one table lookup, longer ones bit by bit from `counts` and `symbols`.
+    struct Huffman {
+        static constexpr u32 FAST_BITS = 10;
+
+        // (symbol << 4) | length, 0 when the code is longer than FAST_BITS.
+        u16 fast[1 << FAST_BITS];
+        u16 counts[MAX_BITS + 1];
+        u16 symbols[288];
+
+        bool build(const u8* lengths, u32 n) {
+            memset(counts, 0, sizeof(counts));
+
+            for (u32 i = 0; i < n; ++i)
+                ++counts[lengths[i]];
+
+            counts[0] = 0;
+
+            // Over-subscribed codes are invalid; incomplete ones are allowed
+            // (a distance code may have a single symbol).
+            i32 left = 1;
+
+            for (u32 len = 1; len <= MAX_BITS; ++len) {
+                left = left * 2 - counts[len];
+
+                if (left < 0)
+                    return false;
+            }
+
+            u16 offsets[MAX_BITS + 2];
+            offsets[1] = 0;
+
+            for (u32 len = 1; len <= MAX_BITS; ++len)
+                offsets[len + 1] = u16(offsets[len] + counts[len]);
+
+            for (u32 i = 0; i < n; ++i) {
+                if (lengths[i])
+                    symbols[offsets[lengths[i]]++] = u16(i);
+            }
+
+            memset(fast, 0, sizeof(fast));
+
+            u32 code = 0, index = 0;
+
+            for (u32 len = 1; len <= FAST_BITS; ++len) {
+                for (u32 k = 0; k < counts[len]; ++k, ++code, ++index) {
+                    // Codes are stored most significant bit first.
+                    u32 reversed = 0;
+
+                    for (u32 bit = 0; bit < len; ++bit)
+                        reversed |= (code >> bit & 1) << (len - 1 - bit);
+
+                    for (u32 i = reversed; i < (1u << FAST_BITS); i += 1 << len)
+                        fast[i] = u16(symbols[index] << 4 | len);
+                }
+
+                code <<= 1;
+            }
+
+            return true;
+        }
+
+        // Returns the symbol, or -1 on an invalid code.
+        i32 decode(BitReader& in) const {
+            const u16 entry = fast[in.peek(FAST_BITS)];
+
+            if (entry) {
+                in.drop(entry & 15);
+                return entry >> 4;
+            }
+
+            i32 code = 0, first = 0, index = 0;
+
+            for (u32 len = 1; len <= MAX_BITS; ++len) {
+                code |= i32(in.get(1));
+
+                const i32 count = counts[len];
+
+                if (code - count < first)
+                    return symbols[index + (code - first)];
+
+                index += count;
+                first = (first + count) << 1;
+                code <<= 1;
+            }
+
+            return -1;
+        }
+    };
+
+    constexpr u16 LENGTH_BASE[29] = {
+        3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+        35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258,
+    };
+    constexpr u8 LENGTH_EXTRA[29] = {
+        0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+        3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0,
+    };
+    constexpr u16 DIST_BASE[30] = {
+        1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+        257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577,
+    };
+    constexpr u8 DIST_EXTRA[30] = {
+        0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+        7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13,
+    };
+
+    // `out` never grows past `limit` bytes; a stream that would make it is
+    // rejected as soon as it tries.
+    bool inflate_codes(BitReader& in, const Huffman& lengths, const Huffman& distances,
+                       std::vector<u8>& out, size_t start, size_t limit) {
+        for (;;) {
+            const i32 symbol = lengths.decode(in);
+
+            if (symbol < 0 || in.overrun())
+                return false;
+
+            if (symbol < 256) {
+                if (out.size() >= limit)
+                    return false;
+
+                out.push_back(u8(symbol));
+                continue;
+            }
+
+            if (symbol == 256)
+                return true;
+
+            if (symbol > 285)
+                return false;
+
+            const u32 length = LENGTH_BASE[symbol - 257] + in.get(LENGTH_EXTRA[symbol - 257]);
+            const i32 dist_symbol = distances.decode(in);
+
+            if (dist_symbol < 0 || dist_symbol > 29)
+                return false;
+
+            const size_t dist = DIST_BASE[dist_symbol] + in.get(DIST_EXTRA[dist_symbol]);
+
+            if (dist > out.size() - start || length > limit - out.size())
+                return false;
+
+            // Byte by byte: the copy may overlap what it produces.
+            size_t from = out.size() - dist;
+
+            for (u32 i = 0; i < length; ++i)
+                out.push_back(out[from + i]);
+        }
+    }
+
+    bool inflate_stored(BitReader& in, std::vector<u8>& out, size_t limit) {
+        in.align_to_byte();
+
+        const u32 len = in.get(16);
+        const u32 nlen = in.get(16);
+
+        if ((len ^ 0xffff) != nlen || len > limit - out.size())
+            return false;
+
+        // The bytes already in the bit buffer, then the rest straight from
+        // the stream.
+        u32 i = 0;
+
+        for (; i < len && in.count >= 8; ++i)
+            out.push_back(u8(in.get(8)));
+
+        const size_t rest = len - i;
+
+        if (in.pos > in.size || rest > in.size - in.pos)
+            return false;
+
+        out.insert(out.end(), in.data + in.pos, in.data + in.pos + rest);
+        in.pos += rest;
+
+        return !in.overrun();
+    }
+
+    bool inflate_fixed(BitReader& in, std::vector<u8>& out, size_t start, size_t limit) {
+        static const auto tables = [] {
+            u8 lengths[288];
+
+            memset(lengths, 8, 144);
+            memset(lengths + 144, 9, 112);
+            memset(lengths + 256, 7, 24);
+            memset(lengths + 280, 8, 8);
+
+            u8 dist_lengths[30];
+            memset(dist_lengths, 5, sizeof(dist_lengths));
+
+            std::pair<Huffman, Huffman> result;
+            result.first.build(lengths, 288);
+            result.second.build(dist_lengths, 30);
+
+            return result;
+        }();
+
+        return inflate_codes(in, tables.first, tables.second, out, start, limit);
+    }
+
+    bool inflate_dynamic(BitReader& in, std::vector<u8>& out, size_t start, size_t limit) {
+        static constexpr u8 ORDER[19] = {
+            16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15,
+        };
+
+        const u32 nlen = in.get(5) + 257;
+        const u32 ndist = in.get(5) + 1;
+        const u32 ncode = in.get(4) + 4;
+
+        if (nlen > 286 || ndist > 30)
+            return false;
+
+        u8 lengths[286 + 30] = {};
+
+        for (u32 i = 0; i < ncode; ++i)
+            lengths[ORDER[i]] = u8(in.get(3));
+
+        Huffman code_lengths;
+
+        if (!code_lengths.build(lengths, 19))
+            return false;
+
+        memset(lengths, 0, 19);
+
+        for (u32 i = 0; i < nlen + ndist;) {
+            const i32 symbol = code_lengths.decode(in);
+
+            if (symbol < 0)
+                return false;
+
+            if (symbol < 16) {
+                lengths[i++] = u8(symbol);
+                continue;
+            }
+
+            u8 value = 0;
+            u32 repeat;
+
+            if (symbol == 16) {
+                if (i == 0)
+                    return false;
+
+                value = lengths[i - 1];
+                repeat = 3 + in.get(2);
+            }
+            else if (symbol == 17) {
+                repeat = 3 + in.get(3);
+            }
+            else {
+                repeat = 11 + in.get(7);
+            }
+
+            if (i + repeat > nlen + ndist)
+                return false;
+
+            while (repeat--)
+                lengths[i++] = value;
+        }
+
+        Huffman literals, distances;
+
+        if (!lengths[256] || !literals.build(lengths, nlen) ||
+            !distances.build(lengths + nlen, ndist)) {
+            return false;
+        }
+
+        return inflate_codes(in, literals, distances, out, start, limit);
+    }
+
+    u32 adler32(const u8* data, size_t size) {
+        u32 a = 1, b = 0;
+
+        while (size) {
+            // The largest run that cannot overflow before the modulo.
+            const size_t run = size < 5552 ? size : 5552;
+
+            for (size_t i = 0; i < run; ++i) {
+                a += data[i];
+                b += a;
+            }
+
+            a %= 65521;
+            b %= 65521;
+            data += run;
+            size -= run;
+        }
+
+        return b << 16 | a;
+    }
+
+    //
+    // PNG
+    //
+
+    u32 read_be32(const u8* p) {
+        return u32(p[0]) << 24 | u32(p[1]) << 16 | u32(p[2]) << 8 | u32(p[3]);
+    }
+
+    void write_be32(std::vector<u8>& out, u32 value) {
+        const u8 bytes[4] = { u8(value >> 24), u8(value >> 16), u8(value >> 8), u8(value) };
+        out.insert(out.end(), bytes, bytes + 4);
+    }
+
+    u32 crc32(const u8* data, size_t size) {
+        static const auto table = [] {
+            std::array<u32, 256> table {};
+
+            for (u32 n = 0; n < 256; ++n) {
+                u32 c = n;
+
+                for (int k = 0; k < 8; ++k)
+                    c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+
+                table[n] = c;
+            }
+
+            return table;
+        }();
+
+        u32 crc = 0xffffffffu;
+
+        for (size_t i = 0; i < size; ++i)
+            crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+
+        return crc ^ 0xffffffffu;
+    }
+
+    void write_chunk(std::vector<u8>& out, const char kind[4], const std::vector<u8>& body) {
+        write_be32(out, u32(body.size()));
+
+        const size_t start = out.size();
+        out.insert(out.end(), kind, kind + 4);
+        out.insert(out.end(), body.begin(), body.end());
+
+        write_be32(out, crc32(out.data() + start, out.size() - start));
+    }
+
+    constexpr u8 SIGNATURE[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+
+    // The largest images decoded. They keep every size computed from the
+    // header, up to `(4 * width + 1) * height`, far from overflowing a size_t
+    // (even a 32-bit one) and a corrupt header from asking for gigabytes.
+    constexpr u32 MAX_SIDE = 1 << 14;
+    constexpr u64 MAX_PIXELS = 1 << 26;
+
+    enum ColorType : u8 {
+        COLOR_GRAY = 0,
+        COLOR_RGB = 2,
+        COLOR_PALETTE = 3,
+        COLOR_GRAY_ALPHA = 4,
+        COLOR_RGBA = 6,
+    };
+
+    u32 channels_of(u8 color_type) {
+        switch (color_type) {
+            case COLOR_GRAY: return 1;
+            case COLOR_RGB: return 3;
+            case COLOR_PALETTE: return 1;
+            case COLOR_GRAY_ALPHA: return 2;
+            case COLOR_RGBA: return 4;
+            default: return 0;
+        }
+    }
+
+    struct PngInfo {
+        u32 width = 0;
+        u32 height = 0;
+        u8 color_type = 0;
+        u8 palette[256][4] = {};
+        std::vector<u8> idat;
+    };
+
+
+    // Any color type to straight RGBA.
+    void expand_row(const PngInfo& png, const u8* src, u8* dst) {
+        switch (png.color_type) {
+            case COLOR_GRAY:
+                for (u32 x = 0; x < png.width; ++x, dst += 4) {
+                    dst[0] = dst[1] = dst[2] = src[x];
+                    dst[3] = 255;
+                }
+                break;
+            case COLOR_RGB:
+                for (u32 x = 0; x < png.width; ++x, dst += 4, src += 3) {
+                    memcpy(dst, src, 3);
+                    dst[3] = 255;
+                }
+                break;
+            case COLOR_PALETTE:
+                for (u32 x = 0; x < png.width; ++x, dst += 4)
+                    memcpy(dst, png.palette[src[x]], 4);
+                break;
+            case COLOR_GRAY_ALPHA:
+                for (u32 x = 0; x < png.width; ++x, dst += 4, src += 2) {
+                    dst[0] = dst[1] = dst[2] = src[0];
+                    dst[3] = src[1];
+                }
+                break;
+            default:
+                memcpy(dst, src, size_t(png.width) * 4);
+                break;
+        }
+    }
+}
+
+bool inflate_zlib(const u8* data, size_t size, std::vector<u8>& out, size_t max_size) {
+    if (size < 6)
+        return false;
+
+    const u8 cmf = data[0], flg = data[1];
+
+    // Deflate, window of at most 32K, no preset dictionary.
+    if ((cmf & 15) != 8 || (cmf >> 4) > 7 || (u32(cmf) << 8 | flg) % 31 || (flg & 0x20))
+        return false;
+
+    const size_t start = out.size();
+    const size_t limit = max_size < SIZE_MAX - start ? start + max_size : SIZE_MAX;
+    BitReader in { data + 2, size - 6 };
+
+    for (bool last = false; !last;) {
+        last = in.get(1);
+
+        bool ok;
+
+        switch (in.get(2)) {
+            case 0: ok = inflate_stored(in, out, limit); break;
+            case 1: ok = inflate_fixed(in, out, start, limit); break;
+            case 2: ok = inflate_dynamic(in, out, start, limit); break;
+            default: ok = false; break;
+        }
+
+        if (!ok || in.overrun())
+            return false;
+    }
+
+    return adler32(out.data() + start, out.size() - start) == read_be32(data + size - 4);
+}
+
+namespace {
+    bool parse_png(const u8* data, size_t size, PngInfo& png) {
+        if (size < sizeof(SIGNATURE) || memcmp(data, SIGNATURE, sizeof(SIGNATURE)))
+            return false;
+
+        for (size_t pos = sizeof(SIGNATURE); pos + 12 <= size;) {
+            const u32 length = read_be32(data + pos);
+            const u8* kind = data + pos + 4;
+            const u8* body = data + pos + 8;
+
+            if (length > size - pos - 12)
+                return false;
+
+            if (!memcmp(kind, "IHDR", 4)) {
+                if (length != 13)
+                    return false;
+
+                png.width = read_be32(body);
+                png.height = read_be32(body + 4);
+                png.color_type = body[9];
+
+                if (png.width > MAX_SIDE || png.height > MAX_SIDE ||
+                    u64(png.width) * png.height > MAX_PIXELS) {
+                    return false;
+                }
+
+                // Bit depth, compression, filter method, interlace.
+                if (body[8] != 8 || body[10] || body[11] || body[12] ||
+                    !channels_of(png.color_type)) {
+                    return false;
+                }
+            }
+            else if (!memcmp(kind, "PLTE", 4)) {
+                for (u32 i = 0; i < length / 3 && i < 256; ++i) {
+                    png.palette[i][0] = body[i * 3];
+                    png.palette[i][1] = body[i * 3 + 1];
+                    png.palette[i][2] = body[i * 3 + 2];
+                    png.palette[i][3] = 255;
+                }
+            }
+            else if (!memcmp(kind, "tRNS", 4) && png.color_type == COLOR_PALETTE) {
+                for (u32 i = 0; i < length && i < 256; ++i)
+                    png.palette[i][3] = body[i];
+            }
+            else if (!memcmp(kind, "IDAT", 4)) {
+                png.idat.insert(png.idat.end(), body, body + length);
+            }
+            else if (!memcmp(kind, "IEND", 4)) {
+                break;
+            }
+
+            pos += size_t(length) + 12;
+        }
+
+        return png.width && png.height;
+    }
+
+    // Inflates and unfilters `png`, handing every row to `row(y, bytes)` as
+    // soon as it is unfiltered.
+    template<typename Row>
+    bool decode_rows(const PngInfo& png, Row&& row) {
+        const u32 channels = channels_of(png.color_type);
+        const size_t stride = size_t(png.width) * channels;
+
+        std::vector<u8> raw;
+        raw.reserve((stride + 1) * png.height);
+
+        if (!inflate_zlib(png.idat.data(), png.idat.size(), raw, (stride + 1) * png.height) ||
+            raw.size() < (stride + 1) * png.height) {
+            return false;
+        }
+
+        // What the first row sees above it.
+        const std::vector<u8> zeros(stride, 0);
+        const u8* prev = zeros.data();
+
+        for (u32 y = 0; y < png.height; ++y) {
+            u8* line = raw.data() + y * (stride + 1);
+            const u8 filter = line[0];
+
+            if (filter > FILTER_PAETH)
+                return false;
+
+            unfilter_row(PngFilter(filter), line + 1, prev, stride, channels);
+            row(y, line + 1);
+            prev = line + 1;
+        }
+
+        return true;
+    }
+}
+
+bool decode_png(const u8* data, size_t size, Image& image) {
+    PngInfo png;
+
+    if (!parse_png(data, size, png))
+        return false;
+
+    image.width = png.width;
+    image.height = png.height;
+    image.pixels.resize(size_t(png.width) * png.height * 4);
+
+    return decode_rows(png, [&](u32 y, const u8* row) {
+        expand_row(png, row, image.pixels.data() + size_t(y) * png.width * 4);
+    });
+}
+
+bool decode_png(const u8* data, size_t size, Sprite& sprite) {
+    PngInfo png;
+
+    if (!parse_png(data, size, png))
+        return false;
+
+    sprite.width = png.width;
+    sprite.height = png.height;
+    sprite.pixels.resize(size_t(png.width) * png.height);
+
+    std::vector<u8> rgba(png.color_type == COLOR_RGBA ? 0 : size_t(png.width) * 4);
+
+    return decode_rows(png, [&](u32 y, const u8* row) {
+        if (png.color_type != COLOR_RGBA) {
+            expand_row(png, row, rgba.data());
+            row = rgba.data();
+        }
+
+        premultiply_row(sprite.pixels.data() + size_t(y) * png.width, row, png.width);
+    });
+}
+
+namespace {
+    bool read_file(const std::filesystem::path& path, std::vector<u8>& data) {
+        std::ifstream file(path, std::ios::binary);
+
+        if (!file)
+            return false;
+
+        data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        return true;
+    }
+}
+
+bool load_png(const std::filesystem::path& path, Image& image) {
+    std::vector<u8> data;
+    return read_file(path, data) && decode_png(data.data(), data.size(), image);
+}
+
+bool load_png(const std::filesystem::path& path, Sprite& sprite) {
+    std::vector<u8> data;
+    return read_file(path, data) && decode_png(data.data(), data.size(), sprite);
+}
+
+bool encode_png(const Image& image, std::vector<u8>& out, u8 filter) {
+    if (!image.width || !image.height || filter > FILTER_PAETH ||
+        image.pixels.size() != size_t(image.width) * image.height * 4) {
+        return false;
+    }
+
+    std::vector<u8> header;
+    write_be32(header, image.width);
+    write_be32(header, image.height);
+    header.insert(header.end(), { 8, COLOR_RGBA, 0, 0, 0 });
+
+    // Stored deflate blocks: frame dumps are written in bulk and read once,
+    // so speed beats size.
+    const size_t stride = size_t(image.width) * 4;
+    std::vector<u8> raw;
+    raw.reserve((stride + 1) * image.height);
+
+    for (u32 y = 0; y < image.height; ++y) {
+        const u8* line = image.pixel(0, y);
+        const u8* prev = y ? image.pixel(0, y - 1) : nullptr;
+
+        raw.push_back(filter);
+
+        for (size_t i = 0; i < stride; ++i) {
+            const u8 a = i >= 4 ? line[i - 4] : 0;
+            const u8 b = prev ? prev[i] : 0;
+            const u8 c = prev && i >= 4 ? prev[i - 4] : 0;
+
+            switch (filter) {
+                case FILTER_SUB: raw.push_back(u8(line[i] - a)); break;
+                case FILTER_UP: raw.push_back(u8(line[i] - b)); break;
+                case FILTER_AVERAGE: raw.push_back(u8(line[i] - (a + b) / 2)); break;
+                case FILTER_PAETH: raw.push_back(u8(line[i] - paeth_predictor(a, b, c))); break;
+                default: raw.push_back(line[i]); break;
+            }
+        }
+    }
+
+    std::vector<u8> zlib = { 0x78, 0x01 };
+    zlib.reserve(raw.size() + raw.size() / 65535 * 5 + 11);
+
+    for (size_t pos = 0; pos < raw.size();) {
+        const size_t length = std::min<size_t>(raw.size() - pos, 65535);
+        const bool last = pos + length == raw.size();
+
+        zlib.insert(zlib.end(), { u8(last), u8(length), u8(length >> 8),
+                                  u8(~length), u8(~length >> 8) });
+        zlib.insert(zlib.end(), raw.begin() + pos, raw.begin() + pos + length);
+        pos += length;
+    }
+
+    write_be32(zlib, adler32(raw.data(), raw.size()));
+
+    out.assign(SIGNATURE, SIGNATURE + sizeof(SIGNATURE));
+    write_chunk(out, "IHDR", header);
+    write_chunk(out, "IDAT", zlib);
+    write_chunk(out, "IEND", {});
+
+    return true;
+}
+
+bool save_png(const std::filesystem::path& path, const Image& image) {
+    std::vector<u8> data;
+
+    if (!encode_png(image, data))
+        return false;
+
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(data.data()), std::streamsize(data.size()));
+
+    return bool(file);
+}
@@ -0,0 +1,299 @@
+#include "png_kernel.hpp"
+
+#include <cstring>
+
+#include "cpu_features.hpp"
+
+namespace {
+    using UnfilterKernel = void (*)(PngFilter filter, u8* line, const u8* prev, size_t stride,
+                                    u32 bpp);
+    using PremultiplyKernel = void (*)(u32* dst, const u8* rgba, size_t count);
+
+    // x / 255 rounded to nearest, exact for x <= 255 * 255.
+    u32 div255(u32 x) {
+        x += 128;
+        return (x + (x >> 8)) >> 8;
+    }
+
+    // The first `bpp` bytes of a row have no left neighbour: Sub leaves them
+    // alone, Average and Paeth take the byte above alone.
+    void unfilter_row_scalar(PngFilter filter, u8* line, const u8* prev, size_t stride,
+                             u32 bpp) {
+        switch (filter) {
+            case FILTER_NONE:
+                break;
+            case FILTER_SUB:
+                for (size_t i = bpp; i < stride; ++i)
+                    line[i] = u8(line[i] + line[i - bpp]);
+                break;
+            case FILTER_UP:
+                for (size_t i = 0; i < stride; ++i)
+                    line[i] = u8(line[i] + prev[i]);
+                break;
+            case FILTER_AVERAGE:
+                for (size_t i = 0; i < bpp && i < stride; ++i)
+                    line[i] = u8(line[i] + prev[i] / 2);
+
+                for (size_t i = bpp; i < stride; ++i)
+                    line[i] = u8(line[i] + (line[i - bpp] + prev[i]) / 2);
+                break;
+            case FILTER_PAETH:
+                for (size_t i = 0; i < bpp && i < stride; ++i)
+                    line[i] = u8(line[i] + prev[i]);
+
+                for (size_t i = bpp; i < stride; ++i) {
+                    const u8 predictor = paeth_predictor(line[i - bpp], prev[i], prev[i - bpp]);
+                    line[i] = u8(line[i] + predictor);
+                }
+                break;
+        }
+    }
+
+    void premultiply_row_scalar(u32* dst, const u8* rgba, size_t count) {
+        for (size_t i = 0; i < count; ++i, rgba += 4) {
+            const u32 a = rgba[3];
+
+            dst[i] = div255(rgba[2] * a) | div255(rgba[1] * a) << 8 |
+                     div255(rgba[0] * a) << 16 | a << 24;
+        }
+    }
+
+#ifdef CPU_X86
+    __m128i load_pixel(const u8* p) {
+        i32 pixel;
+        memcpy(&pixel, p, 4);
+        return _mm_cvtsi32_si128(pixel);
+    }
+
+    void store_pixel(u8* p, __m128i pixel) {
+        const i32 value = _mm_cvtsi128_si32(pixel);
+        memcpy(p, &value, 4);
+    }
+
+    void unfilter_up_sse2(u8* line, const u8* prev, size_t stride) {
+        size_t i = 0;
+
+        for (; i + 16 <= stride; i += 16) {
+            const __m128i x = _mm_loadu_si128((const __m128i*) (line + i));
+            const __m128i b = _mm_loadu_si128((const __m128i*) (prev + i));
+            _mm_storeu_si128((__m128i*) (line + i), _mm_add_epi8(x, b));
+        }
+
+        for (; i < stride; ++i)
+            line[i] = u8(line[i] + prev[i]);
+    }
+
+    // A prefix sum over the pixels: each of the four of a vector gets the
+    // ones on its left added in two shifted steps, then the last pixel of
+    // the vector before.
+    void unfilter_sub4_sse2(u8* line, size_t stride) {
+        __m128i a = _mm_setzero_si128();
+        size_t i = 0;
+
+        for (; i + 16 <= stride; i += 16) {
+            __m128i x = _mm_loadu_si128((const __m128i*) (line + i));
+
+            x = _mm_add_epi8(x, _mm_slli_si128(x, 4));
+            x = _mm_add_epi8(x, _mm_slli_si128(x, 8));
+            x = _mm_add_epi8(x, a);
+
+            _mm_storeu_si128((__m128i*) (line + i), x);
+            a = _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 3, 3));
+        }
+
+        for (; i < stride; i += 4) {
+            a = _mm_add_epi8(load_pixel(line + i), a);
+            store_pixel(line + i, a);
+        }
+    }
+
+    void unfilter_average4_sse2(u8* line, const u8* prev, size_t stride) {
+        const __m128i one = _mm_set1_epi8(1);
+        __m128i a = _mm_setzero_si128();
+
+        for (size_t i = 0; i < stride; i += 4) {
+            const __m128i b = load_pixel(prev + i);
+
+            // pavgb rounds up; the filter rounds down.
+            const __m128i average = _mm_sub_epi8(_mm_avg_epu8(a, b),
+                                                 _mm_and_si128(_mm_xor_si128(a, b), one));
+
+            a = _mm_add_epi8(load_pixel(line + i), average);
+            store_pixel(line + i, a);
+        }
+    }
+
+    __m128i abs_epi16(__m128i x) {
+        return _mm_max_epi16(x, _mm_sub_epi16(_mm_setzero_si128(), x));
+    }
+
+    __m128i select(__m128i mask, __m128i yes, __m128i no) {
+        return _mm_or_si128(_mm_and_si128(mask, yes), _mm_andnot_si128(mask, no));
+    }
+
+    // `paeth_predictor` on 16-bit lanes, one pixel at a time:
+    // pa = |b - c|, pb = |a - c| and pc = |a + b - 2c|, then a on ties with
+    // the smallest, b on ties between the other two.
+    void unfilter_paeth4_sse2(u8* line, const u8* prev, size_t stride) {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i low_byte = _mm_set1_epi16(0xff);
+        __m128i a = zero;
+        __m128i c = zero;
+
+        for (size_t i = 0; i < stride; i += 4) {
+            const __m128i b = _mm_unpacklo_epi8(load_pixel(prev + i), zero);
+            const __m128i x = _mm_unpacklo_epi8(load_pixel(line + i), zero);
+
+            const __m128i b_c = _mm_sub_epi16(b, c);
+            const __m128i a_c = _mm_sub_epi16(a, c);
+            const __m128i pa = abs_epi16(b_c);
+            const __m128i pb = abs_epi16(a_c);
+            const __m128i pc = abs_epi16(_mm_add_epi16(b_c, a_c));
+            const __m128i smallest = _mm_min_epi16(pa, _mm_min_epi16(pb, pc));
+
+            __m128i predictor = select(_mm_cmpeq_epi16(smallest, pb), b, c);
+            predictor = select(_mm_cmpeq_epi16(smallest, pa), a, predictor);
+
+            a = _mm_and_si128(_mm_add_epi16(x, predictor), low_byte);
+            store_pixel(line + i, _mm_packus_epi16(a, a));
+            c = b;
+        }
+    }
+
+    void unfilter_row_sse2(PngFilter filter, u8* line, const u8* prev, size_t stride, u32 bpp) {
+        if (filter == FILTER_UP) {
+            unfilter_up_sse2(line, prev, stride);
+            return;
+        }
+
+        if (bpp != 4) {
+            unfilter_row_scalar(filter, line, prev, stride, bpp);
+            return;
+        }
+
+        switch (filter) {
+            case FILTER_SUB: unfilter_sub4_sse2(line, stride); break;
+            case FILTER_AVERAGE: unfilter_average4_sse2(line, prev, stride); break;
+            case FILTER_PAETH: unfilter_paeth4_sse2(line, prev, stride); break;
+            default: break;
+        }
+    }
+
+    TARGET_AVX2
+    void unfilter_row_avx2(PngFilter filter, u8* line, const u8* prev, size_t stride, u32 bpp) {
+        if (filter != FILTER_UP) {
+            unfilter_row_sse2(filter, line, prev, stride, bpp);
+            return;
+        }
+
+        size_t i = 0;
+
+        for (; i + 32 <= stride; i += 32) {
+            const __m256i x = _mm256_loadu_si256((const __m256i*) (line + i));
+            const __m256i b = _mm256_loadu_si256((const __m256i*) (prev + i));
+            _mm256_storeu_si256((__m256i*) (line + i), _mm256_add_epi8(x, b));
+        }
+
+        for (; i < stride; ++i)
+            line[i] = u8(line[i] + prev[i]);
+    }
+
+    // Two pixels as 16-bit RGBA lanes: times their alpha (255 for the alpha
+    // lane itself, which stays as it is), divided by 255 as `div255` does,
+    // and swizzled to BGRA.
+    __m128i premultiply_half_sse2(__m128i x) {
+        const __m128i keep_color = _mm_setr_epi16(-1, -1, -1, 0, -1, -1, -1, 0);
+        const __m128i opaque = _mm_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255);
+
+        __m128i alpha = _mm_shufflelo_epi16(x, _MM_SHUFFLE(3, 3, 3, 3));
+        alpha = _mm_shufflehi_epi16(alpha, _MM_SHUFFLE(3, 3, 3, 3));
+        alpha = _mm_or_si128(_mm_and_si128(alpha, keep_color), opaque);
+
+        __m128i t = _mm_add_epi16(_mm_mullo_epi16(x, alpha), _mm_set1_epi16(128));
+        t = _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+
+        t = _mm_shufflelo_epi16(t, _MM_SHUFFLE(3, 0, 1, 2));
+        return _mm_shufflehi_epi16(t, _MM_SHUFFLE(3, 0, 1, 2));
+    }
+
+    void premultiply_row_sse2(u32* dst, const u8* rgba, size_t count) {
+        const __m128i zero = _mm_setzero_si128();
+        size_t i = 0;
+
+        for (; i + 4 <= count; i += 4) {
+            const __m128i x = _mm_loadu_si128((const __m128i*) (rgba + i * 4));
+            const __m128i lo = premultiply_half_sse2(_mm_unpacklo_epi8(x, zero));
+            const __m128i hi = premultiply_half_sse2(_mm_unpackhi_epi8(x, zero));
+
+            _mm_storeu_si128((__m128i*) (dst + i), _mm_packus_epi16(lo, hi));
+        }
+
+        premultiply_row_scalar(dst + i, rgba + i * 4, count - i);
+    }
+
+    TARGET_AVX2
+    __m256i premultiply_half_avx2(__m256i x) {
+        const __m256i keep_color = _mm256_setr_epi16(-1, -1, -1, 0, -1, -1, -1, 0,
+                                                     -1, -1, -1, 0, -1, -1, -1, 0);
+        const __m256i opaque = _mm256_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255,
+                                                 0, 0, 0, 255, 0, 0, 0, 255);
+
+        __m256i alpha = _mm256_shufflelo_epi16(x, _MM_SHUFFLE(3, 3, 3, 3));
+        alpha = _mm256_shufflehi_epi16(alpha, _MM_SHUFFLE(3, 3, 3, 3));
+        alpha = _mm256_or_si256(_mm256_and_si256(alpha, keep_color), opaque);
+
+        __m256i t = _mm256_add_epi16(_mm256_mullo_epi16(x, alpha), _mm256_set1_epi16(128));
+        t = _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+
+        t = _mm256_shufflelo_epi16(t, _MM_SHUFFLE(3, 0, 1, 2));
+        return _mm256_shufflehi_epi16(t, _MM_SHUFFLE(3, 0, 1, 2));
+    }
+
+    // Unpacking and packing both work within 128-bit lanes, so the pixels
+    // come out in the order they went in.
+    TARGET_AVX2
+    void premultiply_row_avx2(u32* dst, const u8* rgba, size_t count) {
+        const __m256i zero = _mm256_setzero_si256();
+        size_t i = 0;
+
+        for (; i + 8 <= count; i += 8) {
+            const __m256i x = _mm256_loadu_si256((const __m256i*) (rgba + i * 4));
+            const __m256i lo = premultiply_half_avx2(_mm256_unpacklo_epi8(x, zero));
+            const __m256i hi = premultiply_half_avx2(_mm256_unpackhi_epi8(x, zero));
+
+            _mm256_storeu_si256((__m256i*) (dst + i), _mm256_packus_epi16(lo, hi));
+        }
+
+        premultiply_row_sse2(dst + i, rgba + i * 4, count - i);
+    }
+#endif // CPU_X86
+
+    struct Kernels {
+        UnfilterKernel unfilter;
+        PremultiplyKernel premultiply;
+    };
+
+    KernelDispatch<Kernels> dispatch {
+#ifdef CPU_X86
+        { "avx2", { unfilter_row_avx2, premultiply_row_avx2 }, cpu_has_avx2() },
+        { "sse2", { unfilter_row_sse2, premultiply_row_sse2 }, true },
+#endif
+        { "scalar", { unfilter_row_scalar, premultiply_row_scalar }, true },
+    };
+}
+
+void unfilter_row(PngFilter filter, u8* line, const u8* prev, size_t stride, u32 bpp) {
+    dispatch.kernels().unfilter(filter, line, prev, stride, bpp);
+}
+
+void premultiply_row(u32* dst, const u8* rgba, size_t count) {
+    dispatch.kernels().premultiply(dst, rgba, count);
+}
+
+const char* png_kernel_name() {
+    return dispatch.name();
+}
+
+bool select_png_kernel(const char* name) {
+    return dispatch.select(name);
+}
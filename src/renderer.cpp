@@ -0,0 +1,121 @@
+#include "renderer.hpp"
+
+#include "game.hpp"
+#include "trace.hpp"
+
+void ScenePainter::paint_controller(Renderer& renderer, const Game& game, f32 alpha) {
+    TRACE_SCOPE("ScenePainter::paint_controller");
+
+    const Vector controller_pos = lerp(game.prev_controller_pos, game.controller_pos, alpha);
+    const SizeF size = renderer.sprite_size(Renderer::SPRITE_CONTROLLER);
+    const SpriteInstance instance { controller_pos, 1.f, 1.f };
+
+    renderer.draw_sprite(Renderer::SPRITE_CONTROLLER, instance_rect(instance, size), 1.f);
+
+#ifdef PAINT_CONTOUR_DBG
+    renderer.draw_contour_dbg(game.spirits.controller.contour.vertices, controller_pos);
+#endif // PAINT_CONTOUR_DBG
+}
+
+// Newest first, so older entities are painted over newer ones; destroyed
+// ones shrink with their `size`, which stays 1 while they are alive.
+template<typename Spirit>
+void ScenePainter::paint_entities(Renderer& renderer, const EntityPool& pool,
+                                  Renderer::SpriteKind sprite, const Spirit& spirit, f32 alpha) {
+    const size_t count = pool.count();
+
+    instances.resize(count);
+
+    for (size_t k = 0; k < count; ++k) {
+        const size_t i = count - 1 - k;
+
+        instances[k] = { pool.interpolated_pos(i, alpha), pool.size[i], 1.f };
+    }
+
+    if (submission == SUBMISSION_BATCHED) {
+        renderer.draw_sprites(sprite, instances);
+    } else /* SUBMISSION_PER_SPRITE */ {
+        const SizeF size = renderer.sprite_size(sprite);
+
+        for (const SpriteInstance& instance : instances)
+            renderer.draw_sprite(sprite, instance_rect(instance, size), instance.opacity);
+    }
+
+#ifdef PAINT_CONTOUR_DBG
+    for (const SpriteInstance& instance : instances)
+        renderer.draw_contour_dbg(spirit.contour.vertices, instance.center);
+#else
+    (void) spirit;
+#endif // PAINT_CONTOUR_DBG
+}
+
+void ScenePainter::paint_asteroids(Renderer& renderer, const Game& game, f32 alpha) {
+    TRACE_SCOPE("ScenePainter::paint_asteroids");
+    paint_entities(renderer, game.asteroids, Renderer::SPRITE_ASTEROID,
+                   game.spirits.asteroid, alpha);
+}
+
+void ScenePainter::paint_bullets(Renderer& renderer, const Game& game, f32 alpha) {
+    TRACE_SCOPE("ScenePainter::paint_bullets");
+    paint_entities(renderer, game.bullets, Renderer::SPRITE_BULLET, game.spirits.bullet, alpha);
+}
+
+void ScenePainter::paint(Renderer& renderer, const Game& game, f32 alpha) {
+    TRACE_SCOPE("ScenePainter::paint");
+
+    const SizeF frame = renderer.frame_size();
+    const RectF whole_frame { 0.f, 0.f, frame.width, frame.height };
+
+    if (game.State == Game::GAME_PLAY || game.State == Game::GAME_OVER ||
+        game.State == Game::FADE_IN) {
+        f32 gameplay_opacity;
+
+        if (game.State == Game::GAME_OVER)
+            gameplay_opacity = 1.f - game.game_over_progress;
+        else if (game.State == Game::FADE_IN)
+            gameplay_opacity = game.fade_in_progress;
+        else /* GAME_PLAY */
+            gameplay_opacity = 1.f;
+
+        // Paint background.
+        if (game.paint_blue > 0.f) {
+            renderer.draw_sprite(Renderer::SPRITE_BLUE_BACKGROUND, whole_frame,
+                                 game.paint_blue * gameplay_opacity);
+        } else {
+            renderer.draw_sprite(Renderer::SPRITE_RED_BACKGROUND, whole_frame,
+                                 game.penalty * gameplay_opacity);
+        }
+
+        paint_controller(renderer, game, alpha);
+        paint_asteroids(renderer, game, alpha);
+        paint_bullets(renderer, game, alpha);
+
+        if (game.State == Game::FADE_IN)
+            renderer.draw_chosen_level(game.chosen_next_difficulty, 1.f - game.fade_in_progress);
+
+        if (game.State == Game::GAME_OVER)
+            renderer.draw_game_over(game.game_over_progress);
+
+        renderer.draw_data(game.score, game.difficulty);
+
+        if (game.penalty > 0.f)
+            renderer.draw_penalty(game.penalty * gameplay_opacity, game.penalty_points_total);
+    }
+    else if (game.State == Game::CHOOSE_NEW_LEVEL) {
+        paint_asteroids(renderer, game, alpha);
+        paint_bullets(renderer, game, alpha);
+
+        renderer.draw_data(game.score, game.difficulty);
+
+        auto [choose_next_txt, choose_next_len] = game.typewriter_animation.get_text();
+        renderer.draw_next_text(choose_next_txt, choose_next_len);
+        renderer.draw_chosen_level(game.chosen_next_difficulty, 1.f);
+
+    } else if (game.State == Game::FADE_OUT) {
+        paint_asteroids(renderer, game, alpha);
+        paint_bullets(renderer, game, alpha);
+
+        renderer.draw_game_over(1.f);
+        renderer.draw_data(game.score, game.difficulty);
+    }
+}
@@ -0,0 +1,166 @@
+#include "replay.hpp"
+
+#include <bit>
+#include <cstring>
+
+namespace {
+    constexpr char MAGIC[4] = { 'A', 'S', 'R', 'P' };
+    constexpr u64 VERSION = 2;
+
+    // The writer hits the disk once this much is buffered.
+    constexpr size_t FLUSH_THRESHOLD = 4096;
+}
+
+bool ReplayWriter::Init(const std::filesystem::path& path, const ReplayHeader& header) {
+    file.open(path, std::ios::binary | std::ios::trunc);
+
+    if (!file)
+        return false;
+
+    file.write(MAGIC, sizeof(MAGIC));
+    buffer.clear();
+
+    put_varint(VERSION);
+    put_varint(header.seed);
+    put_varint(header.tick_rate);
+    put_varint(u32(header.start_level));
+    put_varint(std::bit_cast<u32>(header.size.width));
+    put_varint(std::bit_cast<u32>(header.size.height));
+    put_varint(u32(header.narrowphase));
+
+    run_ticks = 0;
+    finished = false;
+
+    return flush_buffer();
+}
+
+ReplayWriter::~ReplayWriter() {
+    if (!finished)
+        Finish();
+}
+
+void ReplayWriter::put_varint(u64 value) {
+    while (value >= 0x80) {
+        buffer.push_back(u8(value | 0x80));
+        value >>= 7;
+    }
+
+    buffer.push_back(u8(value));
+}
+
+bool ReplayWriter::flush_run() {
+    if (run_ticks)
+        put_varint(run_ticks << INPUT_BITS | run_mask);
+
+    run_ticks = 0;
+
+    return buffer.size() < FLUSH_THRESHOLD || flush_buffer();
+}
+
+bool ReplayWriter::flush_buffer() {
+    file.write((const char*) buffer.data(), std::streamsize(buffer.size()));
+    buffer.clear();
+
+    return !!file;
+}
+
+bool ReplayWriter::record(const Input& input) {
+    const u8 mask = pack_input(input);
+
+    if (run_ticks && mask != run_mask && !flush_run())
+        return false;
+
+    run_mask = mask;
+    ++run_ticks;
+
+    return true;
+}
+
+bool ReplayWriter::Finish() {
+    if (finished)
+        return true;
+
+    finished = true;
+
+    if (!flush_run())
+        return false;
+
+    put_varint(0);
+
+    if (!flush_buffer())
+        return false;
+
+    file.close();
+
+    return !!file;
+}
+
+bool ReplayReader::get_varint(u64& value) {
+    value = 0;
+
+    for (u32 shift = 0; shift < 64; shift += 7) {
+        const int byte = file.get();
+
+        if (byte == std::char_traits<char>::eof())
+            return false;
+
+        value |= u64(byte & 0x7f) << shift;
+
+        if (!(byte & 0x80))
+            return true;
+    }
+
+    return false;
+}
+
+bool ReplayReader::Init(const std::filesystem::path& path) {
+    file.open(path, std::ios::binary);
+
+    if (!file)
+        return false;
+
+    char magic[sizeof(MAGIC)];
+
+    if (!file.read(magic, sizeof(magic)) || memcmp(magic, MAGIC, sizeof(MAGIC)))
+        return false;
+
+    u64 version, seed, tick_rate, start_level, width, height, narrowphase;
+
+    if (!get_varint(version) || version != VERSION ||
+        !get_varint(seed) || !get_varint(tick_rate) || !get_varint(start_level) ||
+        !get_varint(width) || !get_varint(height) || !get_varint(narrowphase) ||
+        narrowphase > Game::NARROWPHASE_MASK) {
+        return false;
+    }
+
+    header = ReplayHeader {
+        .seed = u32(seed),
+        .tick_rate = u32(tick_rate),
+        .start_level = i32(start_level),
+        .size = SizeF { std::bit_cast<f32>(u32(width)), std::bit_cast<f32>(u32(height)) },
+        .narrowphase = Game::NarrowphaseKind(narrowphase),
+    };
+
+    run_ticks = 0;
+
+    return true;
+}
+
+bool ReplayReader::next(Input& input) {
+    if (!run_ticks) {
+        u64 run;
+
+        // A run of no ticks is not written by `ReplayWriter`; one with an
+        // input would wrap `run_ticks` and never end.
+        if (!get_varint(run) || run >> INPUT_BITS == 0)
+            return false;
+
+        run_ticks = run >> INPUT_BITS;
+        run_mask = u8(run & ((1 << INPUT_BITS) - 1));
+    }
+
+    --run_ticks;
+    input = unpack_input(run_mask);
+
+    return true;
+}
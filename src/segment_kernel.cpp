@@ -0,0 +1,110 @@
+#include "segment_kernel.hpp"
+
+#include "cpu_features.hpp"
+
+namespace {
+    using Kernel = bool (*)(const Vector& a, const Vector& b, const EdgeColumns& edges);
+
+    bool intersect_any_scalar(const Vector& a, const Vector& b, const EdgeColumns& edges) {
+        for (size_t i = 0; i < edges.count; ++i) {
+            const Vector c(edges.ax[i], edges.ay[i]);
+            const Vector d(edges.bx[i], edges.by[i]);
+
+            if (intersect(a, b, c, d))
+                return true;
+        }
+
+        return false;
+    }
+
+#ifdef CPU_X86
+    // Every `clockwise` below is spelled out with the same operands in the
+    // same order as the scalar one, so the rounding is identical.
+    //
+    //   clockwise(a, c, d) = (c.y - a.y) * (d.x - a.x) > (d.y - a.y) * (c.x - a.x)
+    //   clockwise(b, c, d) = (c.y - b.y) * (d.x - b.x) > (d.y - b.y) * (c.x - b.x)
+    //   clockwise(a, b, c) = (b.y - a.y) * (c.x - a.x) > (c.y - a.y) * (b.x - a.x)
+    //   clockwise(a, b, d) = (b.y - a.y) * (d.x - a.x) > (d.y - a.y) * (b.x - a.x)
+
+    bool intersect_any_sse2(const Vector& a, const Vector& b, const EdgeColumns& edges) {
+        const __m128 ax = _mm_set1_ps(a.x), ay = _mm_set1_ps(a.y);
+        const __m128 bx = _mm_set1_ps(b.x), by = _mm_set1_ps(b.y);
+        const __m128 ab_x = _mm_set1_ps(b.x - a.x), ab_y = _mm_set1_ps(b.y - a.y);
+
+        for (size_t i = 0; i < edges.count; i += 4) {
+            const __m128 cx = _mm_loadu_ps(edges.ax + i), cy = _mm_loadu_ps(edges.ay + i);
+            const __m128 dx = _mm_loadu_ps(edges.bx + i), dy = _mm_loadu_ps(edges.by + i);
+
+            const __m128 ac_x = _mm_sub_ps(cx, ax), ac_y = _mm_sub_ps(cy, ay);
+            const __m128 ad_x = _mm_sub_ps(dx, ax), ad_y = _mm_sub_ps(dy, ay);
+            const __m128 bc_x = _mm_sub_ps(cx, bx), bc_y = _mm_sub_ps(cy, by);
+            const __m128 bd_x = _mm_sub_ps(dx, bx), bd_y = _mm_sub_ps(dy, by);
+
+            const __m128 acd = _mm_cmpgt_ps(_mm_mul_ps(ac_y, ad_x), _mm_mul_ps(ad_y, ac_x));
+            const __m128 bcd = _mm_cmpgt_ps(_mm_mul_ps(bc_y, bd_x), _mm_mul_ps(bd_y, bc_x));
+            const __m128 abc = _mm_cmpgt_ps(_mm_mul_ps(ab_y, ac_x), _mm_mul_ps(ac_y, ab_x));
+            const __m128 abd = _mm_cmpgt_ps(_mm_mul_ps(ab_y, ad_x), _mm_mul_ps(ad_y, ab_x));
+
+            const __m128 hit = _mm_and_ps(_mm_xor_ps(acd, bcd), _mm_xor_ps(abc, abd));
+
+            if (_mm_movemask_ps(hit))
+                return true;
+        }
+
+        return false;
+    }
+
+    TARGET_AVX2
+    bool intersect_any_avx2(const Vector& a, const Vector& b, const EdgeColumns& edges) {
+        const __m256 ax = _mm256_set1_ps(a.x), ay = _mm256_set1_ps(a.y);
+        const __m256 bx = _mm256_set1_ps(b.x), by = _mm256_set1_ps(b.y);
+        const __m256 ab_x = _mm256_set1_ps(b.x - a.x), ab_y = _mm256_set1_ps(b.y - a.y);
+
+        for (size_t i = 0; i < edges.count; i += 8) {
+            const __m256 cx = _mm256_loadu_ps(edges.ax + i), cy = _mm256_loadu_ps(edges.ay + i);
+            const __m256 dx = _mm256_loadu_ps(edges.bx + i), dy = _mm256_loadu_ps(edges.by + i);
+
+            const __m256 ac_x = _mm256_sub_ps(cx, ax), ac_y = _mm256_sub_ps(cy, ay);
+            const __m256 ad_x = _mm256_sub_ps(dx, ax), ad_y = _mm256_sub_ps(dy, ay);
+            const __m256 bc_x = _mm256_sub_ps(cx, bx), bc_y = _mm256_sub_ps(cy, by);
+            const __m256 bd_x = _mm256_sub_ps(dx, bx), bd_y = _mm256_sub_ps(dy, by);
+
+            const __m256 acd = _mm256_cmp_ps(_mm256_mul_ps(ac_y, ad_x),
+                                             _mm256_mul_ps(ad_y, ac_x), _CMP_GT_OQ);
+            const __m256 bcd = _mm256_cmp_ps(_mm256_mul_ps(bc_y, bd_x),
+                                             _mm256_mul_ps(bd_y, bc_x), _CMP_GT_OQ);
+            const __m256 abc = _mm256_cmp_ps(_mm256_mul_ps(ab_y, ac_x),
+                                             _mm256_mul_ps(ac_y, ab_x), _CMP_GT_OQ);
+            const __m256 abd = _mm256_cmp_ps(_mm256_mul_ps(ab_y, ad_x),
+                                             _mm256_mul_ps(ad_y, ab_x), _CMP_GT_OQ);
+
+            const __m256 hit = _mm256_and_ps(_mm256_xor_ps(acd, bcd), _mm256_xor_ps(abc, abd));
+
+            if (_mm256_movemask_ps(hit))
+                return true;
+        }
+
+        return false;
+    }
+#endif // CPU_X86
+
+    KernelDispatch<Kernel> dispatch {
+#ifdef CPU_X86
+        { "avx2", intersect_any_avx2, cpu_has_avx2() },
+        { "sse2", intersect_any_sse2, true },
+#endif
+        { "scalar", intersect_any_scalar, true },
+    };
+}
+
+bool intersect_any(const Vector& a, const Vector& b, const EdgeColumns& edges) {
+    return dispatch.kernels()(a, b, edges);
+}
+
+const char* segment_kernel_name() {
+    return dispatch.name();
+}
+
+bool select_segment_kernel(const char* name) {
+    return dispatch.select(name);
+}
@@ -0,0 +1,518 @@
+#include "soft_renderer.hpp"
+
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+#include "spirits_gen.hpp"
+#include "trace.hpp"
+
+namespace {
+    // Classic 5x8 font, printable ASCII: one byte per column, left to right,
+    // the lowest bit on top. Rows 0-6 are the body, row 7 the descenders.
+    constexpr u8 FONT[][5] = {
+        { 0x00, 0x00, 0x00, 0x00, 0x00 }, // ' '
+        { 0x00, 0x00, 0x5f, 0x00, 0x00 }, // '!'
+        { 0x00, 0x07, 0x00, 0x07, 0x00 }, // '"'
+        { 0x14, 0x7f, 0x14, 0x7f, 0x14 }, // '#'
+        { 0x24, 0x2a, 0x7f, 0x2a, 0x12 }, // '$'
+        { 0x23, 0x13, 0x08, 0x64, 0x62 }, // '%'
+        { 0x36, 0x49, 0x55, 0x22, 0x50 }, // '&'
+        { 0x00, 0x05, 0x03, 0x00, 0x00 }, // '''
+        { 0x00, 0x1c, 0x22, 0x41, 0x00 }, // '('
+        { 0x00, 0x41, 0x22, 0x1c, 0x00 }, // ')'
+        { 0x14, 0x08, 0x3e, 0x08, 0x14 }, // '*'
+        { 0x08, 0x08, 0x3e, 0x08, 0x08 }, // '+'
+        { 0x00, 0x50, 0x30, 0x00, 0x00 }, // ','
+        { 0x08, 0x08, 0x08, 0x08, 0x08 }, // '-'
+        { 0x00, 0x60, 0x60, 0x00, 0x00 }, // '.'
+        { 0x20, 0x10, 0x08, 0x04, 0x02 }, // '/'
+        { 0x3e, 0x51, 0x49, 0x45, 0x3e }, // '0'
+        { 0x00, 0x42, 0x7f, 0x40, 0x00 }, // '1'
+        { 0x42, 0x61, 0x51, 0x49, 0x46 }, // '2'
+        { 0x21, 0x41, 0x45, 0x4b, 0x31 }, // '3'
+        { 0x18, 0x14, 0x12, 0x7f, 0x10 }, // '4'
+        { 0x27, 0x45, 0x45, 0x45, 0x39 }, // '5'
+        { 0x3c, 0x4a, 0x49, 0x49, 0x30 }, // '6'
+        { 0x01, 0x71, 0x09, 0x05, 0x03 }, // '7'
+        { 0x36, 0x49, 0x49, 0x49, 0x36 }, // '8'
+        { 0x06, 0x49, 0x49, 0x29, 0x1e }, // '9'
+        { 0x00, 0x36, 0x36, 0x00, 0x00 }, // ':'
+        { 0x00, 0x56, 0x36, 0x00, 0x00 }, // ';'
+        { 0x08, 0x14, 0x22, 0x41, 0x00 }, // '<'
+        { 0x14, 0x14, 0x14, 0x14, 0x14 }, // '='
+        { 0x00, 0x41, 0x22, 0x14, 0x08 }, // '>'
+        { 0x02, 0x01, 0x51, 0x09, 0x06 }, // '?'
+        { 0x32, 0x49, 0x79, 0x41, 0x3e }, // '@'
+        { 0x7e, 0x11, 0x11, 0x11, 0x7e }, // 'A'
+        { 0x7f, 0x49, 0x49, 0x49, 0x36 }, // 'B'
+        { 0x3e, 0x41, 0x41, 0x41, 0x22 }, // 'C'
+        { 0x7f, 0x41, 0x41, 0x22, 0x1c }, // 'D'
+        { 0x7f, 0x49, 0x49, 0x49, 0x41 }, // 'E'
+        { 0x7f, 0x09, 0x09, 0x09, 0x01 }, // 'F'
+        { 0x3e, 0x41, 0x49, 0x49, 0x7a }, // 'G'
+        { 0x7f, 0x08, 0x08, 0x08, 0x7f }, // 'H'
+        { 0x00, 0x41, 0x7f, 0x41, 0x00 }, // 'I'
+        { 0x20, 0x40, 0x41, 0x3f, 0x01 }, // 'J'
+        { 0x7f, 0x08, 0x14, 0x22, 0x41 }, // 'K'
+        { 0x7f, 0x40, 0x40, 0x40, 0x40 }, // 'L'
+        { 0x7f, 0x02, 0x0c, 0x02, 0x7f }, // 'M'
+        { 0x7f, 0x04, 0x08, 0x10, 0x7f }, // 'N'
+        { 0x3e, 0x41, 0x41, 0x41, 0x3e }, // 'O'
+        { 0x7f, 0x09, 0x09, 0x09, 0x06 }, // 'P'
+        { 0x3e, 0x41, 0x51, 0x21, 0x5e }, // 'Q'
+        { 0x7f, 0x09, 0x19, 0x29, 0x46 }, // 'R'
+        { 0x46, 0x49, 0x49, 0x49, 0x31 }, // 'S'
+        { 0x01, 0x01, 0x7f, 0x01, 0x01 }, // 'T'
+        { 0x3f, 0x40, 0x40, 0x40, 0x3f }, // 'U'
+        { 0x1f, 0x20, 0x40, 0x20, 0x1f }, // 'V'
+        { 0x3f, 0x40, 0x38, 0x40, 0x3f }, // 'W'
+        { 0x63, 0x14, 0x08, 0x14, 0x63 }, // 'X'
+        { 0x07, 0x08, 0x70, 0x08, 0x07 }, // 'Y'
+        { 0x61, 0x51, 0x49, 0x45, 0x43 }, // 'Z'
+        { 0x00, 0x7f, 0x41, 0x41, 0x00 }, // '['
+        { 0x02, 0x04, 0x08, 0x10, 0x20 }, // '\'
+        { 0x00, 0x41, 0x41, 0x7f, 0x00 }, // ']'
+        { 0x04, 0x02, 0x01, 0x02, 0x04 }, // '^'
+        { 0x40, 0x40, 0x40, 0x40, 0x40 }, // '_'
+        { 0x00, 0x01, 0x02, 0x04, 0x00 }, // '`'
+        { 0x20, 0x54, 0x54, 0x54, 0x78 }, // 'a'
+        { 0x7f, 0x48, 0x44, 0x44, 0x38 }, // 'b'
+        { 0x38, 0x44, 0x44, 0x44, 0x20 }, // 'c'
+        { 0x38, 0x44, 0x44, 0x48, 0x7f }, // 'd'
+        { 0x38, 0x54, 0x54, 0x54, 0x18 }, // 'e'
+        { 0x08, 0x7e, 0x09, 0x01, 0x02 }, // 'f'
+        { 0x18, 0xa4, 0xa4, 0xa4, 0x7c }, // 'g'
+        { 0x7f, 0x08, 0x04, 0x04, 0x78 }, // 'h'
+        { 0x00, 0x44, 0x7d, 0x40, 0x00 }, // 'i'
+        { 0x40, 0x80, 0x84, 0x7d, 0x00 }, // 'j'
+        { 0x7f, 0x10, 0x28, 0x44, 0x00 }, // 'k'
+        { 0x00, 0x41, 0x7f, 0x40, 0x00 }, // 'l'
+        { 0x7c, 0x04, 0x18, 0x04, 0x78 }, // 'm'
+        { 0x7c, 0x08, 0x04, 0x04, 0x78 }, // 'n'
+        { 0x38, 0x44, 0x44, 0x44, 0x38 }, // 'o'
+        { 0xfc, 0x24, 0x24, 0x24, 0x18 }, // 'p'
+        { 0x18, 0x24, 0x24, 0x18, 0xfc }, // 'q'
+        { 0x7c, 0x08, 0x04, 0x04, 0x08 }, // 'r'
+        { 0x48, 0x54, 0x54, 0x54, 0x20 }, // 's'
+        { 0x04, 0x3f, 0x44, 0x40, 0x20 }, // 't'
+        { 0x3c, 0x40, 0x40, 0x20, 0x7c }, // 'u'
+        { 0x1c, 0x20, 0x40, 0x20, 0x1c }, // 'v'
+        { 0x3c, 0x40, 0x30, 0x40, 0x3c }, // 'w'
+        { 0x44, 0x28, 0x10, 0x28, 0x44 }, // 'x'
+        { 0x1c, 0xa0, 0xa0, 0xa0, 0x7c }, // 'y'
+        { 0x44, 0x64, 0x54, 0x4c, 0x44 }, // 'z'
+        { 0x00, 0x08, 0x36, 0x41, 0x00 }, // '{'
+        { 0x00, 0x00, 0x7f, 0x00, 0x00 }, // '|'
+        { 0x00, 0x41, 0x36, 0x08, 0x00 }, // '}'
+        { 0x08, 0x04, 0x08, 0x10, 0x08 }, // '~'
+    };
+
+    constexpr u32 GLYPH_WIDTH = 5;
+    constexpr u32 GLYPH_HEIGHT = 8;
+    constexpr u32 GLYPH_ADVANCE = 6;
+
+    static_assert(std::size(FONT) == SoftRenderer::LAST_GLYPH - SoftRenderer::FIRST_GLYPH + 1);
+
+    // Font pixels per DirectWrite font size, so that the capitals come out
+    // about as tall as those of Segoe UI.
+    constexpr f32 FONT_PIXELS_PER_SIZE = 0.1f;
+
+    constexpr u32 BLACK = 0xff000000;
+
+    u32 pack_bgra(f32 r, f32 g, f32 b, f32 a) {
+        auto byte = [](f32 value) { return u32(std::lround(std::clamp(value, 0.f, 1.f) * 255.f)); };
+        return byte(b) | byte(g) << 8 | byte(r) << 16 | byte(a) << 24;
+    }
+
+    PixelRect pixel_rect(const RectF& rect) {
+        const i32 left = i32(std::lround(rect.left));
+        const i32 top = i32(std::lround(rect.top));
+
+        return {
+            left,
+            top,
+            left + i32(std::lround(rect.right - rect.left)),
+            top + i32(std::lround(rect.bottom - rect.top)),
+        };
+    }
+
+}
+
+void composite(Framebuffer& framebuffer, const DrawCommand& command, const PixelRect& clip,
+               std::vector<u32>& scratch) {
+    const SpriteView& sprite = *command.sprite;
+    const PixelRect& rect = command.rect;
+
+    const i32 left = std::max(rect.left, clip.left);
+    const i32 right = std::min(rect.right, clip.right);
+    const i32 top = std::max(rect.top, clip.top);
+    const i32 bottom = std::min(rect.bottom, clip.bottom);
+
+    if (left >= right || top >= bottom)
+        return;
+
+    const u32 width = u32(rect.right - rect.left);
+    const u32 height = u32(rect.bottom - rect.top);
+    const size_t count = size_t(right - left);
+
+    if (width == sprite.width && height == sprite.height) {
+        for (i32 y = top; y < bottom; ++y) {
+            blend_row(framebuffer.row(u32(y)) + left,
+                      sprite.row(u32(y - rect.top)) + (left - rect.left), count,
+                      command.modulate);
+        }
+
+        return;
+    }
+
+    // Source column of every painted column, then one stretched row at a time.
+    scratch.resize(count * 2);
+    u32* columns = scratch.data();
+    u32* stretched = scratch.data() + count;
+
+    for (size_t i = 0; i < count; ++i) {
+        const u64 x = u64(left - rect.left) + i;
+        columns[i] = u32((2 * x + 1) * sprite.width / (2 * u64(width)));
+    }
+
+    for (i32 y = top; y < bottom; ++y) {
+        const u64 dy = u64(y - rect.top);
+        const u32* in = sprite.row(u32((2 * dy + 1) * sprite.height / (2 * u64(height))));
+
+        for (size_t i = 0; i < count; ++i)
+            stretched[i] = in[columns[i]];
+
+        blend_row(framebuffer.row(u32(y)) + left, stretched, count, command.modulate);
+    }
+}
+
+bool SoftRenderer::Init(const std::filesystem::path& root, u32 width, u32 height) {
+    if (!width || !height)
+        return false;
+
+    framebuffer.width = width;
+    framebuffer.height = height;
+    framebuffer.pixels.assign(size_t(width) * height, BLACK);
+
+    tiles_x = (width + TILE_WIDTH - 1) / TILE_WIDTH;
+    tiles_y = (height + TILE_HEIGHT - 1) / TILE_HEIGHT;
+    bins.assign(size_t(tiles_x) * tiles_y, {});
+
+    packed = pack.Init(root / ASSET_PACK_PATH) && pack.load_atlas(1.f, atlas, spirits);
+
+    if (!packed) {
+        if (!add_spirit_sprites(root, 1.f, atlas, spirits, jobs))
+            return false;
+
+        atlas.pack();
+    }
+
+    std::array<SpriteAtlas::SpriteId, LAST_GLYPH - FIRST_GLYPH + 1> glyph_ids;
+
+    for (size_t g = 0; g < glyphs.size(); ++g) {
+        Sprite glyph;
+
+        glyph.width = GLYPH_WIDTH;
+        glyph.height = GLYPH_HEIGHT;
+        glyph.pixels.assign(GLYPH_WIDTH * GLYPH_HEIGHT, 0);
+
+        for (u32 x = 0; x < GLYPH_WIDTH; ++x) {
+            for (u32 y = 0; y < GLYPH_HEIGHT; ++y) {
+                if (FONT[g][x] >> y & 1)
+                    glyph.pixels[y * GLYPH_WIDTH + x] = 0xffffffff;
+            }
+        }
+
+        glyph_ids[g] = font.add(glyph, GLYPH_WIDTH, GLYPH_HEIGHT, 1);
+    }
+
+    font.pack();
+
+    for (u32 i = 0; i < SpiritSprites::COUNT; ++i) {
+        const SpriteAtlas::SpriteId id = spirits.ids[i];
+
+        for (u32 level = 0; level < atlas.level_count(id); ++level)
+            levels[i].push_back(atlas.view(id, level));
+
+        sizes[i] = spirits.sizes[i];
+    }
+
+    for (size_t g = 0; g < glyphs.size(); ++g)
+        glyphs[g] = font.view(glyph_ids[g], 0);
+
+    create_gradient(Palette::RED_GRADIENT, backgrounds[0]);
+    create_gradient(Palette::BLUE_GRADIENT, backgrounds[1]);
+    levels[SPRITE_RED_BACKGROUND] = { view_of(backgrounds[0]) };
+    levels[SPRITE_BLUE_BACKGROUND] = { view_of(backgrounds[1]) };
+    sizes[SPRITE_RED_BACKGROUND] = sizes[SPRITE_BLUE_BACKGROUND] = frame_size();
+
+    return true;
+}
+
+// Same stops as `WindowLogic::create_gradient`, interpolated in gamma space
+// like D2D1_GAMMA_2_2 does; constant down the frame.
+void SoftRenderer::create_gradient(const GradientColors& colors, Sprite& sprite) const {
+    sprite.width = framebuffer.width;
+    sprite.height = framebuffer.height;
+    sprite.pixels.resize(size_t(sprite.width) * sprite.height);
+
+    const ColorF& side = colors.side;
+    const ColorF& middle = colors.middle;
+
+    for (u32 x = 0; x < sprite.width; ++x) {
+        const f32 position = (f32(x) + 0.5f) / f32(sprite.width);
+        const f32 t = 1.f - std::abs(position - 0.5f) * 2.f;
+
+        sprite.pixels[x] = pack_bgra(side.r + (middle.r - side.r) * t,
+                                     side.g + (middle.g - side.g) * t,
+                                     side.b + (middle.b - side.b) * t,
+                                     side.a + (middle.a - side.a) * t);
+    }
+
+    for (u32 y = 1; y < sprite.height; ++y)
+        std::copy_n(sprite.row(0), sprite.width, sprite.pixels.data() + size_t(y) * sprite.width);
+}
+
+void SoftRenderer::begin_frame() {
+    commands.clear();
+}
+
+void SoftRenderer::end_frame() {
+    TRACE_SCOPE("SoftRenderer::end_frame");
+
+    bin_commands();
+
+    const u32 tiles = u32(bins.size());
+    const u32 threads = jobs ? jobs->thread_count() : 1;
+
+    if (threads == 1) {
+        scratch.resize(1);
+
+        for (u32 tile = 0; tile < tiles; ++tile)
+            composite_tile(tile, scratch[0]);
+
+        return;
+    }
+
+    // Runs of neighbouring tiles, so a task walks mostly adjacent memory.
+    const u32 chunks = std::min(tiles, jobs->chunk_count());
+    scratch.resize(chunks);
+
+    TaskGraph graph;
+
+    graph.add_chunks(chunks, [this, tiles, chunks](u32 chunk) {
+        TRACE_SCOPE("composite_tiles");
+
+        const u32 end = u32(u64(tiles) * (chunk + 1) / chunks);
+
+        for (u32 tile = u32(u64(tiles) * chunk / chunks); tile < end; ++tile)
+            composite_tile(tile, scratch[chunk]);
+    });
+
+    jobs->run(graph);
+}
+
+void SoftRenderer::bin_commands() {
+    for (auto& bin : bins)
+        bin.clear();
+
+    const i32 width = i32(framebuffer.width);
+    const i32 height = i32(framebuffer.height);
+    const i32 tile_width = i32(TILE_WIDTH);
+    const i32 tile_height = i32(TILE_HEIGHT);
+
+    for (size_t i = 0; i < commands.size(); ++i) {
+        const PixelRect& rect = commands[i].rect;
+
+        const i32 left = std::max(rect.left, 0);
+        const i32 right = std::min(rect.right, width);
+        const i32 top = std::max(rect.top, 0);
+        const i32 bottom = std::min(rect.bottom, height);
+
+        if (left >= right || top >= bottom)
+            continue;
+
+        for (i32 ty = top / tile_height; ty <= (bottom - 1) / tile_height; ++ty) {
+            for (i32 tx = left / tile_width; tx <= (right - 1) / tile_width; ++tx)
+                bins[size_t(ty) * tiles_x + size_t(tx)].push_back(u32(i));
+        }
+    }
+}
+
+void SoftRenderer::composite_tile(u32 tile, std::vector<u32>& tile_scratch) {
+    const u32 left = tile % tiles_x * TILE_WIDTH;
+    const u32 top = tile / tiles_x * TILE_HEIGHT;
+    const u32 right = std::min(left + TILE_WIDTH, framebuffer.width);
+    const u32 bottom = std::min(top + TILE_HEIGHT, framebuffer.height);
+
+    for (u32 y = top; y < bottom; ++y)
+        std::fill(framebuffer.row(y) + left, framebuffer.row(y) + right, BLACK);
+
+    const PixelRect clip { i32(left), i32(top), i32(right), i32(bottom) };
+
+    for (u32 index : bins[tile])
+        composite(framebuffer, commands[index], clip, tile_scratch);
+}
+
+// The framebuffer is opaque (cleared to black, with everything blended over
+// it), so premultiplied and straight colors are the same.
+bool SoftRenderer::dump(const std::filesystem::path& path) const {
+    Image image;
+    image.width = framebuffer.width;
+    image.height = framebuffer.height;
+    image.pixels.resize(framebuffer.pixels.size() * 4);
+
+    for (size_t i = 0; i < framebuffer.pixels.size(); ++i) {
+        const u32 pixel = framebuffer.pixels[i];
+        u8* out = image.pixels.data() + i * 4;
+
+        out[0] = u8(pixel >> 16);
+        out[1] = u8(pixel >> 8);
+        out[2] = u8(pixel);
+        out[3] = 255;
+    }
+
+    return save_png(path, image);
+}
+
+SizeF SoftRenderer::frame_size() const {
+    return { f32(framebuffer.width), f32(framebuffer.height) };
+}
+
+SizeF SoftRenderer::sprite_size(SpriteKind sprite) const {
+    return sizes[sprite];
+}
+
+const SpriteView* SoftRenderer::level_view(SpriteKind sprite, const PixelRect& rect) const {
+    const std::vector<SpriteView>& views = levels[sprite];
+    const u32 width = u32(rect.right - rect.left);
+    const u32 height = u32(rect.bottom - rect.top);
+
+    // Same choice as `SpriteAtlas::level_for`.
+    size_t level = views.size() - 1;
+
+    while (level > 0 && (views[level].width < width || views[level].height < height))
+        --level;
+
+    return &views[level];
+}
+
+void SoftRenderer::draw_sprite(SpriteKind sprite, const RectF& rect, f32 opacity) {
+    const Modulate modulate = Modulate::opacity(opacity);
+    const PixelRect pixels = pixel_rect(rect);
+
+    if (modulate.a == 0 || pixels.left >= pixels.right || pixels.top >= pixels.bottom)
+        return;
+
+    commands.push_back({ level_view(sprite, pixels), pixels, modulate });
+}
+
+void SoftRenderer::draw_sprites(SpriteKind sprite, std::span<const SpriteInstance> instances) {
+    const SizeF size = sizes[sprite];
+
+    // Room for the whole batch up front; what is culled is cut off at the end.
+    size_t count = commands.size();
+    commands.resize(count + instances.size());
+
+    // Instances of a batch mostly share their opacity.
+    f32 opacity = 1.f;
+    Modulate modulate = Modulate::opacity(opacity);
+
+    for (const SpriteInstance& instance : instances) {
+        if (instance.opacity != opacity) {
+            opacity = instance.opacity;
+            modulate = Modulate::opacity(opacity);
+        }
+
+        const PixelRect pixels = pixel_rect(instance_rect(instance, size));
+
+        if (modulate.a == 0 || pixels.left >= pixels.right || pixels.top >= pixels.bottom)
+            continue;
+
+        commands[count++] = { level_view(sprite, pixels), pixels, modulate };
+    }
+
+    commands.resize(count);
+}
+
+void SoftRenderer::draw_text(const wchar_t* text, size_t len, f32 x, f32 top, f32 font_size,
+                             Align align, const ColorF& color, f32 opacity) {
+    const Modulate modulate = Modulate::tint(color.r, color.g, color.b, color.a * opacity);
+
+    if (modulate.a == 0 || len == 0)
+        return;
+
+    const i32 scale = std::max(1, i32(std::lround(font_size * FONT_PIXELS_PER_SIZE)));
+    const i32 width = i32(len * GLYPH_ADVANCE - 1) * scale;
+
+    i32 left = i32(std::lround(x));
+
+    if (align == ALIGN_CENTER)
+        left -= width / 2;
+    else if (align == ALIGN_TRAILING)
+        left -= width;
+
+    // DirectWrite leaves about that much room above the capitals.
+    const i32 cell_top = i32(std::lround(top)) + scale;
+
+    for (size_t i = 0; i < len; ++i, left += i32(GLYPH_ADVANCE) * scale) {
+        const wchar_t c = text[i] < FIRST_GLYPH || text[i] > LAST_GLYPH ? L'?' : text[i];
+
+        if (c == L' ')
+            continue;
+
+        commands.push_back({
+            &glyphs[size_t(c - FIRST_GLYPH)],
+            { left, cell_top, left + i32(GLYPH_WIDTH) * scale,
+              cell_top + i32(GLYPH_HEIGHT) * scale },
+            modulate,
+        });
+    }
+}
+
+// The texts below sit where `TextHelper` puts them.
+
+void SoftRenderer::draw_next_text(const wchar_t* text, size_t len) {
+    const SizeF size = frame_size();
+    draw_text(text, len, size.width / 2.f - 235.f, size.height / 2.f - 100.f, 30.f,
+              ALIGN_LEADING, Palette::TEXT_YELLOW, 1.f);
+}
+
+void SoftRenderer::draw_chosen_level(i32 level, f32 opacity) {
+    const SizeF size = frame_size();
+    const std::wstring text = (level == -1 ? std::wstring(L"_") : std::to_wstring(level)) +
+                              L" / 6";
+
+    draw_text(text, size.width / 2.f + 50.f, size.height / 2.f - 50.f, 70.f, ALIGN_TRAILING,
+              Palette::TEXT_GREEN, opacity);
+}
+
+void SoftRenderer::draw_game_over(f32 opacity) {
+    const SizeF size = frame_size();
+    const f32 font_size = 50.f;
+    const f32 height = font_size * FONT_PIXELS_PER_SIZE * GLYPH_HEIGHT;
+
+    draw_text(L"GAME OVER", size.width / 2.f, (size.height - height) / 2.f, font_size,
+              ALIGN_CENTER, Palette::TEXT_YELLOW, opacity);
+}
+
+void SoftRenderer::draw_penalty(f32 opacity, i32 penalty) {
+    draw_text(L"Move to safe zone!", 80.f, 50.f, 25.f, ALIGN_LEADING, Palette::TEXT_WHITE,
+              opacity);
+    draw_text(L"Penalty: ", 80.f, 75.f, 25.f, ALIGN_LEADING, Palette::TEXT_WHITE, opacity);
+    draw_text(std::to_wstring(-penalty), 80.f, 100.f, 25.f, ALIGN_LEADING,
+              Palette::TEXT_WHITE, opacity);
+}
+
+void SoftRenderer::draw_data(i32 score, u32 difficulty) {
+    const f32 labels_right = frame_size().width - 135.f;
+
+    draw_text(L"Score ", labels_right, 50.f, 25.f, ALIGN_TRAILING, Palette::TEXT_PINK, 1.f);
+    draw_text(L"Difficulty ", labels_right, 80.f, 25.f, ALIGN_TRAILING, Palette::TEXT_PINK, 1.f);
+
+    draw_text(std::to_wstring(score), labels_right + 20.f, 50.f, 25.f, ALIGN_LEADING,
+              Palette::TEXT_GREEN, 1.f);
+    draw_text(std::to_wstring(difficulty) + L" / 6", labels_right + 20.f, 80.f, 25.f,
+              ALIGN_LEADING, Palette::TEXT_GREEN, 1.f);
+}
@@ -0,0 +1,295 @@
+#include "sprite_atlas.hpp"
+
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+#include "spirits_gen.hpp"
+
+namespace {
+    u32 scaled(f32 length) {
+        return u32(std::max(1l, std::lround(length)));
+    }
+
+    // `body(0)` to `body(count - 1)`, spread over `jobs` when given.
+    template<typename Body>
+    void run_tasks(JobSystem* jobs, u32 count, Body&& body) {
+        if (!jobs || count < 2) {
+            for (u32 i = 0; i < count; ++i)
+                body(i);
+
+            return;
+        }
+
+        TaskGraph graph;
+        graph.add_chunks(count, body);
+        jobs->run(graph);
+    }
+}
+
+void resample_sprite(const Sprite& source, u32 width, u32 height, Sprite& sprite) {
+    // Weight of source pixel `i` in target pixel `o`, along one axis: the
+    // length of their overlap, with the target pixel spanning `ratio` source
+    // pixels.
+    struct Tap {
+        u32 first;
+        std::vector<f32> weights;
+    };
+
+    auto taps = [](u32 from, u32 to) {
+        const f64 ratio = f64(from) / f64(to);
+        std::vector<Tap> taps(to);
+
+        for (u32 o = 0; o < to; ++o) {
+            const f64 begin = o * ratio;
+            const f64 end = (o + 1) * ratio;
+            const u32 first = u32(begin);
+            const u32 last = std::min(from, u32(std::ceil(end)));
+
+            taps[o].first = first;
+
+            for (u32 i = first; i < last; ++i) {
+                const f64 overlap = std::min(end, f64(i + 1)) - std::max(begin, f64(i));
+                taps[o].weights.push_back(f32(overlap / ratio));
+            }
+        }
+
+        return taps;
+    };
+
+    const std::vector<Tap> columns = taps(source.width, width);
+    const std::vector<Tap> rows = taps(source.height, height);
+
+    // Horizontal pass into floats, then the vertical one.
+    std::vector<f32> wide(size_t(width) * source.height * 4);
+
+    for (u32 y = 0; y < source.height; ++y) {
+        const u32* in = source.row(y);
+
+        for (u32 x = 0; x < width; ++x) {
+            f32* out = wide.data() + (size_t(y) * width + x) * 4;
+
+            for (size_t k = 0; k < columns[x].weights.size(); ++k) {
+                const u32 pixel = in[columns[x].first + k];
+                const f32 weight = columns[x].weights[k];
+
+                for (u32 c = 0; c < 4; ++c)
+                    out[c] += f32((pixel >> (8 * c)) & 0xff) * weight;
+            }
+        }
+    }
+
+    sprite.width = width;
+    sprite.height = height;
+    sprite.pixels.assign(size_t(width) * height, 0);
+
+    for (u32 y = 0; y < height; ++y) {
+        for (u32 x = 0; x < width; ++x) {
+            f32 sum[4] = {};
+
+            for (size_t k = 0; k < rows[y].weights.size(); ++k) {
+                const f32* in = wide.data() + (size_t(rows[y].first + k) * width + x) * 4;
+
+                for (u32 c = 0; c < 4; ++c)
+                    sum[c] += in[c] * rows[y].weights[k];
+            }
+
+            // Rounded per channel, so no color can end up above the alpha.
+            u32 pixel = 0;
+
+            for (u32 c = 0; c < 4; ++c)
+                pixel |= u32(std::clamp(std::lround(sum[c]), 0l, 255l)) << (8 * c);
+
+            sprite.pixels[size_t(y) * width + x] = pixel;
+        }
+    }
+}
+
+void SpriteAtlas::make_levels(const Sprite& source, u32 width, u32 height, u32 levels,
+                              std::vector<Sprite>& resampled) {
+    resampled.resize(std::clamp(levels, 1u, MAX_LEVELS));
+
+    for (u32 level = 0; level < resampled.size(); ++level) {
+        const f32 factor = 1.f / f32(1u << level);
+
+        // Straight from the source every time, not from the level before,
+        // so every level is one area average.
+        if (source.width == width && source.height == height && level == 0)
+            resampled[level] = source;
+        else
+            resample_sprite(source, scaled(f32(width) * factor), scaled(f32(height) * factor),
+                            resampled[level]);
+    }
+}
+
+SpriteAtlas::SpriteId SpriteAtlas::add(const Sprite& source, u32 width, u32 height, u32 levels) {
+    std::vector<Sprite> resampled;
+    make_levels(source, width, height, levels, resampled);
+
+    return add_levels(std::move(resampled));
+}
+
+SpriteAtlas::SpriteId SpriteAtlas::add_levels(std::vector<Sprite> levels) {
+    sprites.emplace_back(levels.size());
+    queued.push_back(std::move(levels));
+
+    return SpriteId(sprites.size() - 1);
+}
+
+void SpriteAtlas::pack() {
+    struct Item {
+        SpriteId sprite;
+        u32 level;
+        const Sprite* pixels;
+    };
+
+    std::vector<Item> items;
+    u64 area = 0;
+    u32 widest = 0;
+
+    for (SpriteId sprite = 0; sprite < queued.size(); ++sprite) {
+        for (u32 level = 0; level < queued[sprite].size(); ++level) {
+            const Sprite& image = queued[sprite][level];
+
+            items.push_back({ sprite, level, &image });
+            area += u64(image.width + PADDING) * (image.height + PADDING);
+            widest = std::max(widest, image.width + PADDING);
+        }
+    }
+
+    std::stable_sort(items.begin(), items.end(), [](const Item& a, const Item& b) {
+        return a.pixels->height > b.pixels->height;
+    });
+
+    // About square: the first power of two past the side of the total area.
+    width = 1;
+
+    while (u64(width) * width < area)
+        width *= 2;
+
+    width = std::max(width, widest + PADDING);
+
+    // Shelves left to right, each as tall as its first (tallest) item.
+    u32 x = PADDING;
+    u32 y = PADDING;
+    u32 shelf = 0;
+
+    for (const Item& item : items) {
+        if (x + item.pixels->width + PADDING > width) {
+            x = PADDING;
+            y += shelf + PADDING;
+            shelf = 0;
+        }
+
+        sprites[item.sprite][item.level] = { x, y, item.pixels->width, item.pixels->height };
+        x += item.pixels->width + PADDING;
+        shelf = std::max(shelf, item.pixels->height);
+    }
+
+    height = y + shelf + PADDING;
+    storage.assign(size_t(width) * height, 0);
+
+    for (const Item& item : items) {
+        const AtlasRegion& region = sprites[item.sprite][item.level];
+
+        for (u32 row = 0; row < region.height; ++row) {
+            std::copy_n(item.pixels->row(row), region.width,
+                        storage.data() + size_t(region.y + row) * width + region.x);
+        }
+    }
+
+    pixels = storage.data();
+    queued.clear();
+}
+
+void SpriteAtlas::assign(u32 atlas_width, u32 atlas_height, const u32* atlas_pixels,
+                         std::vector<std::vector<AtlasRegion>> atlas_sprites) {
+    width = atlas_width;
+    height = atlas_height;
+    pixels = atlas_pixels;
+    sprites = std::move(atlas_sprites);
+
+    storage.clear();
+    queued.clear();
+}
+
+u32 SpriteAtlas::level_for(SpriteId sprite, u32 width, u32 height) const {
+    const std::vector<AtlasRegion>& levels = sprites[sprite];
+    u32 level = u32(levels.size() - 1);
+
+    while (level > 0 && (levels[level].width < width || levels[level].height < height))
+        --level;
+
+    return level;
+}
+
+SpriteView SpriteAtlas::view(SpriteId sprite, u32 level) const {
+    const AtlasRegion& region = sprites[sprite][level];
+
+    return {
+        pixels + size_t(region.y) * width + region.x,
+        region.width,
+        region.height,
+        width,
+    };
+}
+
+bool load_sprites(std::span<const std::filesystem::path> paths, std::span<Sprite> sprites,
+                  JobSystem* jobs) {
+    std::vector<u8> loaded(paths.size(), false);
+
+    run_tasks(jobs, u32(paths.size()), [&](u32 i) {
+        loaded[i] = load_png(paths[i], sprites[i]);
+    });
+
+    for (size_t i = 0; i < paths.size(); ++i) {
+        if (!loaded[i]) {
+            std::wcout << L"Failed to load bitmap (" << paths[i].wstring() << L")\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool add_spirit_sprites(const std::filesystem::path& root, f32 pixels_per_dip,
+                        SpriteAtlas& atlas, SpiritSprites& sprites, JobSystem* jobs) {
+    struct Source {
+        const wchar_t* filename;
+        f32 scale;
+    };
+
+    constexpr Source spirits[SpiritSprites::COUNT] = {
+        { Spirits::controller.filename, Spirits::controller.scale },
+        { Spirits::asteroid.filename, Spirits::asteroid.scale },
+        { Spirits::bullet.filename, Spirits::bullet.scale },
+    };
+
+    std::array<std::filesystem::path, SpiritSprites::COUNT> paths;
+    std::array<Sprite, SpiritSprites::COUNT> full;
+
+    for (u32 i = 0; i < SpiritSprites::COUNT; ++i)
+        paths[i] = root / spirits[i].filename;
+
+    if (!load_sprites(paths, full, jobs))
+        return false;
+
+    for (u32 i = 0; i < SpiritSprites::COUNT; ++i) {
+        sprites.sizes[i] = { f32(full[i].width) * spirits[i].scale,
+                             f32(full[i].height) * spirits[i].scale };
+    }
+
+    // The levels are resampled in parallel too, then added in order.
+    std::array<std::vector<Sprite>, SpiritSprites::COUNT> levels;
+
+    run_tasks(jobs, SpiritSprites::COUNT, [&](u32 i) {
+        SpriteAtlas::make_levels(full[i], scaled(sprites.sizes[i].width * pixels_per_dip),
+                                 scaled(sprites.sizes[i].height * pixels_per_dip),
+                                 SpiritSprites::MIP_LEVELS, levels[i]);
+    });
+
+    for (u32 i = 0; i < SpiritSprites::COUNT; ++i)
+        sprites.ids[i] = atlas.add_levels(std::move(levels[i]));
+
+    return true;
+}
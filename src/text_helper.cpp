@@ -3,25 +3,7 @@
 #include <iostream>
 #include <sstream>
 
-bool TextTypewriterAnimation::Init(const wchar_t* animation_text_) {
-    animation_text = animation_text_;
-    chars_progress = 0;
-
-    return true;
-}
-
-bool TextTypewriterAnimation::is_frame_left() {
-    return animation_text[chars_progress] != L'\0';
-}
-
-void TextTypewriterAnimation::next_frame() {
-    if (is_frame_left())
-        ++chars_progress;
-}
-
-std::pair<const wchar_t*, size_t> TextTypewriterAnimation::get_text() {
-    return { animation_text, chars_progress };
-}
+#include "trace.hpp"
 
 bool TextHelper::Init(ComPtr<ID2D1DeviceContext> main_target_) {
     main_target = main_target_;
@@ -344,6 +326,8 @@ bool TextHelper::DrawData(i32 score, u32 difficulty) {
 }
 
 void TextHelper::Start() {
+    TRACE_SCOPE("TextHelper::Start");
+
     target = nullptr;
 
     main_target->CreateCompatibleRenderTarget(&target);
@@ -353,6 +337,8 @@ void TextHelper::Start() {
 }
 
 bool TextHelper::Flush() {
+    TRACE_SCOPE("TextHelper::Flush");
+
     HRESULT hr;
 
     if (data_included) {
@@ -0,0 +1,173 @@
+#include "trace.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+namespace {
+    struct TraceEvent {
+        const char* name;
+        u64 start;
+        u64 end;
+    };
+
+    // The events of one thread, allocated when it first traces. `written`
+    // counts every event ever appended, so event `i` is at
+    // `i % TRACE_RING_EVENTS`; it is stored after the event, so a reader
+    // that loads it sees whole events.
+    struct TraceRing {
+        std::vector<TraceEvent> events;
+        std::atomic<u64> written = 0;
+
+        // Set by `trace_event` around its check of `enabled` and the write.
+        std::atomic<bool> busy = false;
+
+        // First event of the current trace; under `registry_mutex`.
+        u64 first = 0;
+
+        u32 tid = 0;
+        std::string name;
+    };
+
+    std::atomic<bool> enabled = false;
+
+    // Every ring ever made, kept to the end so that threads may come and go.
+    std::mutex registry_mutex;
+    std::vector<std::unique_ptr<TraceRing>> registry;
+
+    // Where the current trace began, in `profile_now` units.
+    u64 origin = 0;
+
+    thread_local TraceRing* ring = nullptr;
+
+    TraceRing& thread_ring() {
+        if (ring)
+            return *ring;
+
+        std::lock_guard lock(registry_mutex);
+
+        auto made = std::make_unique<TraceRing>();
+        made->tid = u32(registry.size());
+        made->name = "thread " + std::to_string(made->tid);
+
+        ring = made.get();
+        registry.push_back(std::move(made));
+
+        return *ring;
+    }
+
+    void write_json(std::ostream& out) {
+        const f64 tick_us = profile_tick_ns() / 1e3;
+        bool comma = false;
+
+        auto separate = [&] {
+            out << (comma ? ",\n" : "\n");
+            comma = true;
+        };
+
+        // Microseconds to the nanosecond, however long the trace.
+        out << std::fixed << std::setprecision(3);
+
+        out << "{\n"
+            << "  \"displayTimeUnit\": \"ms\",\n"
+            << "  \"traceEvents\": [";
+
+        for (const auto& thread : registry) {
+            separate();
+            out << "    { \"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": "
+                << thread->tid << ", \"args\": { \"name\": \"" << thread->name << "\" } }";
+
+            const u64 written = thread->written.load(std::memory_order_acquire);
+            const u64 first = std::max(thread->first,
+                                       written > TRACE_RING_EVENTS ? written - TRACE_RING_EVENTS
+                                                                   : 0);
+
+            for (u64 i = first; i < written; ++i) {
+                const TraceEvent& event = thread->events[i % TRACE_RING_EVENTS];
+
+                separate();
+                out << "    { \"name\": \"" << event.name << "\", \"ph\": \"X\", \"pid\": 1, "
+                    << "\"tid\": " << thread->tid << ", \"ts\": "
+                    << f64(i64(event.start - origin)) * tick_us << ", \"dur\": "
+                    << f64(event.end - event.start) * tick_us << " }";
+            }
+
+            thread->first = written;
+        }
+
+        out << "\n  ]\n"
+            << "}\n";
+    }
+}
+
+void trace_start() {
+    std::lock_guard lock(registry_mutex);
+
+    for (const auto& thread : registry)
+        thread->first = thread->written.load(std::memory_order_acquire);
+
+    origin = profile_now();
+    enabled.store(true, std::memory_order_relaxed);
+}
+
+bool trace_stop(const std::filesystem::path& path) {
+    enabled.store(false, std::memory_order_seq_cst);
+
+    std::lock_guard lock(registry_mutex);
+
+    // A scope that began while tracing may be ending right now; it either
+    // sees tracing off and drops its event, or is waited for here, so that
+    // nothing writes the rings while they are read.
+    for (const auto& thread : registry) {
+        while (thread->busy.load(std::memory_order_seq_cst))
+            std::this_thread::yield();
+    }
+
+    std::ofstream file(path);
+
+    write_json(file);
+
+    if (!file) {
+        std::wcout << L"Cannot write " << path.wstring() << L'\n';
+        return false;
+    }
+
+    return true;
+}
+
+bool trace_enabled() {
+    return enabled.load(std::memory_order_relaxed);
+}
+
+void trace_thread_name(std::string name) {
+    TraceRing& thread = thread_ring();
+
+    std::lock_guard lock(registry_mutex);
+    thread.name = std::move(name);
+}
+
+void trace_event(const char* name, u64 start, u64 end) {
+    TraceRing& thread = thread_ring();
+
+    // Raised before `enabled` is checked, pairing with `trace_stop`, which
+    // clears `enabled` before it checks `busy`.
+    thread.busy.store(true, std::memory_order_seq_cst);
+
+    if (enabled.load(std::memory_order_seq_cst)) {
+        const u64 written = thread.written.load(std::memory_order_relaxed);
+
+        if (thread.events.empty())
+            thread.events.resize(TRACE_RING_EVENTS);
+
+        thread.events[written % TRACE_RING_EVENTS] = { name, start, end };
+        thread.written.store(written + 1, std::memory_order_release);
+    }
+
+    thread.busy.store(false, std::memory_order_release);
+}
@@ -0,0 +1,21 @@
+#include "typewriter.hpp"
+
+bool TextTypewriterAnimation::Init(const wchar_t* animation_text_) {
+    animation_text = animation_text_;
+    chars_progress = 0;
+
+    return true;
+}
+
+bool TextTypewriterAnimation::is_frame_left() const {
+    return animation_text[chars_progress] != L'\0';
+}
+
+void TextTypewriterAnimation::next_frame() {
+    if (is_frame_left())
+        ++chars_progress;
+}
+
+std::pair<const wchar_t*, size_t> TextTypewriterAnimation::get_text() const {
+    return { animation_text, chars_progress };
+}
@@ -7,7 +7,9 @@
 #include "common.hpp"
 #include "timer.hpp"
 
-bool Window::Init(const wchar_t* class_name, const wchar_t* title) {
+bool Window::Init(const wchar_t* class_name, const wchar_t* title,
+                  const wchar_t* replay_path, const wchar_t* profile_path,
+                  const wchar_t* trace_path, u64 hitch_us) {
     HINSTANCE hInstance = GetModuleHandle(NULL);
 
     if (!hInstance) {
@@ -54,7 +56,7 @@ bool Window::Init(const wchar_t* class_name, const wchar_t* title) {
     ComputeOuterSize(outer_width, outer_height);
     SetOuterSize(outer_width, outer_height, dpi);
 
-    return logic.Init();
+    return logic.Init(replay_path, profile_path, trace_path, hitch_us);
 }
 
 bool Window::update() {
@@ -0,0 +1,42 @@
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+
+#include "common.hpp"
+#include "asset_pack.hpp"
+#include "job_system.hpp"
+
+// Build-time writer of the asset pack (see `asset_pack.hpp`): decodes every
+// sprite once and stores it scaled, premultiplied and packed into an atlas
+// for each of PACKED_PIXELS_PER_DIP, so that the game maps the result
+// instead of decoding PNGs on every launch.
+//
+// Usage: asset_packer <directory holding assets/> <output pack>
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        std::wcout << L"Usage: asset_packer <directory holding assets/> <output pack>\n";
+        return EXIT_FAILURE;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+
+    JobSystem jobs;
+
+    if (!jobs.Init(0)) {
+        std::wcout << L"Cannot start the worker threads\n";
+        return EXIT_FAILURE;
+    }
+
+    if (!write_asset_pack(argv[1], argv[2], &jobs))
+        return EXIT_FAILURE;
+
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count();
+
+    std::wcout << L"Packed " << argv[2] << L" (" << std::filesystem::file_size(argv[2]) / 1024
+               << L" KiB) in " << ms << L" ms\n";
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,724 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <cstdio>
+#include <cmath>
+#include <vector>
+#include <queue>
+#include <algorithm>
+#include <string>
+#include <filesystem>
+
+#include "common.hpp"
+#include "png.hpp"
+
+// Build-time generator of `spirits_gen.hpp`. For every sprite it traces the
+// boundary of the opaque part of the asset with marching squares, simplifies
+// it with Douglas-Peucker, cuts the result into convex pieces and packs the
+// alpha channel into a bit mask, all at the scale the sprite is painted at.
+//
+// Usage: contour_gen <assets directory> <output header>
+
+namespace {
+    // How a sprite is turned into collision data. `tolerance` is the largest
+    // distance, in painted pixels, between the alpha boundary and the
+    // simplified contour; `max_vertices` caps the contour regardless. Fewer
+    // vertices give fewer and smaller convex pieces, and so faster narrowphase
+    // tests, at the cost of a looser fit.
+    struct SpriteSpec {
+        const char* name;
+        const char* asset;
+        f64 scale;
+        f64 tolerance;
+        u32 max_vertices;
+        u8 alpha_threshold;
+    };
+
+    constexpr SpriteSpec SPRITES[] = {
+        { "controller", "rocket", 0.3, 1.0, 14, 128 },
+        { "asteroid", "asteroid_small", 0.1, 1.0, 10, 128 },
+        { "bullet", "bullet", 0.25, 1.0, 7, 128 },
+    };
+
+    struct Point {
+        f64 x, y;
+    };
+
+    f64 cross(const Point& o, const Point& a, const Point& b) {
+        return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+    }
+
+    f64 signed_area(const std::vector<Point>& polygon) {
+        f64 area = 0;
+
+        for (size_t i = 0, n = polygon.size(); i < n; ++i) {
+            const Point& a = polygon[i];
+            const Point& b = polygon[(i + 1) % n];
+            area += a.x * b.y - b.x * a.y;
+        }
+
+        return area / 2;
+    }
+
+    //
+    // Marching squares
+    //
+
+    // The alpha channel sampled at pixel centers, with a transparent border so
+    // every boundary is closed.
+    struct AlphaGrid {
+        u32 width, height;
+        std::vector<u8> alpha;
+        f64 threshold;
+
+        AlphaGrid(const Image& image, u8 alpha_threshold)
+            : width(image.width + 2), height(image.height + 2)
+            , alpha(size_t(width) * height, 0), threshold(alpha_threshold - 0.5) {
+            for (u32 y = 0; y < image.height; ++y) {
+                for (u32 x = 0; x < image.width; ++x)
+                    alpha[size_t(y + 1) * width + x + 1] = image.pixel(x, y)[3];
+            }
+        }
+
+        u8 at(u32 x, u32 y) const { return alpha[size_t(y) * width + x]; }
+        bool inside(u32 x, u32 y) const { return at(x, y) > threshold; }
+    };
+
+    // Sides of a cell, in clockwise order (y grows downwards). Corner k is at
+    // the start of side k: top-left, top-right, bottom-right, bottom-left.
+    enum Side : u32 { TOP, RIGHT, BOTTOM, LEFT };
+
+    constexpr i32 CORNER_DX[4] = { 0, 1, 1, 0 };
+    constexpr i32 CORNER_DY[4] = { 0, 0, 1, 1 };
+
+    // The same side seen from the neighbour across it.
+    constexpr Side OPPOSITE[4] = { BOTTOM, LEFT, TOP, RIGHT };
+    constexpr i32 NEIGHBOUR_DX[4] = { 0, 1, 0, -1 };
+    constexpr i32 NEIGHBOUR_DY[4] = { -1, 0, 1, 0 };
+
+    // Follows one boundary. Going clockwise around a cell, the contour enters
+    // on every side that goes from an outside corner to an inside one and
+    // leaves on the next side that goes back out; since a side shared by two
+    // cells is walked in opposite directions by them, where the contour
+    // leaves one cell it enters the next. A saddle cell thus keeps its two
+    // inside corners apart. Crossings are placed by linear interpolation of
+    // the alpha. Every horizontal sample edge crossed is marked in `visited`.
+    std::vector<Point> trace(const AlphaGrid& grid, u32 start_x, u32 start_y, Side start_side,
+                             std::vector<bool>& visited) {
+        std::vector<Point> contour;
+
+        u32 x = start_x, y = start_y;
+        Side entry = start_side;
+
+        do {
+            bool inside[4];
+
+            for (u32 k = 0; k < 4; ++k)
+                inside[k] = grid.inside(x + CORNER_DX[k], y + CORNER_DY[k]);
+
+            Side exit = entry;
+
+            do {
+                exit = Side((exit + 1) % 4);
+            } while (!(inside[exit] && !inside[(exit + 1) % 4]));
+
+            const u32 from = exit, to = (exit + 1) % 4;
+            const u32 x0 = x + CORNER_DX[from], y0 = y + CORNER_DY[from];
+            const u32 x1 = x + CORNER_DX[to], y1 = y + CORNER_DY[to];
+            const f64 a0 = grid.at(x0, y0), a1 = grid.at(x1, y1);
+            const f64 t = (grid.threshold - a0) / (a1 - a0);
+
+            contour.push_back({ x0 + (f64(x1) - x0) * t, y0 + (f64(y1) - y0) * t });
+
+            if (exit == TOP || exit == BOTTOM)
+                visited[size_t(y + CORNER_DY[from]) * grid.width + (x0 < x1 ? x0 : x1)] = true;
+
+            x += NEIGHBOUR_DX[exit];
+            y += NEIGHBOUR_DY[exit];
+            entry = OPPOSITE[exit];
+        } while (x != start_x || y != start_y || entry != start_side);
+
+        return contour;
+    }
+
+    // The boundary enclosing the largest area; specks and holes are dropped.
+    // Coordinates are in source pixels, with the origin in the top-left
+    // corner of the image.
+    std::vector<Point> outline(const Image& image, u8 alpha_threshold) {
+        const AlphaGrid grid(image, alpha_threshold);
+
+        std::vector<bool> visited(size_t(grid.width) * grid.height, false);
+        std::vector<Point> best;
+        f64 best_area = 0;
+
+        for (u32 y = 1; y + 1 < grid.height; ++y) {
+            for (u32 x = 0; x + 1 < grid.width; ++x) {
+                const bool left = grid.inside(x, y), right = grid.inside(x + 1, y);
+
+                if (left == right || visited[size_t(y) * grid.width + x])
+                    continue;
+
+                // The horizontal edge is the top of the cell below it and the
+                // bottom of the one above; start in the cell it is entered from.
+                std::vector<Point> contour = right ? trace(grid, x, y, TOP, visited)
+                                                   : trace(grid, x, y - 1, BOTTOM, visited);
+                const f64 area = fabs(signed_area(contour));
+
+                if (area > best_area) {
+                    best_area = area;
+                    best = std::move(contour);
+                }
+            }
+        }
+
+        // Samples are at pixel centers, one sample of border.
+        for (Point& p : best) {
+            p.x -= 0.5;
+            p.y -= 0.5;
+        }
+
+        return best;
+    }
+
+    //
+    // Douglas-Peucker
+    //
+
+    f64 distance_to_segment(const Point& p, const Point& a, const Point& b) {
+        const f64 dx = b.x - a.x, dy = b.y - a.y;
+        const f64 length2 = dx * dx + dy * dy;
+
+        f64 t = length2 > 0 ? ((p.x - a.x) * dx + (p.y - a.y) * dy) / length2 : 0;
+        t = t < 0 ? 0 : (t > 1 ? 1 : t);
+
+        return hypot(p.x - (a.x + t * dx), p.y - (a.y + t * dy));
+    }
+
+    bool segments_cross(const Point& a, const Point& b, const Point& c, const Point& d) {
+        return (cross(a, b, c) > 0) != (cross(a, b, d) > 0) &&
+               (cross(c, d, a) > 0) != (cross(c, d, b) > 0);
+    }
+
+    bool is_simple(const std::vector<Point>& polygon) {
+        const size_t n = polygon.size();
+
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = i + 2; j < n; ++j) {
+                if (i == 0 && j == n - 1)
+                    continue;
+
+                if (segments_cross(polygon[i], polygon[i + 1], polygon[j], polygon[(j + 1) % n]))
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+    // Douglas-Peucker on a closed contour, splitting the span with the largest
+    // error first: the ring is cut at its first point and the point farthest
+    // from it, and the worst span is split at its farthest point until every
+    // span is within `tolerance` or `max_vertices` is reached. Splitting goes
+    // on past both limits while the polygon intersects itself. `error` is the
+    // largest distance left.
+    std::vector<Point> simplify(const std::vector<Point>& ring, f64 tolerance, u32 max_vertices,
+                                f64& error) {
+        const size_t n = ring.size();
+
+        struct Span {
+            size_t from, to;
+            size_t farthest;
+            f64 error;
+
+            bool operator<(const Span& rhs) const { return error < rhs.error; }
+        };
+
+        auto make_span = [&](size_t from, size_t to) {
+            Span span { from, to, from, 0 };
+
+            for (size_t i = from + 1; i < to; ++i) {
+                const f64 d = distance_to_segment(ring[i % n], ring[from % n], ring[to % n]);
+
+                if (d > span.error) {
+                    span.error = d;
+                    span.farthest = i;
+                }
+            }
+
+            return span;
+        };
+
+        size_t far = 0;
+
+        for (size_t i = 1; i < n; ++i) {
+            if (hypot(ring[i].x - ring[0].x, ring[i].y - ring[0].y) >
+                hypot(ring[far].x - ring[0].x, ring[far].y - ring[0].y)) {
+                far = i;
+            }
+        }
+
+        std::vector<bool> kept(n, false);
+        kept[0] = kept[far] = true;
+        size_t vertices = 2;
+
+        std::priority_queue<Span> spans;
+        spans.push(make_span(0, far));
+        spans.push(make_span(far, n));
+
+        auto collect = [&] {
+            std::vector<Point> result;
+
+            for (size_t i = 0; i < n; ++i) {
+                if (kept[i])
+                    result.push_back(ring[i]);
+            }
+
+            return result;
+        };
+
+        for (;;) {
+            const bool within_limits = vertices >= 3 &&
+                (spans.top().error <= tolerance || vertices >= max_vertices);
+
+            if (spans.top().error == 0 || (within_limits && is_simple(collect())))
+                break;
+
+            const Span span = spans.top();
+            spans.pop();
+
+            kept[span.farthest % n] = true;
+            ++vertices;
+
+            spans.push(make_span(span.from, span.farthest));
+            spans.push(make_span(span.farthest, span.to));
+        }
+
+        error = spans.top().error;
+        return collect();
+    }
+
+    //
+    // Convex decomposition
+    //
+
+    bool is_convex(const std::vector<Point>& polygon) {
+        const size_t n = polygon.size();
+
+        for (size_t i = 0; i < n; ++i) {
+            if (cross(polygon[i], polygon[(i + 1) % n], polygon[(i + 2) % n]) < 0)
+                return false;
+        }
+
+        return true;
+    }
+
+    bool point_in_triangle(const Point& p, const Point& a, const Point& b, const Point& c) {
+        return cross(a, b, p) >= 0 && cross(b, c, p) >= 0 && cross(c, a, p) >= 0;
+    }
+
+    using Piece = std::vector<size_t>;
+
+    // Ear clipping; `polygon` is counter-clockwise (in the math sense).
+    bool triangulate(const std::vector<Point>& polygon, std::vector<Piece>& triangles) {
+        std::vector<size_t> indices(polygon.size());
+
+        for (size_t i = 0; i < indices.size(); ++i)
+            indices[i] = i;
+
+        while (indices.size() > 3) {
+            const size_t m = indices.size();
+            bool clipped = false;
+
+            for (size_t k = 0; k < m && !clipped; ++k) {
+                const size_t i = indices[(k + m - 1) % m], j = indices[k], l = indices[(k + 1) % m];
+                const Point &a = polygon[i], &b = polygon[j], &c = polygon[l];
+
+                if (cross(a, b, c) <= 0)
+                    continue;
+
+                bool empty = true;
+
+                for (size_t other : indices) {
+                    if (other != i && other != j && other != l &&
+                        point_in_triangle(polygon[other], a, b, c)) {
+                        empty = false;
+                        break;
+                    }
+                }
+
+                if (!empty)
+                    continue;
+
+                triangles.push_back({ i, j, l });
+                indices.erase(indices.begin() + k);
+                clipped = true;
+            }
+
+            if (!clipped)
+                return false;
+        }
+
+        triangles.push_back(indices);
+        return true;
+    }
+
+    // Hertel-Mehlhorn: drop every diagonal whose removal keeps both sides
+    // convex. Gives at most four times the optimal number of pieces.
+    void merge_pieces(const std::vector<Point>& polygon, std::vector<Piece>& pieces) {
+        auto points_of = [&](const Piece& piece) {
+            std::vector<Point> points;
+
+            for (size_t m : piece)
+                points.push_back(polygon[m]);
+
+            return points;
+        };
+
+        auto try_merge = [&] {
+            for (size_t p = 0; p < pieces.size(); ++p) {
+                for (size_t q = p + 1; q < pieces.size(); ++q) {
+                    const Piece &a = pieces[p], &b = pieces[q];
+
+                    for (size_t i = 0; i < a.size(); ++i) {
+                        const size_t u = a[i], v = a[(i + 1) % a.size()];
+
+                        size_t j = 0;
+
+                        while (j < b.size() && b[j] != v)
+                            ++j;
+
+                        if (j == b.size() || b[(j + 1) % b.size()] != u)
+                            continue;
+
+                        // Glue `b` into `a` along the shared edge u -> v.
+                        Piece candidate(a.begin(), a.begin() + i + 1);
+
+                        for (size_t k = 0; k + 2 < b.size(); ++k)
+                            candidate.push_back(b[(j + 2 + k) % b.size()]);
+
+                        candidate.insert(candidate.end(), a.begin() + i + 1, a.end());
+
+                        if (is_convex(points_of(candidate))) {
+                            pieces[p] = std::move(candidate);
+                            pieces.erase(pieces.begin() + q);
+                            return true;
+                        }
+                    }
+                }
+            }
+
+            return false;
+        };
+
+        while (try_merge())
+            ;
+    }
+
+    bool convex_pieces(std::vector<Point> polygon, std::vector<std::vector<Point>>& result) {
+        if (signed_area(polygon) < 0)
+            std::reverse(polygon.begin(), polygon.end());
+
+        std::vector<Piece> pieces;
+
+        if (!triangulate(polygon, pieces))
+            return false;
+
+        merge_pieces(polygon, pieces);
+
+        for (const Piece& piece : pieces) {
+            result.emplace_back();
+
+            for (size_t m : piece)
+                result.back().push_back(polygon[m]);
+        }
+
+        return true;
+    }
+
+    //
+    // Bit mask
+    //
+
+    struct Mask {
+        u32 width, height, words;
+        std::vector<u64> rows;
+    };
+
+    // Box-filters the alpha channel down to the size the sprite is painted at;
+    // a mask pixel is set when it is at least half covered.
+    Mask alpha_mask(const Image& image, f64 scale) {
+        Mask mask;
+        mask.width = u32(ceil(image.width * scale));
+        mask.height = u32(ceil(image.height * scale));
+        mask.words = (mask.width + 63) / 64;
+
+        std::vector<u32> total(size_t(mask.width) * mask.height, 0);
+        std::vector<u32> count(total.size(), 0);
+
+        std::vector<u32> column(image.width);
+
+        for (u32 x = 0; x < image.width; ++x)
+            column[x] = u32(x * scale);
+
+        for (u32 y = 0; y < image.height; ++y) {
+            const size_t row = size_t(u32(y * scale)) * mask.width;
+
+            for (u32 x = 0; x < image.width; ++x) {
+                total[row + column[x]] += image.pixel(x, y)[3];
+                count[row + column[x]] += 1;
+            }
+        }
+
+        mask.rows.assign(size_t(mask.height) * mask.words, 0);
+
+        for (u32 y = 0; y < mask.height; ++y) {
+            for (u32 x = 0; x < mask.width; ++x) {
+                const size_t i = size_t(y) * mask.width + x;
+
+                if (2 * total[i] >= 255 * count[i])
+                    mask.rows[size_t(y) * mask.words + x / 64] |= u64(1) << (x % 64);
+            }
+        }
+
+        return mask;
+    }
+
+    //
+    // Output
+    //
+
+    constexpr size_t EDGE_BATCH = 8;
+
+    std::string fmt(f64 value) {
+        char text[32];
+        snprintf(text, sizeof(text), "%.6g", value);
+
+        std::string result = text;
+
+        if (result.find_first_of(".en") == std::string::npos)
+            result += ".0";
+
+        return result + "f";
+    }
+
+    std::string fmt(const Point& p) {
+        return "{ " + fmt(p.x) + ", " + fmt(p.y) + " }";
+    }
+
+    bool emit_sprite(std::ostream& out, const SpriteSpec& sprite, const Image& image) {
+        const std::vector<Point> boundary = outline(image, sprite.alpha_threshold);
+
+        if (boundary.size() < 3) {
+            std::wcout << L"No opaque area in " << sprite.asset << L".png\n";
+            return false;
+        }
+
+        f64 error;
+        std::vector<Point> vertices = simplify(boundary, sprite.tolerance / sprite.scale,
+                                               sprite.max_vertices, error);
+
+        // Centered on the middle of the bitmap, like the painted sprite, and
+        // rounded to a hundredth of a painted pixel.
+        for (Point& p : vertices) {
+            p.x = round((p.x - image.width / 2.) * sprite.scale * 100) / 100;
+            p.y = round((p.y - image.height / 2.) * sprite.scale * 100) / 100;
+        }
+
+        std::vector<std::vector<Point>> pieces;
+
+        if (!convex_pieces(vertices, pieces)) {
+            std::wcout << L"Contour of " << sprite.asset << L".png is not a simple polygon\n";
+            return false;
+        }
+
+        // Every piece gets as many vertices (and axes) as the largest one, by
+        // repeating its last; the repeats change none of the projections.
+        size_t piece_size = 0;
+
+        for (const auto& piece : pieces)
+            piece_size = std::max(piece_size, piece.size());
+
+        const Mask mask = alpha_mask(image, sprite.scale);
+        const Point half_of_sides {
+            image.width * sprite.scale / 2,
+            image.height * sprite.scale / 2,
+        };
+
+        out << "    static constexpr SpiritData<ObjectContour<" << vertices.size() << ", "
+            << piece_size << ", " << pieces.size() << ">, BitMask<" << mask.width << ", "
+            << mask.height << ">> " << sprite.name << " {\n";
+        out << "        .filename = L\"assets/" << sprite.asset << ".png\",\n";
+        out << "        .contour = {\n";
+        out << "            .vertices = {{\n";
+
+        for (const Point& p : vertices)
+            out << "                " << fmt(p) << ",\n";
+
+        out << "            }},\n";
+        out << "            .half_of_sides = " << fmt(half_of_sides) << ",\n";
+
+        // Edges as four coordinate columns, padded with zero-length edges
+        // (which never cross anything) to a multiple of the widest SIMD batch.
+        const size_t edges = (vertices.size() + EDGE_BATCH - 1) / EDGE_BATCH * EDGE_BATCH;
+
+        auto column = [&](const char* name, bool end, bool y) {
+            out << "                ." << name << " = {{ ";
+
+            for (size_t i = 0; i < edges; ++i) {
+                const size_t k = i >= vertices.size() ? 0 : (i + end) % vertices.size();
+                out << (i ? ", " : "") << fmt(y ? vertices[k].y : vertices[k].x);
+            }
+
+            out << " }},\n";
+        };
+
+        out << "            .edges = {\n";
+        column("ax", false, false);
+        column("ay", false, true);
+        column("bx", true, false);
+        column("by", true, true);
+        out << "            },\n";
+        out << "            .pieces = {{\n";
+
+        for (const auto& piece : pieces) {
+            Point box_min = piece[0], box_max = piece[0];
+
+            for (const Point& p : piece) {
+                box_min = { std::min(box_min.x, p.x), std::min(box_min.y, p.y) };
+                box_max = { std::max(box_max.x, p.x), std::max(box_max.y, p.y) };
+            }
+
+            out << "                {\n";
+            out << "                    .vertices = {{\n";
+
+            for (size_t i = 0; i < piece_size; ++i) {
+                out << "                        " << fmt(piece[std::min(i, piece.size() - 1)])
+                    << ",\n";
+            }
+
+            out << "                    }},\n";
+            out << "                    .axes = {{\n";
+
+            // Outward normal of every edge with the projection of the piece
+            // on it.
+            for (size_t i = 0; i < piece_size; ++i) {
+                const size_t e = std::min(i, piece.size() - 1);
+                const Point& a = piece[e];
+                const Point& b = piece[(e + 1) % piece.size()];
+
+                const f64 length = hypot(b.y - a.y, a.x - b.x);
+                const Point normal { (b.y - a.y) / length, (a.x - b.x) / length };
+
+                f64 lo = INFINITY, hi = -INFINITY;
+
+                for (const Point& p : piece) {
+                    const f64 projection = p.x * normal.x + p.y * normal.y;
+                    lo = std::min(lo, projection);
+                    hi = std::max(hi, projection);
+                }
+
+                out << "                        { " << fmt(normal) << ", " << fmt(lo) << ", "
+                    << fmt(hi) << " },\n";
+            }
+
+            out << "                    }},\n";
+            out << "                    .box_min = " << fmt(box_min) << ",\n";
+            out << "                    .box_max = " << fmt(box_max) << ",\n";
+            out << "                },\n";
+        }
+
+        out << "            }},\n";
+        out << "        },\n";
+        out << "        .mask = {\n";
+        out << "            .half_of_sides = " << fmt(half_of_sides) << ",\n";
+        out << "            .rows = {{\n";
+
+        for (u32 y = 0; y < mask.height; ++y) {
+            out << "                ";
+
+            for (u32 w = 0; w < mask.words; ++w) {
+                char word[32];
+                snprintf(word, sizeof(word), "0x%016llxull",
+                         (unsigned long long)mask.rows[size_t(y) * mask.words + w]);
+                out << (w ? ", " : "") << word;
+            }
+
+            out << ",\n";
+        }
+
+        out << "            }},\n";
+        out << "        },\n";
+        out << "        .scale = " << fmt(sprite.scale) << ",\n";
+        out << "    };\n\n";
+
+        std::wcout << sprite.name << L": " << boundary.size() << L" boundary points -> "
+                   << vertices.size() << L" vertices in " << pieces.size() << L" pieces, "
+                   << L"error " << error * sprite.scale << L" px\n";
+
+        return true;
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        std::wcout << L"Usage: contour_gen <assets directory> <output header>\n";
+        return EXIT_FAILURE;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const std::filesystem::path assets = argv[1];
+
+    std::ostringstream out;
+
+    out << "/*\n"
+        << " * This file is auto-generated by `contour_gen` (tools/contour_gen.cpp)\n"
+        << " */\n"
+        << "\n"
+        << "#pragma once\n"
+        << "#include \"math.hpp\"\n"
+        << "#include \"bitmask.hpp\"\n"
+        << "\n"
+        << "// Everything is constant data: the sizes of the contours and masks are part\n"
+        << "// of their types, so no sprite allocates anything.\n"
+        << "template<typename Contour, typename Mask>\n"
+        << "struct SpiritData {\n"
+        << "    const wchar_t* filename;\n"
+        << "    Contour contour;\n"
+        << "    Mask mask;\n"
+        << "    float scale;\n"
+        << "};\n"
+        << "\n"
+        << "struct Spirits {\n";
+
+    for (const SpriteSpec& sprite : SPRITES) {
+        const std::filesystem::path path = assets / (std::string(sprite.asset) + ".png");
+        Image image;
+
+        if (!load_png(path, image)) {
+            std::wcout << L"Cannot decode " << path.wstring() << L"\n";
+            return EXIT_FAILURE;
+        }
+
+        if (!emit_sprite(out, sprite, image))
+            return EXIT_FAILURE;
+    }
+
+    out << "};\n";
+
+    std::ofstream file(argv[2], std::ios::binary);
+    file << out.str();
+
+    if (!file) {
+        std::wcout << L"Cannot write " << argv[2] << L"\n";
+        return EXIT_FAILURE;
+    }
+
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count();
+
+    std::wcout << L"Generated " << argv[2] << L" in " << ms << L" ms\n";
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,186 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "common.hpp"
+
+// Watches the live counters of a running asteroids_headless (`--counters
+// SOCKET`): takes a snapshot every interval and prints the totals with their
+// rates per second and per tick since the previous one, and the gauges.
+//
+// Usage: counters_poll SOCKET [--interval MS] [--count N]
+
+namespace {
+    struct Options {
+        const char* socket_path = nullptr;
+        u32 interval_ms = 1'000;
+
+        // Snapshots to take, 0 for as long as the game runs.
+        u64 count = 0;
+    };
+
+    struct Counter {
+        std::string kind;
+        std::string name;
+        u64 value = 0;
+    };
+
+    void usage() {
+        std::wcout << L"Usage: counters_poll SOCKET [--interval MS] [--count N]\n";
+    }
+
+    bool parse_options(int argc, char** argv, Options& options) {
+        if (argc < 2 || argc % 2 != 0) {
+            usage();
+            return false;
+        }
+
+        options.socket_path = argv[1];
+
+        for (int i = 2; i < argc; i += 2) {
+            if (!strcmp(argv[i], "--interval"))
+                options.interval_ms = u32(std::strtoul(argv[i + 1], nullptr, 10));
+            else if (!strcmp(argv[i], "--count"))
+                options.count = std::strtoull(argv[i + 1], nullptr, 10);
+            else {
+                usage();
+                return false;
+            }
+        }
+
+        if (options.interval_ms == 0) {
+            usage();
+            return false;
+        }
+
+        return true;
+    }
+
+    // One snapshot, or false when nobody answers at `path`.
+    bool poll(const char* path, std::vector<Counter>& counters) {
+        sockaddr_un address {};
+        address.sun_family = AF_UNIX;
+
+        if (strlen(path) >= sizeof(address.sun_path))
+            return false;
+
+        strcpy(address.sun_path, path);
+
+        const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+        if (fd < 0)
+            return false;
+
+        if (connect(fd, (const sockaddr*) &address, sizeof(address)) < 0) {
+            close(fd);
+            return false;
+        }
+
+        std::string text;
+        char buffer[4096];
+        ssize_t n;
+
+        while ((n = read(fd, buffer, sizeof(buffer))) > 0)
+            text.append(buffer, size_t(n));
+
+        close(fd);
+
+        std::istringstream lines(text);
+        Counter counter;
+
+        counters.clear();
+
+        while (lines >> counter.kind >> counter.name >> counter.value)
+            counters.push_back(counter);
+
+        return !counters.empty();
+    }
+
+    u64 value_of(const std::vector<Counter>& counters, const char* name) {
+        for (const auto& counter : counters) {
+            if (counter.name == name)
+                return counter.value;
+        }
+
+        return 0;
+    }
+
+    void print(const std::vector<Counter>& counters, const std::vector<Counter>& previous,
+               f64 seconds) {
+        const f64 ticks = f64(value_of(counters, "ticks") - value_of(previous, "ticks"));
+
+        std::wcout << L'\n' << std::left << std::setw(16) << L"counter" << std::right
+                   << std::setw(16) << L"total" << std::setw(14) << L"/s" << std::setw(10)
+                   << L"/tick" << L'\n' << std::fixed << std::setprecision(2);
+
+        for (size_t i = 0; i < counters.size(); ++i) {
+            const Counter& counter = counters[i];
+
+            if (counter.kind != "counter")
+                continue;
+
+            std::wcout << std::left << std::setw(16) << counter.name.c_str() << std::right
+                       << std::setw(16) << counter.value;
+
+            if (i < previous.size()) {
+                const f64 delta = f64(counter.value - previous[i].value);
+
+                std::wcout << std::setw(14) << delta / seconds;
+
+                if (ticks > 0)
+                    std::wcout << std::setw(10) << delta / ticks;
+            }
+
+            std::wcout << L'\n';
+        }
+
+        for (const auto& counter : counters) {
+            if (counter.kind == "gauge") {
+                std::wcout << std::left << std::setw(16) << counter.name.c_str() << std::right
+                           << std::setw(16) << counter.value << L'\n';
+            }
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+
+    if (!parse_options(argc, argv, options))
+        return EXIT_FAILURE;
+
+    std::vector<Counter> counters, previous;
+    auto last = std::chrono::steady_clock::now();
+
+    for (u64 taken = 0; options.count == 0 || taken < options.count; ++taken) {
+        if (taken)
+            std::this_thread::sleep_for(std::chrono::milliseconds(options.interval_ms));
+
+        if (!poll(options.socket_path, counters)) {
+            if (taken)
+                return EXIT_SUCCESS;
+
+            std::wcout << L"Nothing serves counters at " << options.socket_path << L'\n';
+            return EXIT_FAILURE;
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+
+        print(counters, previous, std::chrono::duration<f64>(now - last).count());
+
+        previous = counters;
+        last = now;
+    }
+
+    return EXIT_SUCCESS;
+}